@@ -0,0 +1,441 @@
+#include "batch.h"
+#include "mainloop.h"
+#include "ext/pathmax.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <libcaer/events/common.h>
+
+#include <libcaercpp/libcaer.hpp>
+using namespace libcaer::log;
+
+#define BATCH_NAME "Batch"
+#define INPUT_FILE_LIBRARY "caer_input_file"
+#define OUTPUT_FILE_LIBRARY "caer_output_file"
+#define OUTPUT_FILE_MAX_PREFIX_LENGTH 128 // Same as in the file output module.
+
+struct BatchFile {
+	std::string path;
+	uintmax_t size;
+	bool valid;
+	bool success;
+	uint64_t events;
+	std::chrono::steady_clock::time_point start;
+	std::chrono::duration<double> duration;
+};
+
+static std::atomic_bool batchRunning;
+
+static std::vector<sshsNode> findModules(const std::string &moduleLibrary);
+static void writeSummary(const std::vector<BatchFile> &files, const std::string &outputDirectory);
+
+bool caerBatchEnabled(void) {
+	return (sshsExistsNode(sshsGetGlobal(), "/caer/batch/")
+		&& sshsNodeAttributeExists(sshsGetNode(sshsGetGlobal(), "/caer/batch/"), "inputFiles", SSHS_STRING));
+}
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+
+struct BatchChild {
+	size_t file;
+	int eventsPipe;
+};
+
+static void batchSignalHandler(int signal);
+static void countEvents(void *userData, caerEventPacketHeader packet);
+[[ noreturn ]] static void runPipeline(const BatchFile &file, sshsNode inputNode,
+	const std::vector<sshsNode> &outputNodes, const std::string &outputDirectory, int eventsPipe);
+
+int caerBatchRun(void) {
+	sshsNode batchNode = sshsGetNode(sshsGetGlobal(), "/caer/batch/");
+
+	const std::string inputFilesList = sshsNodeGetStdString(batchNode, "inputFiles");
+
+	std::vector<std::string> inputFiles;
+	boost::split(inputFiles, inputFilesList, boost::is_any_of("|"));
+
+	size_t jobs = static_cast<size_t>(sshsNodeGetInt(batchNode, "jobs"));
+	const std::string outputDirectory = sshsNodeGetStdString(batchNode, "outputDirectory");
+
+	// The same configuration is run for each file: exactly one input must read
+	// the file, while file outputs get a different name per input file.
+	std::vector<sshsNode> inputNodes = findModules(INPUT_FILE_LIBRARY);
+	if (inputNodes.size() != 1) {
+		log(logLevel::ERROR, BATCH_NAME, "Configuration must have exactly one file input module, found %zu.",
+			inputNodes.size());
+		return (EXIT_FAILURE);
+	}
+
+	std::vector<sshsNode> outputNodes = findModules(OUTPUT_FILE_LIBRARY);
+
+	try {
+		boost::filesystem::create_directories(outputDirectory);
+	}
+	catch (const boost::filesystem::filesystem_error &ex) {
+		log(logLevel::ERROR, BATCH_NAME, "Failed to create output directory '%s' (error: '%s').",
+			outputDirectory.c_str(), ex.what());
+		return (EXIT_FAILURE);
+	}
+
+	std::vector<BatchFile> files;
+
+	for (const auto &inputFile : inputFiles) {
+		BatchFile file;
+		file.path = boost::filesystem::absolute(inputFile).string();
+		file.size = 0;
+		file.valid = false;
+		file.success = false;
+		file.events = 0;
+		file.duration = std::chrono::duration<double>(0);
+
+		boost::system::error_code error;
+		if (boost::filesystem::is_regular_file(file.path, error)) {
+			file.size = boost::filesystem::file_size(file.path, error);
+			file.valid = !error;
+		}
+
+		if (!file.valid) {
+			log(logLevel::ERROR, BATCH_NAME, "Input file '%s' could not be accessed, skipping it.",
+				file.path.c_str());
+		}
+
+		files.push_back(file);
+	}
+
+	// Stop starting new files on SIGTERM/SIGINT, and pass the signal on to the running ones.
+	// No SA_RESTART, so that waitpid() returns to notice this.
+	batchRunning.store(true);
+
+	struct sigaction shutdown;
+
+	shutdown.sa_handler = &batchSignalHandler;
+	shutdown.sa_flags = 0;
+	sigemptyset(&shutdown.sa_mask);
+	sigaddset(&shutdown.sa_mask, SIGTERM);
+	sigaddset(&shutdown.sa_mask, SIGINT);
+
+	if (sigaction(SIGTERM, &shutdown, nullptr) == -1 || sigaction(SIGINT, &shutdown, nullptr) == -1) {
+		log(logLevel::EMERGENCY, BATCH_NAME, "Failed to set signal handler for SIGTERM/SIGINT. Error: %d.", errno);
+		return (EXIT_FAILURE);
+	}
+
+	log(logLevel::NOTICE, BATCH_NAME, "Processing %zu files with up to %zu in parallel, output to '%s'.",
+		files.size(), jobs, outputDirectory.c_str());
+
+	std::unordered_map<pid_t, BatchChild> runningFiles;
+	size_t nextFile = 0;
+	bool signalForwarded = false;
+
+	while (!runningFiles.empty() || (batchRunning.load() && nextFile < files.size())) {
+		// Fill up all free slots.
+		while (batchRunning.load() && runningFiles.size() < jobs && nextFile < files.size()) {
+			size_t idx = nextFile++;
+
+			if (!files[idx].valid) {
+				continue;
+			}
+
+			// The child reports the number of events read through a pipe when done.
+			int eventsPipe[2];
+			if (pipe(eventsPipe) == -1) {
+				log(logLevel::ERROR, BATCH_NAME, "Failed to start processing '%s'. Error: %d.", files[idx].path.c_str(),
+				errno);
+				continue;
+			}
+
+			files[idx].start = std::chrono::steady_clock::now();
+
+			// Keep SIGTERM/SIGINT out until the child is in runningFiles, so that the
+			// shutdown is always forwarded to it. The mask is inherited, so the child
+			// restores it too, with the default action until the mainloop sets its own.
+			sigset_t oldMask;
+			pthread_sigmask(SIG_BLOCK, &shutdown.sa_mask, &oldMask);
+
+			pid_t pid = fork();
+			if (pid == 0) {
+				signal(SIGTERM, SIG_DFL);
+				signal(SIGINT, SIG_DFL);
+				pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+
+				close(eventsPipe[0]);
+
+				for (const auto &running : runningFiles) {
+					close(running.second.eventsPipe);
+				}
+
+				runPipeline(files[idx], inputNodes[0], outputNodes, outputDirectory, eventsPipe[1]);
+			}
+
+			int forkError = errno;
+			close(eventsPipe[1]);
+
+			if (pid > 0) {
+				runningFiles[pid] = BatchChild { idx, eventsPipe[0] };
+			}
+
+			pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+
+			if (pid < 0) {
+				log(logLevel::ERROR, BATCH_NAME, "Failed to start processing '%s'. Error: %d.", files[idx].path.c_str(),
+					forkError);
+				close(eventsPipe[0]);
+				continue;
+			}
+		}
+
+		// A signal may also arrive outside of waitpid(), for example while the mask
+		// above is restored, so check here too, not only on EINTR.
+		if (!batchRunning.load() && !signalForwarded) {
+			log(logLevel::NOTICE, BATCH_NAME, "Shutdown requested, stopping %zu running files.",
+				runningFiles.size());
+
+			for (const auto &running : runningFiles) {
+				kill(running.first, SIGTERM);
+			}
+
+			signalForwarded = true;
+		}
+
+		if (runningFiles.empty()) {
+			continue;
+		}
+
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+
+		if (pid < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			log(logLevel::ERROR, BATCH_NAME, "Failed to wait for processing to finish. Error: %d.", errno);
+			break;
+		}
+
+		auto running = runningFiles.find(pid);
+		if (running == runningFiles.end()) {
+			continue;
+		}
+
+		BatchFile &file = files[running->second.file];
+
+		file.duration = std::chrono::steady_clock::now() - file.start;
+		file.success = (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+
+		// The child has exited, so the count is either fully there or missing (crashed).
+		uint64_t events = 0;
+		if (read(running->second.eventsPipe, &events, sizeof(events)) == sizeof(events)) {
+			file.events = events;
+		}
+
+		close(running->second.eventsPipe);
+		runningFiles.erase(running);
+
+		double megaBytes = static_cast<double>(file.size) / (1024.0 * 1024.0);
+		double seconds = file.duration.count();
+
+		log((file.success) ? (logLevel::NOTICE) : (logLevel::ERROR), BATCH_NAME,
+			"%s '%s': %.1f MB, %" PRIu64 " events in %.2f s (%.1f MB/s, %.0f events/s).",
+			(file.success) ? ("Finished") : ("Failed"), file.path.c_str(), megaBytes, file.events, seconds,
+			(seconds > 0) ? (megaBytes / seconds) : (0.0),
+			(seconds > 0) ? (static_cast<double>(file.events) / seconds) : (0.0));
+	}
+
+	writeSummary(files, outputDirectory);
+
+	bool allSuccessful = std::all_of(files.begin(), files.end(), [](const BatchFile &f) {return (f.success);});
+
+	return ((allSuccessful) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
+
+static void batchSignalHandler(int signal) {
+	UNUSED_ARGUMENT(signal);
+
+	batchRunning.store(false);
+}
+
+/**
+ * Stream tap callback: add up the valid events of all packets the input module reads.
+ *
+ * @param userData the std::atomic<uint64_t> event counter.
+ * @param packet a packet from the input module, released here.
+ */
+static void countEvents(void *userData, caerEventPacketHeader packet) {
+	auto events = static_cast<std::atomic<uint64_t> *>(userData);
+
+	events->fetch_add(static_cast<uint64_t>(caerEventPacketHeaderGetEventValid(packet)), std::memory_order_relaxed);
+
+	caerMainloopPacketRelease(packet);
+}
+
+/**
+ * Process one file in a child process: point the input module to it, run the
+ * mainloop until the file ends, then exit with the mainloop's result.
+ * Only this process' copy of the configuration is changed.
+ *
+ * @param file the file to process.
+ * @param inputNode configuration node of the file input module.
+ * @param outputNodes configuration nodes of all file output modules.
+ * @param outputDirectory directory to write all output files to.
+ * @param eventsPipe where to write the number of valid events read, as uint64_t.
+ */
+[[ noreturn ]] static void runPipeline(const BatchFile &file, sshsNode inputNode,
+	const std::vector<sshsNode> &outputNodes, const std::string &outputDirectory, int eventsPipe) {
+	// Read the file as fast as possible, without losing data and only once.
+	sshsNodeCreate(inputNode, "filePath", file.path, 0, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"File path for reading input data.");
+	sshsNodePut(inputNode, "filePath", file.path);
+
+	sshsNodeCreate(inputNode, "autoRestart", false, SSHS_FLAGS_NORMAL, "Automatically restart module after shutdown.");
+	sshsNodePut(inputNode, "autoRestart", false);
+
+	sshsNodeCreate(inputNode, "keepPackets", true, SSHS_FLAGS_NORMAL,
+		"Ensure all packets are kept (stall input if transfer-buffer full).");
+	sshsNodePut(inputNode, "keepPackets", true);
+
+	sshsNodeCreate(inputNode, "playbackMode", "unthrottled", 8, 11, SSHS_FLAGS_NORMAL,
+		"How to pace EventPacketContainers.");
+	sshsNodePut(inputNode, "playbackMode", "unthrottled");
+
+	// Name output files after the input file, and don't drop any data.
+	const std::string fileName = boost::filesystem::path(file.path).stem().string();
+
+	for (const auto &outputNode : outputNodes) {
+		std::string prefix = fileName;
+		if (outputNodes.size() > 1) {
+			prefix += std::string("-") + sshsNodeGetName(outputNode);
+		}
+
+		prefix = prefix.substr(0, OUTPUT_FILE_MAX_PREFIX_LENGTH);
+
+		sshsNodeCreate(outputNode, "directory", outputDirectory, 1, PATH_MAX - OUTPUT_FILE_MAX_PREFIX_LENGTH,
+			SSHS_FLAGS_NORMAL, "Directory to write output data files in.");
+		sshsNodePut(outputNode, "directory", outputDirectory);
+
+		sshsNodeCreate(outputNode, "prefix", prefix, 1, OUTPUT_FILE_MAX_PREFIX_LENGTH, SSHS_FLAGS_NORMAL,
+			"Output data files name prefix.");
+		sshsNodePut(outputNode, "prefix", prefix);
+
+		sshsNodeCreate(outputNode, "dropPolicy", "block", 5, 10, SSHS_FLAGS_NORMAL,
+			"What to do if data comes in faster than it can be sent out.");
+		sshsNodePut(outputNode, "dropPolicy", "block");
+	}
+
+	// Shut down once the file has been fully read.
+	sshsNode mainloopNode = sshsGetNode(sshsGetGlobal(), "/caer/mainloop/");
+	sshsNodeCreate(mainloopNode, "stopOnInputEnd", true, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
+		"Shut down the whole system once all input modules have stopped.");
+	sshsNodePut(mainloopNode, "stopOnInputEnd", true);
+
+	log(logLevel::INFO, BATCH_NAME, "Processing '%s' in process %d.", file.path.c_str(), getpid());
+
+	// Count what the input module reads, over all event types.
+	std::atomic<uint64_t> events(0);
+	std::vector<int32_t> tapIds;
+
+	int16_t inputId = sshsNodeGetShort(inputNode, "moduleId");
+
+	for (int16_t typeId = 0; typeId < CAER_DEFAULT_EVENT_TYPES_COUNT; typeId++) {
+		tapIds.push_back(caerMainloopTapAdd(inputId, typeId, &countEvents, &events));
+	}
+
+	int result = caerMainloopRun();
+
+	for (auto tapId : tapIds) {
+		caerMainloopTapRemove(tapId);
+	}
+
+	uint64_t eventsTotal = events.load();
+	if (write(eventsPipe, &eventsTotal, sizeof(eventsTotal)) != sizeof(eventsTotal)) {
+		log(logLevel::WARNING, BATCH_NAME, "Failed to report number of events read. Error: %d.", errno);
+	}
+
+	close(eventsPipe);
+
+	exit(result);
+}
+
+#else
+
+int caerBatchRun(void) {
+	log(logLevel::ERROR, BATCH_NAME, "Batch processing is only supported on UNIX systems.");
+
+	return (EXIT_FAILURE);
+}
+
+#endif
+
+static std::vector<sshsNode> findModules(const std::string &moduleLibrary) {
+	std::vector<sshsNode> found;
+
+	size_t modulesSize = 0;
+	sshsNode *modules = sshsNodeGetChildren(sshsGetNode(sshsGetGlobal(), "/"), &modulesSize);
+	if (modules == nullptr) {
+		return (found);
+	}
+
+	for (size_t i = 0; i < modulesSize; i++) {
+		if (sshsNodeAttributeExists(modules[i], "moduleLibrary", SSHS_STRING)
+			&& sshsNodeGetStdString(modules[i], "moduleLibrary") == moduleLibrary) {
+			found.push_back(modules[i]);
+		}
+	}
+
+	free(modules);
+
+	return (found);
+}
+
+/**
+ * Write a per-file throughput summary as CSV, to compare runs.
+ *
+ * @param files all batch files, processed or not.
+ * @param outputDirectory directory to write the summary to.
+ */
+static void writeSummary(const std::vector<BatchFile> &files, const std::string &outputDirectory) {
+	boost::filesystem::path summaryPath(outputDirectory);
+	summaryPath /= CAER_BATCH_SUMMARY_FILE_NAME;
+
+	std::ofstream summary(summaryPath.string());
+	if (!summary) {
+		log(logLevel::ERROR, BATCH_NAME, "Failed to write summary to '%s'.", summaryPath.string().c_str());
+		return;
+	}
+
+	summary << "file,status,bytes,events,seconds,megaBytesPerSecond,eventsPerSecond" << std::endl;
+
+	size_t succeeded = 0;
+
+	for (const auto &file : files) {
+		double seconds = file.duration.count();
+		double megaBytes = static_cast<double>(file.size) / (1024.0 * 1024.0);
+		double megaBytesPerSecond = (seconds > 0) ? (megaBytes / seconds) : (0.0);
+		double eventsPerSecond = (seconds > 0) ? (static_cast<double>(file.events) / seconds) : (0.0);
+
+		summary << "\"" << file.path << "\"," << ((file.success) ? ("ok") : ("failed")) << "," << file.size << ","
+			<< file.events << "," << seconds << "," << megaBytesPerSecond << "," << eventsPerSecond << std::endl;
+
+		if (file.success) {
+			succeeded++;
+		}
+	}
+
+	log(logLevel::NOTICE, BATCH_NAME, "%zu of %zu files processed successfully, summary written to '%s'.", succeeded,
+		files.size(), summaryPath.string().c_str());
+}
@@ -0,0 +1,22 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAER_BATCH_SUMMARY_FILE_NAME "batch-summary.csv"
+
+// Batch processing of AEDAT files, requested on the command-line.
+// Each file is processed by its own instance of the configured modules,
+// in a separate process, as the mainloop and configuration are global.
+bool caerBatchEnabled(void);
+int caerBatchRun(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BATCH_H_ */
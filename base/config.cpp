@@ -1,13 +1,16 @@
 #include "config.h"
+#include "ext/pathmax.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
 
 #include <iostream>
+#include <thread>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/algorithm/string/join.hpp>
 
 namespace po = boost::program_options;
 
@@ -24,7 +27,13 @@ void caerConfigInit(int argc, char *argv[]) {
 	cliDescription.add_options()("help,h", "print help text")("config,c", po::value<std::string>(),
 		"use the specified XML configuration file")("override,o", po::value<std::vector<std::string>>()->multitoken(),
 		"override a configuration parameter from the XML configuration file with the supplied value.\n"
-			"Format: <node> <attribute> <type> <value>\nExample: /caer/logger/ logLevel byte 7");
+			"Format: <node> <attribute> <type> <value>\nExample: /caer/logger/ logLevel byte 7")("batch,b",
+		po::value<std::vector<std::string>>()->multitoken(),
+		"process the given AEDAT files offline, each through its own instance of the configured modules, "
+			"as fast as possible. The configuration must have exactly one file input module.")("batch-jobs,j",
+		po::value<int32_t>(), "number of files to process in parallel in batch mode (default: number of CPUs).")(
+		"batch-output,d", po::value<std::string>(),
+		"directory for file outputs and the throughput summary in batch mode (default: current directory).");
 
 	po::variables_map cliVarMap;
 	try {
@@ -49,6 +58,13 @@ void caerConfigInit(int argc, char *argv[]) {
 		}
 	}
 
+	bool batchMode = (cliVarMap.count("batch") != 0);
+
+	if ((cliVarMap.count("batch-jobs") || cliVarMap.count("batch-output")) && !batchMode) {
+		std::cout << "Batch options require a list of files to process (--batch)." << std::endl;
+		printHelpAndExit(cliDescription);
+	}
+
 	if (cliVarMap.count("config")) {
 		// User supplied config file.
 		configFile = boost::filesystem::path(cliVarMap["config"].as<std::string>());
@@ -102,8 +118,11 @@ void caerConfigInit(int argc, char *argv[]) {
 		// it for writing the configuration later at shutdown.
 		configFile = boost::filesystem::canonical(configFile);
 
-		// Ensure configuration is written back at shutdown.
-		atexit(&caerConfigWriteBack);
+		// Ensure configuration is written back at shutdown. Batch processing
+		// changes the configuration per file, so that is never saved.
+		if (!batchMode) {
+			atexit(&caerConfigWriteBack);
+		}
 	}
 	else {
 		std::cout << "Supplied configuration file " << configFile << " could not be created or read. Error: "
@@ -151,6 +170,28 @@ void caerConfigInit(int argc, char *argv[]) {
 			iter += 4;
 		}
 	}
+
+	// Batch processing settings, applied by caerBatchRun().
+	if (batchMode) {
+		sshsNode batchNode = sshsGetNode(sshsGetGlobal(), "/caer/batch/");
+
+		std::string inputFiles = boost::algorithm::join(cliVarMap["batch"].as<std::vector<std::string>>(), "|");
+
+		sshsNodeCreate(batchNode, "inputFiles", inputFiles, 1, INT32_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+			"AEDAT files to process, separated by '|'.");
+
+		int32_t jobs = (cliVarMap.count("batch-jobs")) ? (cliVarMap["batch-jobs"].as<int32_t>()) :
+			(static_cast<int32_t>(std::thread::hardware_concurrency()));
+
+		sshsNodeCreate(batchNode, "jobs", (jobs < 1) ? (1) : (jobs), 1, INT32_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of files to process in parallel.");
+
+		std::string outputDirectory = boost::filesystem::absolute(
+			(cliVarMap.count("batch-output")) ? (cliVarMap["batch-output"].as<std::string>()) : (".")).string();
+
+		sshsNodeCreate(batchNode, "outputDirectory", outputDirectory, 1, PATH_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Directory for file outputs and the throughput summary.");
+	}
 }
 
 void caerConfigWriteBack(void) {
@@ -3,10 +3,17 @@
 #include "ext/threads_ext.h"
 #include "ext/pathmax.h"
 
+#include <libcaer/network.h>
+#include <libcaer/events/polarity.h>
+
 #include <atomic>
 #include <thread>
 #include <mutex>
 #include <shared_mutex>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <chrono>
 
 #include <boost/asio.hpp>
 #include <boost/format.hpp>
@@ -23,23 +30,145 @@ using asioTCP = boost::asio::ip::tcp;
 
 class ConfigServerConnection;
 
+class ConfigServerSubscription: public std::enable_shared_from_this<ConfigServerSubscription> {
+public:
+	const std::string node;
+	const std::string key;
+	const enum sshs_node_attr_value_type type;
+	const std::chrono::milliseconds interval;
+
+private:
+	std::weak_ptr<ConfigServerConnection> client;
+	asio::io_service &ioService;
+	asio::steady_timer flushTimer;
+	std::chrono::steady_clock::time_point lastFlush;
+	uint64_t lastNotification;
+	bool active;
+
+	// Latest change not yet sent, written by whatever thread changes the attribute.
+	std::mutex pendingLock;
+	bool flushScheduled;
+	bool attributeRemoved;
+	std::string value;
+
+public:
+	ConfigServerSubscription(std::shared_ptr<ConfigServerConnection> c, asio::io_service &io, const std::string &n,
+		const std::string &k, enum sshs_node_attr_value_type t, std::chrono::milliseconds i) :
+			node(n),
+			key(k),
+			type(t),
+			interval(i),
+			client(c),
+			ioService(io),
+			flushTimer(io),
+			lastNotification(0),
+			active(true),
+			flushScheduled(false),
+			attributeRemoved(false) {
+	}
+
+	void changed(const char *newValue);
+	void stop();
+
+private:
+	void startFlushTimer();
+	void flush();
+};
+
+static void caerConfigServerSubscriptionListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+class ConfigServerTap: public std::enable_shared_from_this<ConfigServerTap> {
+public:
+	const int16_t sourceId;
+	const int16_t typeId;
+
+private:
+	std::weak_ptr<ConfigServerConnection> client;
+	asio::io_service &ioService;
+	const double rate;
+	const uint16_t subSampleMask;
+	int32_t tapId;
+
+	// Rate limiting, server thread only.
+	double rateBudget;
+	std::chrono::steady_clock::time_point rateBudgetTime;
+	uint64_t droppedPackets;
+
+	// Packets from the mainloop, waiting to be sent.
+	std::mutex packetsLock;
+	std::deque<caerEventPacketHeader> packets;
+	bool sendScheduled;
+
+public:
+	ConfigServerTap(std::shared_ptr<ConfigServerConnection> c, asio::io_service &io, int16_t s, int16_t t,
+		size_t rateKB, uint8_t subSampleBy) :
+			sourceId(s),
+			typeId(t),
+			client(c),
+			ioService(io),
+			rate(static_cast<double>(rateKB) * 1024.0),
+			subSampleMask(static_cast<uint16_t>((1U << subSampleBy) - 1)),
+			tapId(-1),
+			rateBudget(static_cast<double>(rateKB) * 1024.0),
+			rateBudgetTime(std::chrono::steady_clock::now()),
+			droppedPackets(0),
+			sendScheduled(false) {
+	}
+
+	void start();
+	void stop();
+
+private:
+	static void packetCallback(void *userData, caerEventPacketHeader packet);
+	void send();
+	std::vector<uint8_t> serialize(caerEventPacketHeaderConst packet);
+};
+
 static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection> client, uint8_t action, uint8_t type,
 	const uint8_t *extra, size_t extraLength, const uint8_t *node, size_t nodeLength, const uint8_t *key,
 	size_t keyLength, const uint8_t *value, size_t valueLength);
+static void caerConfigServerHandleBatch(std::shared_ptr<ConfigServerConnection> client, size_t count,
+	const uint8_t *body, size_t bodyLength);
 
 class ConfigServerConnection: public std::enable_shared_from_this<ConfigServerConnection> {
 private:
+	asio::io_service &ioService;
 	asioTCP::socket socket;
 	uint8_t data[CAER_CONFIG_SERVER_BUFFER_SIZE];
+	std::vector<uint8_t> batchData;
+	// Responses and notifications, in the order they have to be sent. For
+	// responses, the next request is read only once they have been sent.
+	std::deque<std::pair<std::vector<uint8_t>, bool>> writeQueue;
+	size_t writeQueueSize;
+	// Messages ever queued and fully written, a message's number is the
+	// value of messagesQueued right after queueing it.
+	uint64_t messagesQueued;
+	uint64_t messagesWritten;
+	std::vector<std::shared_ptr<ConfigServerSubscription>> subscriptions;
+	std::shared_ptr<ConfigServerTap> tap;
 
 public:
-	ConfigServerConnection(asioTCP::socket s) :
-			socket(std::move(s)) {
+	ConfigServerConnection(asio::io_service &io, asioTCP::socket s) :
+			ioService(io),
+			socket(std::move(s)),
+			writeQueueSize(0),
+			messagesQueued(0),
+			messagesWritten(0) {
 		log(logLevel::INFO, CONFIG_SERVER_NAME, "New connection from client %s:%d.",
 			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
 	}
 
 	~ConfigServerConnection() {
+		// Nothing can be sent to this client anymore.
+		while (!subscriptions.empty()) {
+			unsubscribe(subscriptions.back());
+		}
+
+		if (tap != nullptr) {
+			tap->stop();
+		}
+
 		log(logLevel::INFO, CONFIG_SERVER_NAME, "Closing connection from client %s:%d.",
 			socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port());
 	}
@@ -52,30 +181,148 @@ public:
 		return (data);
 	}
 
+	std::vector<uint8_t> &getBatchData() {
+		return (batchData);
+	}
+
 	void writeResponse(size_t dataLength) {
-		auto self(shared_from_this());
+		queueWrite(std::vector<uint8_t>(data, data + dataLength), true);
+	}
 
-		asio::async_write(socket, asio::buffer(data, dataLength),
-			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
-				if (error) {
-					handleError(error, "Failed to write response");
-				}
-				else {
-					// Restart.
-					readHeader();
-				}
-			});
+	void writeBatchResponse() {
+		// Batches can be big, don't keep the memory around.
+		std::vector<uint8_t> response;
+		response.swap(batchData);
+
+		queueWrite(std::move(response), true);
+	}
+
+	// Data that is not the response to a request, like notifications.
+	// Returns the message's number, to check later if it was written.
+	uint64_t writeUnrequested(std::vector<uint8_t> &&message) {
+		return (queueWrite(std::move(message), false));
+	}
+
+	size_t getWriteQueueSize() const {
+		return (writeQueueSize);
+	}
+
+	bool isWritten(uint64_t messageNumber) const {
+		return (messageNumber <= messagesWritten);
+	}
+
+	bool hasSubscriptions() const {
+		return (!subscriptions.empty());
+	}
+
+	void startTap(int16_t sourceId, int16_t typeId, size_t rateKB, uint8_t subSampleBy) {
+		tap = std::make_shared<ConfigServerTap>(shared_from_this(), ioService, sourceId, typeId, rateKB, subSampleBy);
+
+		// Stream starts with the usual network header, right after the response.
+		struct aedat3_network_header networkHeader;
+		networkHeader.magicNumber = htole64(AEDAT3_NETWORK_MAGIC_NUMBER);
+		networkHeader.sequenceNumber = htole64(0);
+		networkHeader.versionNumber = AEDAT3_NETWORK_VERSION;
+		networkHeader.formatNumber = 0; // RAW.
+		networkHeader.sourceID = htole16(sourceId);
+
+		const uint8_t *networkHeaderBytes = reinterpret_cast<const uint8_t *>(&networkHeader);
+		writeUnrequested(
+			std::vector<uint8_t>(networkHeaderBytes, networkHeaderBytes + AEDAT3_NETWORK_HEADER_LENGTH));
+
+		tap->start();
+	}
+
+	std::shared_ptr<ConfigServerSubscription> findSubscription(const char *node, const char *key,
+		enum sshs_node_attr_value_type type) {
+		for (const auto &sub : subscriptions) {
+			if (sub->node == node && sub->key == key && sub->type == type) {
+				return (sub);
+			}
+		}
+
+		return (nullptr);
+	}
+
+	bool subscribe(sshsNode wantedNode, const char *key, enum sshs_node_attr_value_type type,
+		std::chrono::milliseconds interval) {
+		if (subscriptions.size() >= CAER_CONFIG_SERVER_MAX_SUBSCRIPTIONS) {
+			return (false);
+		}
+
+		auto sub = std::make_shared<ConfigServerSubscription>(shared_from_this(), ioService,
+			sshsNodeGetPath(wantedNode), key, type, interval);
+
+		subscriptions.push_back(sub);
+
+		sshsNodeAddAttributeListener(wantedNode, sub.get(), &caerConfigServerSubscriptionListener);
+
+		// Send the current value first. Any change from now on is seen by
+		// the listener, and can only be newer.
+		union sshs_node_attr_value currentValue = sshsNodeGetAttribute(wantedNode, key, type);
+
+		char *currentValueStr = sshsHelperValueToStringConverter(type, currentValue);
+		if (currentValueStr != NULL) {
+			sub->changed(currentValueStr);
+			free(currentValueStr);
+		}
+
+		if (type == SSHS_STRING) {
+			free(currentValue.string);
+		}
+
+		return (true);
+	}
+
+	void unsubscribe(std::shared_ptr<ConfigServerSubscription> sub) {
+		// The node may have been removed and created again since subscribing,
+		// which also removed the listener, so get it again by path. Once this
+		// returns, the listener is not running anymore and never will again.
+		sshs configStore = sshsGetGlobal();
+
+		if (sshsExistsNode(configStore, sub->node.c_str())) {
+			sshsNodeRemoveAttributeListener(sshsGetNode(configStore, sub->node.c_str()), sub.get(),
+				&caerConfigServerSubscriptionListener);
+		}
+
+		sub->stop();
+
+		subscriptions.erase(std::remove(subscriptions.begin(), subscriptions.end(), sub), subscriptions.end());
 	}
 
 private:
 	void readHeader() {
 		auto self(shared_from_this());
 
+		// Streaming connections don't take requests anymore.
+		if (tap != nullptr) {
+			readDiscard();
+			return;
+		}
+
 		asio::async_read(socket, asio::buffer(data, CAER_CONFIG_SERVER_HEADER_SIZE),
 			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
 				if (error) {
 					handleError(error, "Failed to read header");
 				}
+				else if (data[0] == CAER_CONFIG_BATCH) {
+					// Batches have their own header, with the number of
+					// requests and the total length of all of them.
+					uint16_t count = le16toh(*(uint16_t * )(data + 2));
+					uint32_t bodyLength = le32toh(*(uint32_t * )(data + 4));
+
+					// Check for wrong (excessive) requested read length.
+					// Close connection by falling out of scope.
+					if (bodyLength > CAER_CONFIG_SERVER_BATCH_MAX_SIZE) {
+						log(logLevel::INFO, CONFIG_SERVER_NAME,
+							"Client %s:%d: batch length error (%" PRIu32 " bytes requested).",
+							socket.remote_endpoint().address().to_string().c_str(), socket.remote_endpoint().port(),
+							bodyLength);
+						return;
+					}
+
+					readBatch(count, bodyLength);
+				}
 				else {
 					// If we have enough data, we start parsing the lengths.
 					// The main header is 10 bytes.
@@ -132,6 +379,77 @@ private:
 			});
 	}
 
+	uint64_t queueWrite(std::vector<uint8_t> &&message, bool restartRead) {
+		writeQueueSize += message.size();
+		writeQueue.emplace_back(std::move(message), restartRead);
+		messagesQueued++;
+
+		// Only one write can be in progress at a time.
+		if (writeQueue.size() == 1) {
+			writeNext();
+		}
+
+		return (messagesQueued);
+	}
+
+	void writeNext() {
+		auto self(shared_from_this());
+
+		asio::async_write(socket, asio::buffer(writeQueue.front().first),
+			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					handleError(error, "Failed to write response");
+				}
+				else {
+					bool restartRead = writeQueue.front().second;
+
+					writeQueueSize -= writeQueue.front().first.size();
+					writeQueue.pop_front();
+					messagesWritten++;
+
+					if (!writeQueue.empty()) {
+						writeNext();
+					}
+
+					if (restartRead) {
+						// Restart.
+						readHeader();
+					}
+				}
+			});
+	}
+
+	void readDiscard() {
+		auto self(shared_from_this());
+
+		// Only to notice when the client closes the connection.
+		socket.async_read_some(asio::buffer(data, CAER_CONFIG_SERVER_BUFFER_SIZE),
+			[this, self](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					handleError(error, "Failed to read");
+				}
+				else {
+					readDiscard();
+				}
+			});
+	}
+
+	void readBatch(size_t count, size_t bodyLength) {
+		auto self(shared_from_this());
+
+		batchData.resize(bodyLength);
+
+		asio::async_read(socket, asio::buffer(batchData),
+			[this, self, count](const boost::system::error_code &error, std::size_t /*length*/) {
+				if (error) {
+					handleError(error, "Failed to read batch");
+				}
+				else {
+					caerConfigServerHandleBatch(self, count, batchData.data(), batchData.size());
+				}
+			});
+	}
+
 	void handleError(const boost::system::error_code &error, const char *message) {
 		if (error == asio::error::eof) {
 			// Handle EOF separately.
@@ -146,6 +464,257 @@ private:
 	}
 };
 
+static void caerConfigServerSubscriptionListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+
+	ConfigServerSubscription *sub = static_cast<ConfigServerSubscription *>(userData);
+
+	if (changeType != sub->type || sub->key != changeKey) {
+		return;
+	}
+
+	if (event == SSHS_ATTRIBUTE_REMOVED) {
+		sub->changed(nullptr);
+		return;
+	}
+
+	char *changeValueStr = sshsHelperValueToStringConverter(changeType, changeValue);
+	if (changeValueStr != NULL) {
+		sub->changed(changeValueStr);
+		free(changeValueStr);
+	}
+}
+
+// Called by whatever thread changes the attribute (or removes it, with a NULL value).
+// Only the latest value is kept here, it's sent later from the server thread.
+void ConfigServerSubscription::changed(const char *newValue) {
+	std::lock_guard<std::mutex> lock(pendingLock);
+
+	attributeRemoved = (newValue == nullptr);
+	value = (newValue == nullptr) ? ("") : (newValue);
+
+	if (!flushScheduled) {
+		flushScheduled = true;
+
+		auto self(shared_from_this());
+		ioService.post([self]() {
+			self->startFlushTimer();
+		});
+	}
+}
+
+void ConfigServerSubscription::stop() {
+	active = false;
+	flushTimer.cancel();
+}
+
+void ConfigServerSubscription::startFlushTimer() {
+	if (!active) {
+		return;
+	}
+
+	// Wait until the interval since the last notification is over.
+	auto self(shared_from_this());
+
+	flushTimer.expires_at(lastFlush + interval);
+	flushTimer.async_wait([self](const boost::system::error_code &error) {
+		if (!error) {
+			self->flush();
+		}
+	});
+}
+
+void ConfigServerSubscription::flush() {
+	auto c = client.lock();
+	if (!active || !c) {
+		return;
+	}
+
+	// Client is slow: keep merging changes into the pending value, and try
+	// again after another interval, so the write queue can't grow unbounded.
+	if (!c->isWritten(lastNotification) || c->getWriteQueueSize() > CAER_CONFIG_SERVER_NOTIFY_MAX_QUEUED_SIZE) {
+		lastFlush = std::chrono::steady_clock::now();
+		startFlushTimer();
+		return;
+	}
+
+	std::string flushValue;
+	bool flushRemoved;
+
+	{
+		std::lock_guard<std::mutex> lock(pendingLock);
+
+		flushValue.swap(value);
+		flushRemoved = attributeRemoved;
+		flushScheduled = false;
+	}
+
+	lastFlush = std::chrono::steady_clock::now();
+
+	// MSG is NODE, KEY and VALUE (if present), each NUL terminated.
+	size_t msgLength = node.length() + 1 + key.length() + 1 + ((flushRemoved) ? (0) : (flushValue.length() + 1));
+	// Clients receive into a buffer of CAER_CONFIG_SERVER_BUFFER_SIZE bytes, header included.
+	if (msgLength > (CAER_CONFIG_SERVER_BUFFER_SIZE - 4)) {
+		caerLog(CAER_LOG_ERROR, CONFIG_SERVER_NAME, "Value of '%s' in '%s' too long for notification, not sent.",
+			key.c_str(), node.c_str());
+		return;
+	}
+
+	std::vector<uint8_t> notification(4);
+
+	notification[0] = CAER_CONFIG_NOTIFY;
+	notification[1] = (uint8_t) type;
+	*((uint16_t *) (notification.data() + 2)) = htole16((uint16_t) msgLength);
+
+	notification.insert(notification.end(), node.c_str(), node.c_str() + node.length() + 1);
+	notification.insert(notification.end(), key.c_str(), key.c_str() + key.length() + 1);
+	if (!flushRemoved) {
+		notification.insert(notification.end(), flushValue.c_str(), flushValue.c_str() + flushValue.length() + 1);
+	}
+
+	lastNotification = c->writeUnrequested(std::move(notification));
+}
+
+void ConfigServerTap::start() {
+	tapId = caerMainloopTapAdd(sourceId, typeId, &ConfigServerTap::packetCallback, this);
+}
+
+void ConfigServerTap::stop() {
+	// Once removed, no new packets can arrive.
+	caerMainloopTapRemove(tapId);
+
+	std::lock_guard<std::mutex> lock(packetsLock);
+
+	for (auto packet : packets) {
+		caerMainloopPacketRelease(packet);
+	}
+
+	packets.clear();
+
+	if (droppedPackets > 0) {
+		caerLog(CAER_LOG_INFO, CONFIG_SERVER_NAME, "Tap on stream [%" PRIi16 ", %" PRIi16 "] dropped %" PRIu64
+			" packets.", sourceId, typeId, droppedPackets);
+	}
+}
+
+// Called from the mainloop: just queue the packet, sending happens later on the server thread.
+void ConfigServerTap::packetCallback(void *userData, caerEventPacketHeader packet) {
+	ConfigServerTap *tap = static_cast<ConfigServerTap *>(userData);
+
+	std::lock_guard<std::mutex> lock(tap->packetsLock);
+
+	if (tap->packets.size() >= CAER_CONFIG_SERVER_TAP_MAX_PACKETS) {
+		// Server thread isn't keeping up, drop newest.
+		caerMainloopPacketRelease(packet);
+		tap->droppedPackets++;
+		return;
+	}
+
+	tap->packets.push_back(packet);
+
+	if (!tap->sendScheduled) {
+		tap->sendScheduled = true;
+
+		auto self(tap->shared_from_this());
+		tap->ioService.post([self]() {
+			self->send();
+		});
+	}
+}
+
+void ConfigServerTap::send() {
+	std::deque<caerEventPacketHeader> sendPackets;
+
+	{
+		std::lock_guard<std::mutex> lock(packetsLock);
+
+		sendPackets.swap(packets);
+		sendScheduled = false;
+	}
+
+	auto c = client.lock();
+
+	for (auto packet : sendPackets) {
+		std::vector<uint8_t> packetData;
+
+		if (c) {
+			packetData = serialize(packet);
+		}
+
+		caerMainloopPacketRelease(packet);
+
+		if (packetData.empty()) {
+			continue;
+		}
+
+		// Refill the rate budget, up to one second's worth.
+		auto now = std::chrono::steady_clock::now();
+
+		rateBudget += rate * std::chrono::duration<double>(now - rateBudgetTime).count();
+		if (rateBudget > rate) {
+			rateBudget = rate;
+		}
+
+		rateBudgetTime = now;
+
+		// Drop what is over the rate, or what the client is too slow to receive.
+		if (static_cast<double>(packetData.size()) > rateBudget
+			|| (c->getWriteQueueSize() + packetData.size()) > CAER_CONFIG_SERVER_TAP_MAX_QUEUED_SIZE) {
+			droppedPackets++;
+			continue;
+		}
+
+		rateBudget -= static_cast<double>(packetData.size());
+
+		c->writeUnrequested(std::move(packetData));
+	}
+}
+
+std::vector<uint8_t> ConfigServerTap::serialize(caerEventPacketHeaderConst packet) {
+	// The packet is shared with the mainloop and must not be modified,
+	// so pick the events to send while copying it out.
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+	bool subSample = (subSampleMask != 0 && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT);
+
+	std::vector<uint8_t> packetData(CAER_EVENT_PACKET_HEADER_SIZE);
+	memcpy(packetData.data(), packet, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	int32_t eventsKept = 0;
+
+	for (int32_t i = 0; i < eventNumber; i++) {
+		const uint8_t *event = static_cast<const uint8_t *>(caerGenericEventGetEvent(packet, i));
+
+		if (!caerGenericEventIsValid(event)) {
+			continue;
+		}
+
+		if (subSample) {
+			caerPolarityEventConst polarityEvent = reinterpret_cast<caerPolarityEventConst>(event);
+
+			if ((caerPolarityEventGetX(polarityEvent) & subSampleMask) != 0
+				|| (caerPolarityEventGetY(polarityEvent) & subSampleMask) != 0) {
+				continue;
+			}
+		}
+
+		packetData.insert(packetData.end(), event, event + eventSize);
+		eventsKept++;
+	}
+
+	if (eventsKept == 0) {
+		return (std::vector<uint8_t>());
+	}
+
+	caerEventPacketHeader header = reinterpret_cast<caerEventPacketHeader>(packetData.data());
+	caerEventPacketHeaderSetEventCapacity(header, eventsKept);
+	caerEventPacketHeaderSetEventNumber(header, eventsKept);
+	caerEventPacketHeaderSetEventValid(header, eventsKept);
+
+	return (packetData);
+}
+
 class ConfigServer {
 private:
 	asio::io_service ioService;
@@ -174,7 +743,7 @@ private:
 					"Failed to accept new connection. Error: %s (%d).", error.message().c_str(), error.value());
 			}
 			else {
-				std::make_shared<ConfigServerConnection>(std::move(socket))->start();
+				std::make_shared<ConfigServerConnection>(ioService, std::move(socket))->start();
 			}
 
 			acceptStart();
@@ -315,6 +884,23 @@ static inline bool checkAttributeExists(sshsNode wantedNode, const char *key, en
 	return (attrExists);
 }
 
+static inline const char *caerConfigPutErrorMessage(int putErrno) {
+	// Map failure reasons of PUT operations to messages for the client.
+	if (putErrno == EINVAL) {
+		return ("Impossible to convert value according to type.");
+	}
+	else if (putErrno == EPERM) {
+		return ("Cannot write to a read-only attribute.");
+	}
+	else if (putErrno == ERANGE) {
+		return ("Value out of attribute range.");
+	}
+	else {
+		// Unknown error.
+		return ("Unknown error.");
+	}
+}
+
 static inline void caerConfigSendBoolResponse(std::shared_ptr<ConfigServerConnection> client, uint8_t action,
 	bool result) {
 	// Send back result to client. Format is the same as incoming data.
@@ -425,19 +1011,7 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			const char *typeStr = sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type);
 			if (!sshsNodeStringToAttributeConverter(wantedNode, (const char *) key, typeStr, (const char *) value)) {
 				// Send back correct error message to client.
-				if (errno == EINVAL) {
-					caerConfigSendError(client, "Impossible to convert value according to type.");
-				}
-				else if (errno == EPERM) {
-					caerConfigSendError(client, "Cannot write to a read-only attribute.");
-				}
-				else if (errno == ERANGE) {
-					caerConfigSendError(client, "Value out of attribute range.");
-				}
-				else {
-					// Unknown error.
-					caerConfigSendError(client, "Unknown error.");
-				}
+				caerConfigSendError(client, caerConfigPutErrorMessage(errno));
 
 				break;
 			}
@@ -840,6 +1414,142 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 			break;
 		}
 
+		case CAER_CONFIG_SUBSCRIBE: {
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (!checkNodeExists(configStore, (const char *) node, client)) {
+				break;
+			}
+
+			// This cannot fail, since we know the node exists from above.
+			sshsNode wantedNode = sshsGetNode(configStore, (const char *) node);
+
+			if (!checkAttributeExists(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type, client)) {
+				break;
+			}
+
+			// Value is the optional minimum interval between notifications, in ms.
+			long interval = CAER_CONFIG_SERVER_NOTIFY_DEFAULT_INTERVAL;
+
+			if (value != nullptr) {
+				char *intervalEnd = nullptr;
+				errno = 0;
+				interval = strtol((const char *) value, &intervalEnd, 10);
+
+				if (errno != 0 || intervalEnd == (const char *) value || *intervalEnd != '\0'
+					|| interval < CAER_CONFIG_SERVER_NOTIFY_MIN_INTERVAL
+					|| interval > CAER_CONFIG_SERVER_NOTIFY_MAX_INTERVAL) {
+					caerConfigSendError(client, "Invalid notification interval.");
+					break;
+				}
+			}
+
+			if (client->findSubscription(sshsNodeGetPath(wantedNode), (const char *) key,
+				(enum sshs_node_attr_value_type) type) != nullptr) {
+				caerConfigSendError(client, "Already subscribed to this attribute.");
+				break;
+			}
+
+			if (!client->subscribe(wantedNode, (const char *) key, (enum sshs_node_attr_value_type) type,
+				std::chrono::milliseconds(interval))) {
+				caerConfigSendError(client, "Too many subscriptions.");
+				break;
+			}
+
+			// Send back confirmation to the client. The first notification is
+			// only sent later from the server thread, so it always comes after.
+			caerConfigSendBoolResponse(client, CAER_CONFIG_SUBSCRIBE, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_UNSUBSCRIBE: {
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			if (node == nullptr || key == nullptr) {
+				caerConfigSendError(client, "Not subscribed to this attribute.");
+				break;
+			}
+
+			// The attribute, or even the node, may not exist anymore.
+			auto sub = client->findSubscription((const char *) node, (const char *) key,
+				(enum sshs_node_attr_value_type) type);
+
+			if (sub == nullptr) {
+				caerConfigSendError(client, "Not subscribed to this attribute.");
+				break;
+			}
+
+			client->unsubscribe(sub);
+
+			caerConfigSendBoolResponse(client, CAER_CONFIG_UNSUBSCRIBE, true);
+
+			break;
+		}
+
+		case CAER_CONFIG_TAP: {
+			std::unique_lock<std::shared_timed_mutex> lock(glConfigServerData.operationsSharedMutex);
+
+			// Value is "sourceId,typeId[,rate[,subSampleBy]]".
+			int sourceId = -1, typeId = -1, subSampleBy = 0;
+			long rate = CAER_CONFIG_SERVER_TAP_DEFAULT_RATE;
+			char trailing = 0;
+
+			int parsed = (value == nullptr) ? (0) :
+				(sscanf((const char *) value, "%d,%d,%ld,%d%c", &sourceId, &typeId, &rate, &subSampleBy, &trailing));
+
+			if (parsed < 2 || parsed > 4 || sourceId < 0 || sourceId > INT16_MAX || typeId < 0 || typeId > INT16_MAX
+				|| rate < 1 || rate > INT32_MAX || subSampleBy < 0
+				|| subSampleBy > CAER_CONFIG_SERVER_TAP_MAX_SUBSAMPLE) {
+				caerConfigSendError(client, "Invalid tap definition.");
+				break;
+			}
+
+			if (client->hasSubscriptions()) {
+				caerConfigSendError(client, "Connection has subscriptions, use another one for taps.");
+				break;
+			}
+
+			// Look for the source module, to get its source description if available.
+			// The stream itself may only exist later, once the mainloop runs.
+			size_t rootNodesSize;
+			sshsNode *rootNodes = sshsNodeGetChildren(sshsGetNode(configStore, "/"), &rootNodesSize);
+
+			sshsNode sourceNode = nullptr;
+
+			for (size_t i = 0; i < rootNodesSize; i++) {
+				if (sshsNodeAttributeExists(rootNodes[i], "moduleId", SSHS_SHORT)
+					&& sshsNodeGetShort(rootNodes[i], "moduleId") == sourceId) {
+					sourceNode = rootNodes[i];
+					break;
+				}
+			}
+
+			free(rootNodes);
+
+			if (sourceNode == nullptr) {
+				caerConfigSendError(client, "Source module doesn't exist.");
+				break;
+			}
+
+			std::string sourceString;
+
+			if (sshsExistsRelativeNode(sourceNode, "sourceInfo/")) {
+				sshsNode sourceInfoNode = sshsGetRelativeNode(sourceNode, "sourceInfo/");
+
+				if (sshsNodeAttributeExists(sourceInfoNode, "sourceString", SSHS_STRING)) {
+					sourceString = sshsNodeGetStdString(sourceInfoNode, "sourceString");
+				}
+			}
+
+			caerConfigSendResponse(client, CAER_CONFIG_TAP, SSHS_STRING, (const uint8_t *) sourceString.c_str(),
+				sourceString.length() + 1);
+
+			client->startTap(I16T(sourceId), I16T(typeId), (size_t) rate, (uint8_t) subSampleBy);
+
+			break;
+		}
+
 		default: {
 			// Unknown action, send error back to client.
 			caerConfigSendError(client, "Unknown action.");
@@ -848,3 +1558,248 @@ static void caerConfigServerHandleRequest(std::shared_ptr<ConfigServerConnection
 		}
 	}
 }
+
+struct config_batch_request {
+	uint8_t action;
+	uint8_t type;
+	const char *node;
+	const char *key;
+	const char *value;
+	sshsNode wantedNode;
+	union sshs_node_attr_value putValue;
+	bool putValueValid;
+	const char *error;
+};
+
+// Fields must be NUL terminated, else they are treated as missing.
+static inline const char *batchRequestField(const uint8_t *field, size_t fieldLength) {
+	if (fieldLength == 0 || field[fieldLength - 1] != '\0') {
+		return (nullptr);
+	}
+
+	return ((const char *) field);
+}
+
+static inline void batchResponseAppend(std::vector<uint8_t> &response, uint8_t action, uint8_t type,
+	const char *msg, size_t msgLength) {
+	// Same format as single responses. Msg must already be NUL terminated!
+	uint8_t header[4] = { action, type, 0, 0 };
+	setMsgLen(header, (uint16_t) msgLength);
+
+	response.insert(response.end(), header, header + 4);
+	response.insert(response.end(), (const uint8_t *) msg, (const uint8_t *) msg + msgLength);
+}
+
+static inline void batchResponseAppendError(std::vector<uint8_t> &response, const char *errorMsg) {
+	batchResponseAppend(response, CAER_CONFIG_ERROR, SSHS_STRING, errorMsg, strlen(errorMsg) + 1);
+}
+
+static void caerConfigServerHandleBatch(std::shared_ptr<ConfigServerConnection> client, size_t count,
+	const uint8_t *body, size_t bodyLength) {
+	caerLog(CAER_LOG_DEBUG, CONFIG_SERVER_NAME, "Handling batch request: count=%zu, bodyLength=%zu.", count,
+		bodyLength);
+
+	std::vector<struct config_batch_request> requests(count);
+
+	// Split up the body into the single requests, they must fill it exactly.
+	size_t offset = 0;
+
+	for (auto &req : requests) {
+		if ((bodyLength - offset) < CAER_CONFIG_SERVER_HEADER_SIZE) {
+			caerConfigSendError(client, "Malformed batch request.");
+			return;
+		}
+
+		const uint8_t *header = body + offset;
+
+		// Decode length header fields (all in little-endian).
+		size_t extraLength = le16toh(*(const uint16_t * )(header + 2));
+		size_t nodeLength = le16toh(*(const uint16_t * )(header + 4));
+		size_t keyLength = le16toh(*(const uint16_t * )(header + 6));
+		size_t valueLength = le16toh(*(const uint16_t * )(header + 8));
+
+		size_t fieldsLength = extraLength + nodeLength + keyLength + valueLength;
+
+		if ((bodyLength - offset - CAER_CONFIG_SERVER_HEADER_SIZE) < fieldsLength) {
+			caerConfigSendError(client, "Malformed batch request.");
+			return;
+		}
+
+		const uint8_t *fields = header + CAER_CONFIG_SERVER_HEADER_SIZE;
+
+		req.action = header[0];
+		req.type = header[1];
+		req.node = batchRequestField(fields + extraLength, nodeLength);
+		req.key = batchRequestField(fields + extraLength + nodeLength, keyLength);
+		req.value = batchRequestField(fields + extraLength + nodeLength + keyLength, valueLength);
+		req.wantedNode = nullptr;
+		req.putValueValid = false;
+		req.error = nullptr;
+
+		offset += CAER_CONFIG_SERVER_HEADER_SIZE + fieldsLength;
+	}
+
+	if (offset != bodyLength) {
+		caerConfigSendError(client, "Malformed batch request.");
+		return;
+	}
+
+	// Only take the exclusive lock once for the whole batch, if needed at all.
+	bool hasPut = std::any_of(requests.cbegin(), requests.cend(), [](const struct config_batch_request &req) {
+		return (req.action == CAER_CONFIG_PUT);
+	});
+
+	std::shared_lock<std::shared_timed_mutex> sharedLock(glConfigServerData.operationsSharedMutex, std::defer_lock);
+	std::unique_lock<std::shared_timed_mutex> uniqueLock(glConfigServerData.operationsSharedMutex, std::defer_lock);
+
+	if (hasPut) {
+		uniqueLock.lock();
+	}
+	else {
+		sharedLock.lock();
+	}
+
+	sshs configStore = sshsGetGlobal();
+
+	// First verify all requests, without changing anything.
+	bool putFailed = false;
+
+	for (auto &req : requests) {
+		if (req.action != CAER_CONFIG_GET && req.action != CAER_CONFIG_PUT) {
+			req.error = "Action not supported in batch.";
+			continue;
+		}
+
+		// Only allow operations on existing nodes and attributes, see checkNodeExists()
+		// and checkAttributeExists(), sshsGetNode() would create missing nodes.
+		if (req.node == nullptr || !sshsExistsNode(configStore, req.node)) {
+			req.error = "Node doesn't exist. Operations are only allowed on existing data.";
+		}
+		else {
+			// This cannot fail, since we know the node exists from above.
+			req.wantedNode = sshsGetNode(configStore, req.node);
+
+			if (req.key == nullptr
+				|| !sshsNodeAttributeExists(req.wantedNode, req.key, (enum sshs_node_attr_value_type) req.type)) {
+				req.error = "Attribute of given type doesn't exist. Operations are only allowed on existing data.";
+			}
+		}
+
+		if (req.action == CAER_CONFIG_PUT && req.error == nullptr) {
+			if (req.value == nullptr
+				|| !sshsHelperStringToValueConverter((enum sshs_node_attr_value_type) req.type, req.value,
+					&req.putValue)) {
+				req.error = caerConfigPutErrorMessage(EINVAL);
+			}
+			else {
+				req.putValueValid = true;
+
+				if (!sshsNodeCheckAttribute(req.wantedNode, req.key, (enum sshs_node_attr_value_type) req.type,
+					req.putValue)) {
+					req.error = caerConfigPutErrorMessage(errno);
+				}
+			}
+		}
+
+		if (req.action == CAER_CONFIG_PUT && req.error != nullptr) {
+			putFailed = true;
+		}
+	}
+
+	// PUTs are all-or-nothing: if any failed, none is applied.
+	if (putFailed) {
+		for (auto &req : requests) {
+			if (req.action == CAER_CONFIG_PUT && req.error == nullptr) {
+				req.error = "Batch not applied, another PUT failed.";
+			}
+		}
+	}
+
+	// Lock all nodes involved for the duration of the batch, so that other
+	// threads see all of its changes at once. Sorted, to always lock in the same order.
+	std::vector<std::string> transactionNodes;
+
+	for (const auto &req : requests) {
+		if (req.error == nullptr) {
+			transactionNodes.push_back(req.node);
+		}
+	}
+
+	vectorSortUnique(transactionNodes);
+
+	std::vector<char *> transactionNodePaths;
+
+	for (auto &nodePath : transactionNodes) {
+		transactionNodePaths.push_back(&nodePath[0]);
+	}
+
+	sshsBeginTransaction(configStore, transactionNodePaths.data(), transactionNodePaths.size());
+
+	// Execute the requests in order and collect their responses.
+	std::vector<uint8_t> response(CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE);
+
+	for (auto &req : requests) {
+		if (req.error != nullptr) {
+			batchResponseAppendError(response, req.error);
+			continue;
+		}
+
+		if (req.action == CAER_CONFIG_GET) {
+			union sshs_node_attr_value result = sshsNodeGetAttribute(req.wantedNode, req.key,
+				(enum sshs_node_attr_value_type) req.type);
+
+			char *resultStr = sshsHelperValueToStringConverter((enum sshs_node_attr_value_type) req.type, result);
+
+			if (resultStr == NULL) {
+				batchResponseAppendError(response, "Failed to allocate memory for value string.");
+			}
+			else if (strlen(resultStr) >= UINT16_MAX) {
+				batchResponseAppendError(response, "Value string too long for response.");
+			}
+			else {
+				batchResponseAppend(response, CAER_CONFIG_GET, req.type, resultStr, strlen(resultStr) + 1);
+			}
+
+			free(resultStr);
+
+			// If this is a string, we must remember to free the original result.str
+			// too, since it will also be a copy of the string coming from SSHS.
+			if (req.type == SSHS_STRING) {
+				free(result.string);
+			}
+		}
+		else {
+			// Everything was verified above, and nothing can have changed since.
+			if (!sshsNodePutAttribute(req.wantedNode, req.key, (enum sshs_node_attr_value_type) req.type,
+				req.putValue)) {
+				batchResponseAppendError(response, caerConfigPutErrorMessage(errno));
+			}
+			else {
+				batchResponseAppend(response, CAER_CONFIG_PUT, SSHS_BOOL, "true", 5);
+			}
+		}
+	}
+
+	sshsEndTransaction(configStore, transactionNodePaths.data(), transactionNodePaths.size());
+
+	for (auto &req : requests) {
+		if (req.putValueValid && req.type == SSHS_STRING) {
+			free(req.putValue.string);
+		}
+	}
+
+	// Fill in batch response header (all in little-endian).
+	size_t responseBodyLength = response.size() - CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE;
+
+	response[0] = CAER_CONFIG_BATCH;
+	response[1] = 0; // UNUSED.
+	*((uint16_t *) (response.data() + 2)) = htole16((uint16_t) count);
+	*((uint32_t *) (response.data() + 4)) = htole32((uint32_t) responseBodyLength);
+
+	// The request body is not needed anymore, reuse its buffer for sending.
+	client->getBatchData().swap(response);
+	client->writeBatchResponse();
+
+	caerLog(CAER_LOG_DEBUG, CONFIG_SERVER_NAME, "Sent back batch response to client: count=%zu, bodyLength=%zu.",
+		count, responseBodyLength);
+}
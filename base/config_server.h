@@ -17,6 +17,51 @@ extern "C" {
 #define CAER_CONFIG_SERVER_BUFFER_SIZE 4096
 #define CAER_CONFIG_SERVER_HEADER_SIZE 10
 
+// Batch message format: 1 byte ACTION (CAER_CONFIG_BATCH), 1 byte unused,
+// 2 bytes COUNT, 4 bytes BODY_LEN, 2 bytes unused, then BODY_LEN bytes
+// containing COUNT complete control messages, one after the other, each
+// in the format above. Only GET and PUT are supported inside a batch.
+// All PUTs are applied together, or none is if any of them fails.
+// The response has 1 byte ACTION (CAER_CONFIG_BATCH), 1 byte unused, 2 bytes
+// COUNT, 4 bytes BODY_LEN, then BODY_LEN bytes containing COUNT responses in
+// the usual format, one for each control message, in the same order.
+// If the batch itself is malformed, a single error response is sent instead.
+// All lengths are little-endian. BODY_LEN is limited to 1MB.
+#define CAER_CONFIG_SERVER_BATCH_MAX_SIZE (1024 * 1024)
+#define CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE 8
+
+// SUBSCRIBE takes NODE, KEY, TYPE and optionally as VALUE the minimum interval
+// between notifications in milliseconds (default 100ms, from 10ms up to 60s).
+// Changes happening faster than that are coalesced, only the latest value is
+// sent. The same happens while the previous notification, or too much other
+// data, still waits to be sent to a slow client.
+// After the response, the server sends NOTIFY messages on every change, at any
+// time, also between the response to a request and the next request, so clients
+// must be ready to receive them. The first one has the current value.
+// NOTIFY messages have the response format: ACTION, TYPE, MSG_LEN, then a MSG
+// made of NODE, KEY and VALUE, each NUL terminated. VALUE is missing if the
+// attribute was removed; the subscription stays, and resumes if the attribute
+// is created again on the same node. UNSUBSCRIBE takes NODE, KEY, TYPE.
+#define CAER_CONFIG_SERVER_NOTIFY_DEFAULT_INTERVAL 100
+#define CAER_CONFIG_SERVER_NOTIFY_MIN_INTERVAL 10
+#define CAER_CONFIG_SERVER_NOTIFY_MAX_INTERVAL 60000
+#define CAER_CONFIG_SERVER_NOTIFY_MAX_QUEUED_SIZE (64 * 1024)
+#define CAER_CONFIG_SERVER_MAX_SUBSCRIPTIONS 1024
+
+// TAP takes as VALUE "sourceId,typeId[,rate[,subSampleBy]]" and, after the
+// response, turns the connection into an AEDAT 3.1 network stream of the given
+// stream's event packets: the 20 bytes network header, then the packets, with
+// only their valid events. No more requests are handled, close the connection
+// to stop. The response MSG is the source's "#Source" header line, if known.
+// Rate is the maximum data rate in KB/s (default 1024), packets exceeding it,
+// or that the client is too slow to receive, are dropped. Polarity events can
+// be sub-sampled by keeping only one pixel out of each 2^subSampleBy square.
+// A connection with subscriptions can't be used for a tap.
+#define CAER_CONFIG_SERVER_TAP_DEFAULT_RATE 1024
+#define CAER_CONFIG_SERVER_TAP_MAX_SUBSAMPLE 8
+#define CAER_CONFIG_SERVER_TAP_MAX_PACKETS 128
+#define CAER_CONFIG_SERVER_TAP_MAX_QUEUED_SIZE (1024 * 1024)
+
 enum caer_config_actions {
 	CAER_CONFIG_NODE_EXISTS = 0,
 	CAER_CONFIG_ATTR_EXISTS = 1,
@@ -31,6 +76,11 @@ enum caer_config_actions {
 	CAER_CONFIG_GET_DESCRIPTION = 10,
 	CAER_CONFIG_ADD_MODULE = 11,
 	CAER_CONFIG_REMOVE_MODULE = 12,
+	CAER_CONFIG_BATCH = 13,
+	CAER_CONFIG_SUBSCRIBE = 14,
+	CAER_CONFIG_UNSUBSCRIBE = 15,
+	CAER_CONFIG_NOTIFY = 16,
+	CAER_CONFIG_TAP = 17,
 };
 
 void caerConfigServerStart(void);
@@ -2,12 +2,96 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <stdatomic.h>
+#include <time.h>
 #include "ext/portable_misc.h"
 #include "ext/pathmax.h"
 
+#if defined(OS_UNIX) && OS_UNIX == 1
+#include <poll.h>
+#include "ext/c11threads_posix.h"
+#endif
+
 int CAER_LOG_FILE_FD = -1;
 
-static void caerLogShutDownWriteBack(void);
+#if defined(OS_UNIX) && OS_UNIX == 1
+
+/*
+ * Asynchronous logging: threads logging through caerLogVAAsync() format their
+ * message into their own single-producer/single-consumer queue, without locks
+ * or system calls, and a writer thread takes them from there and writes them
+ * to the real outputs. Messages going through libcaer's caerLog() are written
+ * by libcaer to a non-blocking pipe instead, that the writer thread drains too.
+ * If a queue or the pipe are full, messages are dropped, not waited on.
+ * The writer also collapses identical consecutive messages into one and limits
+ * the number of lines per second, reporting what was left out.
+ */
+
+struct log_entry {
+	time_t time;
+	enum caer_log_level logLevel;
+	size_t textLength;
+	char text[CAER_LOG_MESSAGE_MAX_LENGTH]; // "SubSystem: message".
+};
+
+struct log_queue {
+	atomic_size_t head; // Written by the logging thread.
+	atomic_size_t tail; // Written by the writer thread.
+	atomic_size_t dropped;
+	atomic_bool orphaned; // Logging thread exited, free once empty.
+	struct log_queue *next;
+	struct log_entry entries[CAER_LOG_QUEUE_SIZE];
+};
+
+static struct {
+	atomic_bool running;
+	atomic_bool shutDown;
+	atomic_size_t queueing; // Threads putting a message on their queue right now.
+	thrd_t thread;
+	pthread_key_t queueKey;
+	mtx_t queuesLock;
+	struct log_queue *queues;
+	int pipeReadFd;
+	int pipeWriteFd;
+	atomic_int outputFds[2];
+} logWriter = { .pipeReadFd = -1, .pipeWriteFd = -1 };
+
+// State only accessed by the writer thread.
+static struct {
+	char pipeBuffer[CAER_LOG_MESSAGE_MAX_LENGTH * 4];
+	size_t pipeBufferLength;
+	char outBuffer[CAER_LOG_MESSAGE_MAX_LENGTH * 64];
+	size_t outBufferLength;
+	time_t timeStringTime;
+	char timeString[64];
+	char lastBody[CAER_LOG_MESSAGE_MAX_LENGTH + 16];
+	size_t lastBodyLength;
+	size_t lastRepeats;
+	time_t lastOutputTime;
+	time_t rateWindow;
+	size_t rateWindowLines;
+	size_t droppedRate;
+	size_t droppedQueue;
+} logWriterState;
+
+static bool caerLogWriterStart(void);
+static int caerLogWriterThread(void *unused);
+static void caerLogWriterRun(bool final);
+static void caerLogWriterReadPipe(void);
+static void caerLogWriterDrainQueues(void);
+static void caerLogWriterMessage(const char *timeString, size_t timeStringLength, const char *body, size_t bodyLength);
+static void caerLogWriterOutput(const char *timeString, size_t timeStringLength, const char *body, size_t bodyLength);
+static void caerLogWriterNotice(const char *format, ...) ATTRIBUTE_FORMAT(1);
+static void caerLogWriterFlush(void);
+static const char *caerLogWriterTimeString(time_t time);
+static struct log_queue *caerLogQueueGet(void);
+static void caerLogQueueOrphan(void *queue);
+static void caerLogForkPrepare(void);
+static void caerLogForkParent(void);
+static void caerLogForkChild(void);
+
+#endif
+
 static void caerLogSSHSLogger(const char *msg);
 static void caerLogLevelListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
@@ -66,11 +150,129 @@ void caerLogInit(void) {
 	// set the SSHS logger to use our internal logger too.
 	sshsSetGlobalErrorLogCallback(&caerLogSSHSLogger);
 
+#if defined(OS_UNIX) && OS_UNIX == 1
+	// From here on, logging threads don't wait on the outputs anymore.
+	// Not being able to do so is not fatal, messages are written directly then.
+	if (!caerLogWriterStart()) {
+		caerLog(CAER_LOG_WARNING, "Logger", "Failed to start log writer thread, logging synchronously.");
+	}
+#endif
+
 	// Log sub-system initialized fully and correctly, log this.
 	caerLog(CAER_LOG_NOTICE, "Logger", "Initialization successful with log-level %" PRIu8 ".", logLevel);
 }
 
-static void caerLogShutDownWriteBack(void) {
+void caerLogVAAsync(uint8_t systemLogLevel, enum caer_log_level logLevel, const char *subSystem, const char *format,
+	va_list args) {
+	if (logLevel > systemLogLevel) {
+		return;
+	}
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+	struct log_queue *queue = NULL;
+
+	// Announced before checking that the writer runs: shutdown first stops it and then
+	// waits for all announced threads, so nothing is queued after its final drain.
+	// Both sides need sequential consistency for this.
+	atomic_fetch_add(&logWriter.queueing, 1);
+
+	if (atomic_load(&logWriter.running)) {
+		queue = caerLogQueueGet();
+	}
+
+	if (queue != NULL) {
+		size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+		size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+		if ((head - tail) >= CAER_LOG_QUEUE_SIZE) {
+			// Writer can't keep up, drop instead of blocking the caller.
+			atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+			atomic_fetch_sub_explicit(&logWriter.queueing, 1, memory_order_release);
+			return;
+		}
+
+		struct log_entry *entry = &queue->entries[head % CAER_LOG_QUEUE_SIZE];
+
+		entry->time = time(NULL);
+		entry->logLevel = logLevel;
+
+		int textLength = snprintf(entry->text, CAER_LOG_MESSAGE_MAX_LENGTH, "%s: ", subSystem);
+
+		if (textLength >= 0 && textLength < CAER_LOG_MESSAGE_MAX_LENGTH) {
+			int messageLength = vsnprintf(entry->text + textLength,
+				(size_t) (CAER_LOG_MESSAGE_MAX_LENGTH - textLength), format, args);
+
+			if (messageLength > 0) {
+				textLength += messageLength;
+			}
+		}
+
+		// Truncate messages that don't fit.
+		if (textLength < 0) {
+			textLength = 0;
+		}
+		if (textLength >= CAER_LOG_MESSAGE_MAX_LENGTH) {
+			textLength = CAER_LOG_MESSAGE_MAX_LENGTH - 1;
+		}
+
+		entry->textLength = (size_t) textLength;
+
+		atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+		atomic_fetch_sub_explicit(&logWriter.queueing, 1, memory_order_release);
+
+		return;
+	}
+
+	// Writer stopped or shutting down: write directly.
+	atomic_fetch_sub_explicit(&logWriter.queueing, 1, memory_order_release);
+#endif
+
+	caerLogVAFull(caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond(), systemLogLevel, logLevel,
+		subSystem, format, args);
+}
+
+void caerLogOutputFileDescriptorsSet(int fd1, int fd2) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	atomic_store(&logWriter.outputFds[0], fd1);
+	atomic_store(&logWriter.outputFds[1], fd2);
+
+	// libcaer writes to the writer thread's pipe while it runs.
+	if (atomic_load(&logWriter.running)) {
+		return;
+	}
+#endif
+
+	caerLogFileDescriptorsSet(fd1, fd2);
+}
+
+void caerLogShutDownWriteBack(void) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	// Both called explicitly and at exit.
+	if (atomic_exchange(&logWriter.shutDown, true)) {
+		return;
+	}
+
+	if (atomic_load(&logWriter.running)) {
+		// Anything logged from now on is written directly.
+		caerLogFileDescriptorsSet(atomic_load(&logWriter.outputFds[0]), atomic_load(&logWriter.outputFds[1]));
+
+		atomic_store(&logWriter.running, false);
+
+		// Threads that still saw it running finish queueing their message first.
+		while (atomic_load(&logWriter.queueing) > 0) {
+			thrd_yield();
+		}
+
+		if ((errno = thrd_join(logWriter.thread, NULL)) != thrd_success) {
+			caerLog(CAER_LOG_ERROR, "Logger", "Failed to join log writer thread. Error: %d.", errno);
+		}
+
+		// Get anything that was queued while the thread was exiting. Nothing can be
+		// queued anymore after this, all messages go out directly now.
+		caerLogWriterRun(true);
+	}
+#endif
+
 	caerLog(CAER_LOG_DEBUG, "Logger", "Shutting down ...");
 
 	// Flush interactive outputs.
@@ -98,3 +300,404 @@ static void caerLogLevelListener(sshsNode node, void *userData, enum sshs_node_a
 		caerLog(CAER_LOG_DEBUG, "Logger", "Log-level set to %" PRIi8 ".", changeValue.ibyte);
 	}
 }
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+
+static bool caerLogWriterStart(void) {
+	atomic_store(&logWriter.outputFds[0], caerLogFileDescriptorsGetFirst());
+	atomic_store(&logWriter.outputFds[1], caerLogFileDescriptorsGetSecond());
+
+	if (pthread_key_create(&logWriter.queueKey, &caerLogQueueOrphan) != 0) {
+		return (false);
+	}
+
+	if (mtx_init(&logWriter.queuesLock, mtx_plain) != thrd_success) {
+		pthread_key_delete(logWriter.queueKey);
+		return (false);
+	}
+
+	int pipeFds[2];
+	if (pipe(pipeFds) != 0) {
+		mtx_destroy(&logWriter.queuesLock);
+		pthread_key_delete(logWriter.queueKey);
+		return (false);
+	}
+
+	// Never block libcaer's writes, nor the writer's reads.
+	for (size_t i = 0; i < 2; i++) {
+		fcntl(pipeFds[i], F_SETFL, fcntl(pipeFds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(pipeFds[i], F_SETFD, FD_CLOEXEC);
+	}
+
+	logWriter.pipeReadFd = pipeFds[0];
+	logWriter.pipeWriteFd = pipeFds[1];
+
+	atomic_store(&logWriter.running, true);
+
+	if (thrd_create(&logWriter.thread, &caerLogWriterThread, NULL) != thrd_success) {
+		atomic_store(&logWriter.running, false);
+
+		close(logWriter.pipeReadFd);
+		close(logWriter.pipeWriteFd);
+		mtx_destroy(&logWriter.queuesLock);
+		pthread_key_delete(logWriter.queueKey);
+		return (false);
+	}
+
+	// Child processes (batch mode) need their own writer thread.
+	pthread_atfork(&caerLogForkPrepare, &caerLogForkParent, &caerLogForkChild);
+
+	caerLogFileDescriptorsSet(logWriter.pipeWriteFd, -1);
+
+	return (true);
+}
+
+static int caerLogWriterThread(void *unused) {
+	UNUSED_ARGUMENT(unused);
+
+	thrd_set_name("LogWriter");
+
+	while (atomic_load_explicit(&logWriter.running, memory_order_relaxed)) {
+		// Wake up right away for libcaer messages, queues are checked periodically.
+		struct pollfd pipePoll = { .fd = logWriter.pipeReadFd, .events = POLLIN, .revents = 0 };
+		poll(&pipePoll, 1, CAER_LOG_WRITER_INTERVAL);
+
+		caerLogWriterRun(false);
+	}
+
+	return (thrd_success);
+}
+
+static void caerLogWriterRun(bool final) {
+	caerLogWriterReadPipe();
+	caerLogWriterDrainQueues();
+
+	time_t now = time(NULL);
+
+	// Report repeats periodically, so that they don't stay hidden for long.
+	if (logWriterState.lastRepeats > 0 && (final || now != logWriterState.lastOutputTime)) {
+		caerLogWriterNotice("Last message repeated %zu times.", logWriterState.lastRepeats);
+		logWriterState.lastRepeats = 0;
+	}
+
+	if (final || now != logWriterState.rateWindow) {
+		if (logWriterState.droppedRate > 0 || logWriterState.droppedQueue > 0) {
+			caerLogWriterNotice("Dropped %zu messages over the rate limit and %zu on full queues.",
+				logWriterState.droppedRate, logWriterState.droppedQueue);
+			logWriterState.droppedRate = 0;
+			logWriterState.droppedQueue = 0;
+		}
+
+		logWriterState.rateWindow = now;
+		logWriterState.rateWindowLines = 0;
+	}
+
+	caerLogWriterFlush();
+}
+
+static void caerLogWriterReadPipe(void) {
+	while (true) {
+		ssize_t readLength = read(logWriter.pipeReadFd, logWriterState.pipeBuffer + logWriterState.pipeBufferLength,
+			sizeof(logWriterState.pipeBuffer) - logWriterState.pipeBufferLength);
+
+		if (readLength <= 0) {
+			// Empty (EAGAIN), or nothing more to get.
+			return;
+		}
+
+		logWriterState.pipeBufferLength += (size_t) readLength;
+
+		// Split into lines: "Time: LEVEL: SubSystem: message\n", keep partial ones for later.
+		char *line = logWriterState.pipeBuffer;
+		size_t remaining = logWriterState.pipeBufferLength;
+		char *lineEnd;
+
+		while ((lineEnd = memchr(line, '\n', remaining)) != NULL
+			|| (line == logWriterState.pipeBuffer && remaining == sizeof(logWriterState.pipeBuffer))) {
+			// Lines too long for the buffer are cut.
+			size_t lineLength = (lineEnd != NULL) ? ((size_t) (lineEnd - line)) : (remaining);
+
+			// The time ends with its time-zone, "(TZ+0100)".
+			char *body = NULL;
+			for (size_t i = 0; (i + 2) < lineLength; i++) {
+				if (line[i] == ')' && line[i + 1] == ':' && line[i + 2] == ' ') {
+					body = line + i + 3;
+					break;
+				}
+			}
+
+			if (body != NULL) {
+				caerLogWriterMessage(line, (size_t) (body - line - 2), body, lineLength - (size_t) (body - line));
+			}
+			else {
+				caerLogWriterMessage(NULL, 0, line, lineLength);
+			}
+
+			size_t consumed = (lineEnd != NULL) ? (lineLength + 1) : (lineLength);
+			line += consumed;
+			remaining -= consumed;
+		}
+
+		memmove(logWriterState.pipeBuffer, line, remaining);
+		logWriterState.pipeBufferLength = remaining;
+	}
+}
+
+static void caerLogWriterDrainQueues(void) {
+	static const char *logLevelStrings[] = { "EMERGENCY", "ALERT", "CRITICAL", "ERROR", "WARNING", "NOTICE", "INFO",
+		"DEBUG" };
+
+	mtx_lock(&logWriter.queuesLock);
+
+	struct log_queue **queuePtr = &logWriter.queues;
+
+	while (*queuePtr != NULL) {
+		struct log_queue *queue = *queuePtr;
+
+		// Checked first, so that after draining an orphaned queue nothing can be left.
+		bool orphaned = atomic_load_explicit(&queue->orphaned, memory_order_acquire);
+
+		size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+		size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+		for (; tail != head; tail++) {
+			const struct log_entry *entry = &queue->entries[tail % CAER_LOG_QUEUE_SIZE];
+
+			char body[CAER_LOG_MESSAGE_MAX_LENGTH + 16];
+			int bodyLength = snprintf(body, sizeof(body), "%s: %.*s",
+				(entry->logLevel <= CAER_LOG_DEBUG) ? (logLevelStrings[entry->logLevel]) : ("UNKNOWN"),
+				(int) entry->textLength, entry->text);
+
+			const char *timeString = caerLogWriterTimeString(entry->time);
+
+			caerLogWriterMessage(timeString, strlen(timeString), body,
+				(bodyLength < (int) sizeof(body)) ? ((size_t) bodyLength) : (sizeof(body) - 1));
+		}
+
+		atomic_store_explicit(&queue->tail, tail, memory_order_release);
+
+		logWriterState.droppedQueue += atomic_exchange_explicit(&queue->dropped, 0, memory_order_relaxed);
+
+		if (orphaned) {
+			*queuePtr = queue->next;
+			free(queue);
+		}
+		else {
+			queuePtr = &queue->next;
+		}
+	}
+
+	mtx_unlock(&logWriter.queuesLock);
+}
+
+static void caerLogWriterMessage(const char *timeString, size_t timeStringLength, const char *body, size_t bodyLength) {
+	// Identical consecutive messages are only counted.
+	if (bodyLength == logWriterState.lastBodyLength && memcmp(body, logWriterState.lastBody, bodyLength) == 0) {
+		logWriterState.lastRepeats++;
+		return;
+	}
+
+	if (logWriterState.lastRepeats > 0) {
+		caerLogWriterNotice("Last message repeated %zu times.", logWriterState.lastRepeats);
+		logWriterState.lastRepeats = 0;
+	}
+
+	if (bodyLength > sizeof(logWriterState.lastBody)) {
+		bodyLength = sizeof(logWriterState.lastBody);
+	}
+
+	memcpy(logWriterState.lastBody, body, bodyLength);
+	logWriterState.lastBodyLength = bodyLength;
+
+	if (logWriterState.rateWindowLines >= CAER_LOG_MAX_LINES_PER_SECOND) {
+		logWriterState.droppedRate++;
+		return;
+	}
+
+	logWriterState.rateWindowLines++;
+
+	caerLogWriterOutput(timeString, timeStringLength, body, bodyLength);
+}
+
+static void caerLogWriterOutput(const char *timeString, size_t timeStringLength, const char *body, size_t bodyLength) {
+	if (timeString == NULL) {
+		timeString = caerLogWriterTimeString(time(NULL));
+		timeStringLength = strlen(timeString);
+	}
+
+	size_t lineLength = timeStringLength + 2 + bodyLength + 1; // Time, ": ", body and newline.
+
+	if ((logWriterState.outBufferLength + lineLength) > sizeof(logWriterState.outBuffer)) {
+		caerLogWriterFlush();
+
+		if (lineLength > sizeof(logWriterState.outBuffer)) {
+			return;
+		}
+	}
+
+	char *out = logWriterState.outBuffer + logWriterState.outBufferLength;
+
+	memcpy(out, timeString, timeStringLength);
+	memcpy(out + timeStringLength, ": ", 2);
+	memcpy(out + timeStringLength + 2, body, bodyLength);
+	out[lineLength - 1] = '\n';
+
+	logWriterState.outBufferLength += lineLength;
+	logWriterState.lastOutputTime = time(NULL);
+}
+
+static void caerLogWriterNotice(const char *format, ...) {
+	char body[256];
+	int bodyLength = snprintf(body, sizeof(body), "NOTICE: Logger: ");
+
+	va_list argumentList;
+	va_start(argumentList, format);
+	bodyLength += vsnprintf(body + bodyLength, sizeof(body) - (size_t) bodyLength, format, argumentList);
+	va_end(argumentList);
+
+	caerLogWriterOutput(NULL, 0, body, (bodyLength < (int) sizeof(body)) ? ((size_t) bodyLength) : (sizeof(body) - 1));
+}
+
+static void caerLogWriterFlush(void) {
+	if (logWriterState.outBufferLength == 0) {
+		return;
+	}
+
+	for (size_t i = 0; i < 2; i++) {
+		int fd = atomic_load_explicit(&logWriter.outputFds[i], memory_order_relaxed);
+
+		if (fd < 0) {
+			continue;
+		}
+
+		size_t written = 0;
+
+		while (written < logWriterState.outBufferLength) {
+			ssize_t writeLength = write(fd, logWriterState.outBuffer + written,
+				logWriterState.outBufferLength - written);
+
+			if (writeLength < 0 && errno == EINTR) {
+				continue;
+			}
+
+			if (writeLength <= 0) {
+				break;
+			}
+
+			written += (size_t) writeLength;
+		}
+	}
+
+	logWriterState.outBufferLength = 0;
+}
+
+static const char *caerLogWriterTimeString(time_t time) {
+	// Same format as libcaer, computed once per second at most.
+	if (time != logWriterState.timeStringTime || logWriterState.timeString[0] == '\0') {
+		struct tm currentTime;
+		localtime_r(&time, &currentTime);
+
+		strftime(logWriterState.timeString, sizeof(logWriterState.timeString), "%Y-%m-%d %H:%M:%S (TZ%z)",
+			&currentTime);
+
+		logWriterState.timeStringTime = time;
+	}
+
+	return (logWriterState.timeString);
+}
+
+static struct log_queue *caerLogQueueGet(void) {
+	struct log_queue *queue = pthread_getspecific(logWriter.queueKey);
+
+	if (queue != NULL) {
+		return (queue);
+	}
+
+	// First message from this thread.
+	queue = calloc(1, sizeof(struct log_queue));
+	if (queue == NULL) {
+		return (NULL);
+	}
+
+	if (pthread_setspecific(logWriter.queueKey, queue) != 0) {
+		free(queue);
+		return (NULL);
+	}
+
+	mtx_lock(&logWriter.queuesLock);
+
+	queue->next = logWriter.queues;
+	logWriter.queues = queue;
+
+	mtx_unlock(&logWriter.queuesLock);
+
+	return (queue);
+}
+
+static void caerLogQueueOrphan(void *queue) {
+	// Called at thread exit, the writer frees the queue once it's empty.
+	atomic_store_explicit(&((struct log_queue *) queue)->orphaned, true, memory_order_release);
+}
+
+static void caerLogForkPrepare(void) {
+	// Keep the queue list consistent across fork().
+	mtx_lock(&logWriter.queuesLock);
+}
+
+static void caerLogForkParent(void) {
+	mtx_unlock(&logWriter.queuesLock);
+}
+
+static void caerLogForkChild(void) {
+	// The parent's writer thread writes out everything queued before fork(),
+	// so only the forking thread's queue is kept, empty.
+	struct log_queue *ownQueue = pthread_getspecific(logWriter.queueKey);
+
+	for (struct log_queue *queue = logWriter.queues; queue != NULL; queue = queue->next) {
+		atomic_store(&queue->tail, atomic_load(&queue->head));
+		atomic_store(&queue->dropped, 0);
+
+		if (queue != ownQueue) {
+			atomic_store(&queue->orphaned, true);
+		}
+	}
+
+	mtx_unlock(&logWriter.queuesLock);
+
+	// Threads queueing at fork() time don't exist in the child.
+	atomic_store(&logWriter.queueing, 0);
+
+	memset(&logWriterState, 0, sizeof(logWriterState));
+
+	if (!atomic_load(&logWriter.running) || atomic_load(&logWriter.shutDown)) {
+		return;
+	}
+
+	// Own pipe, at the same descriptor libcaer already writes to,
+	// so the parent's writer doesn't get the child's messages.
+	int pipeFds[2];
+
+	if (pipe(pipeFds) != 0 || dup2(pipeFds[1], logWriter.pipeWriteFd) < 0) {
+		// No writer thread: write directly.
+		atomic_store(&logWriter.running, false);
+		caerLogFileDescriptorsSet(atomic_load(&logWriter.outputFds[0]), atomic_load(&logWriter.outputFds[1]));
+		return;
+	}
+
+	close(pipeFds[1]);
+	close(logWriter.pipeReadFd);
+
+	fcntl(pipeFds[0], F_SETFL, fcntl(pipeFds[0], F_GETFL) | O_NONBLOCK);
+	fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);
+	fcntl(logWriter.pipeWriteFd, F_SETFL, fcntl(logWriter.pipeWriteFd, F_GETFL) | O_NONBLOCK);
+	fcntl(logWriter.pipeWriteFd, F_SETFD, FD_CLOEXEC);
+
+	logWriter.pipeReadFd = pipeFds[0];
+
+	if (thrd_create(&logWriter.thread, &caerLogWriterThread, NULL) != thrd_success) {
+		atomic_store(&logWriter.running, false);
+		caerLogFileDescriptorsSet(atomic_load(&logWriter.outputFds[0]), atomic_load(&logWriter.outputFds[1]));
+	}
+}
+
+#endif
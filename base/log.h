@@ -14,10 +14,46 @@
 extern "C" {
 #endif
 
+// Per-thread queue size for asynchronous logging, in messages.
+#define CAER_LOG_QUEUE_SIZE 128
+// Longer messages are truncated.
+#define CAER_LOG_MESSAGE_MAX_LENGTH 1024
+// How often the writer thread checks the queues, in ms.
+#define CAER_LOG_WRITER_INTERVAL 10
+// Further lines are dropped, and their number reported.
+#define CAER_LOG_MAX_LINES_PER_SECOND 1000
+
 extern int CAER_LOG_FILE_FD;
 
 void caerLogInit(void);
 
+/**
+ * Like libcaer's caerLogVAFull(), but only queues the message, so that the
+ * caller never waits on the log outputs. A dedicated thread writes it out.
+ * The outputs are the ones set with caerLogOutputFileDescriptorsSet().
+ *
+ * @param systemLogLevel log level of the calling module or sub-system.
+ * @param logLevel log level of this message.
+ * @param subSystem name of the calling module or sub-system.
+ * @param format printf-like format string.
+ * @param args arguments for the format string.
+ */
+void caerLogVAAsync(uint8_t systemLogLevel, enum caer_log_level logLevel, const char *subSystem, const char *format,
+	va_list args);
+
+/**
+ * Set the two file descriptors log messages are written to, -1 to disable one.
+ * Use this instead of caerLogFileDescriptorsSet(), which libcaer's caerLog()
+ * uses to pass its messages on to the writer thread.
+ */
+void caerLogOutputFileDescriptorsSet(int fd1, int fd2);
+
+/**
+ * Write out all queued messages and stop the writer thread, then flush and
+ * close the log file. Called automatically at exit.
+ */
+void caerLogShutDownWriteBack(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,16 +1,26 @@
 #include "mainloop.h"
+#include "trace.h"
 #include "ext/pathmax.h"
+#include "ext/threads_ext.h"
 #include <csignal>
 
 #include <regex>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <map>
 #include <queue>
 #include <sstream>
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <array>
 
 #include <boost/filesystem.hpp>
 #include <boost/range/join.hpp>
@@ -34,6 +44,11 @@
 
 #define MODULES_DIRECTORY "modules/"
 
+// Upper bounds (in µs) of the mainloop wakeup latency histogram buckets.
+// A last bucket collects all latencies above the highest bound.
+static constexpr std::array<int64_t, 13> WAKEUP_LATENCY_BOUNDS = { { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000,
+	5000, 10000 } };
+
 #include <libcaercpp/libcaer.hpp>
 using namespace libcaer::log;
 
@@ -74,6 +89,41 @@ struct OrderedInput {
 	}
 };
 
+struct ModuleProfile {
+	// SSHS node for profiling results.
+	sshsNode node;
+	// Always collected, since last statistics update.
+	std::chrono::nanoseconds runTimeSum;
+	uint64_t runs;
+	// Collected data, since last statistics update, only if enabled.
+	std::vector<std::chrono::nanoseconds> runTimes;
+	uint64_t eventsIn;
+	uint64_t eventsOut;
+	uint64_t packetsCopied;
+	uint64_t bytesAllocated;
+
+	ModuleProfile() :
+			node(nullptr),
+			runTimeSum(0),
+			runs(0),
+			runTimes(),
+			eventsIn(0),
+			eventsOut(0),
+			packetsCopied(0),
+			bytesAllocated(0) {
+	}
+
+	void clear() {
+		runTimeSum = std::chrono::nanoseconds(0);
+		runs = 0;
+		runTimes.clear();
+		eventsIn = 0;
+		eventsOut = 0;
+		packetsCopied = 0;
+		bytesAllocated = 0;
+	}
+};
+
 struct ModuleInfo {
 	// Module identification.
 	int16_t id;
@@ -91,6 +141,14 @@ struct ModuleInfo {
 	caerModuleInfo libraryInfo;
 	// Module runtime data.
 	caerModuleData runtimeData;
+	// Global event packet storage slots whose content this module modifies.
+	std::vector<size_t> modifiedSlots;
+	// Parallel execution level (modules on the same level are independent).
+	size_t executionLevel;
+	// Execution time of the last run.
+	std::chrono::nanoseconds runTime;
+	// Run time statistics, detailed ones only collected if enabled.
+	ModuleProfile profile;
 
 	ModuleInfo() :
 			id(-1),
@@ -99,7 +157,9 @@ struct ModuleInfo {
 			library(),
 			libraryHandle(),
 			libraryInfo(nullptr),
-			runtimeData(nullptr) {
+			runtimeData(nullptr),
+			executionLevel(0),
+			runTime(0) {
 	}
 
 	ModuleInfo(int16_t i, const std::string &n, sshsNode c, const std::string &l) :
@@ -109,7 +169,9 @@ struct ModuleInfo {
 			library(l),
 			libraryHandle(),
 			libraryInfo(nullptr),
-			runtimeData(nullptr) {
+			runtimeData(nullptr),
+			executionLevel(0),
+			runTime(0) {
 	}
 };
 
@@ -201,19 +263,509 @@ struct ActiveStreams {
 	}
 };
 
+struct StreamTap {
+	int32_t id;
+	int16_t sourceId;
+	int16_t typeId;
+	caerMainloopTapCallback callback;
+	void *userData;
+};
+
+static void runModule(ModuleInfo &m, caerEventPacketContainer in);
+
+/**
+ * Worker pool used for parallel module execution. Modules are executed
+ * level by level: all modules on a level have no data dependencies between
+ * them and are distributed to the workers (and the mainloop thread itself),
+ * the next level only starts once the current one has completely finished.
+ */
+class ModuleExecutionPool {
+private:
+	std::vector<std::thread> workers;
+	std::vector<caerEventPacketContainer> workerContainers;
+	std::mutex poolLock;
+	std::condition_variable workAvailable;
+	std::condition_variable workDone;
+	const std::vector<std::reference_wrapper<ModuleInfo>> *level;
+	size_t levelGeneration;
+	size_t nextModule;
+	size_t modulesDone;
+	bool shutdown;
+	std::exception_ptr failure;
+
+public:
+	ModuleExecutionPool(size_t workersNumber, size_t maxInputs) :
+			level(nullptr),
+			levelGeneration(0),
+			nextModule(0),
+			modulesDone(0),
+			shutdown(false) {
+		// Each worker needs its own input container, they are filled concurrently.
+		for (size_t i = 0; i < workersNumber; i++) {
+			caerEventPacketContainer container = caerEventPacketContainerAllocate(static_cast<int32_t>(maxInputs));
+			if (container == nullptr) {
+				freeContainers();
+				throw std::bad_alloc();
+			}
+
+			workerContainers.push_back(container);
+		}
+
+		try {
+			for (size_t i = 0; i < workersNumber; i++) {
+				workers.push_back(std::thread(&ModuleExecutionPool::workerThread, this, i));
+			}
+		}
+		catch (const std::system_error &) {
+			stopWorkers();
+			freeContainers();
+			throw;
+		}
+	}
+
+	~ModuleExecutionPool() {
+		stopWorkers();
+		freeContainers();
+	}
+
+	size_t size() const noexcept {
+		return (workers.size());
+	}
+
+	void runLevel(const std::vector<std::reference_wrapper<ModuleInfo>> &lvl, caerEventPacketContainer in) {
+		size_t generation;
+
+		{
+			std::lock_guard<std::mutex> lock(poolLock);
+
+			level = &lvl;
+			nextModule = 0;
+			modulesDone = 0;
+			failure = nullptr;
+
+			generation = ++levelGeneration;
+		}
+
+		workAvailable.notify_all();
+
+		// The mainloop thread participates in executing the current level.
+		executeLevel(generation, in);
+
+		// Wait for all modules of this level to be done.
+		std::unique_lock<std::mutex> lock(poolLock);
+
+		workDone.wait(lock, [this, &lvl]() {return (modulesDone == lvl.size());});
+
+		// Propagate failures to the mainloop thread, as in serial execution.
+		if (failure) {
+			std::rethrow_exception(failure);
+		}
+	}
+
+private:
+	void workerThread(size_t workerId) {
+		// Set thread name.
+		std::string threadName = "MainloopWorker" + std::to_string(workerId);
+		thrd_set_name(threadName.c_str());
+
+		size_t seenGeneration = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(poolLock);
+
+				workAvailable.wait(lock, [this, seenGeneration]() {
+					return (shutdown || levelGeneration != seenGeneration);
+				});
+
+				if (shutdown) {
+					return;
+				}
+
+				seenGeneration = levelGeneration;
+			}
+
+			executeLevel(seenGeneration, workerContainers[workerId]);
+		}
+	}
+
+	void executeLevel(size_t generation, caerEventPacketContainer in) {
+		while (true) {
+			ModuleInfo *m;
+
+			{
+				std::lock_guard<std::mutex> lock(poolLock);
+
+				// Only take work from the level this call was started for,
+				// and stop once all its modules have been handed out.
+				if (generation != levelGeneration || nextModule >= level->size()) {
+					return;
+				}
+
+				m = &(*level)[nextModule++].get();
+			}
+
+			try {
+				runModule(*m, in);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(poolLock);
+
+				if (!failure) {
+					failure = std::current_exception();
+				}
+			}
+
+			bool levelDone;
+
+			{
+				std::lock_guard<std::mutex> lock(poolLock);
+
+				levelDone = (++modulesDone == level->size());
+			}
+
+			if (levelDone) {
+				workDone.notify_all();
+			}
+		}
+	}
+
+	void stopWorkers() {
+		{
+			std::lock_guard<std::mutex> lock(poolLock);
+			shutdown = true;
+		}
+
+		workAvailable.notify_all();
+
+		for (auto &t : workers) {
+			t.join();
+		}
+
+		workers.clear();
+	}
+
+	void freeContainers() {
+		for (auto c : workerContainers) {
+			free(c);
+		}
+
+		workerContainers.clear();
+	}
+};
+
+/**
+ * Header in front of every event packet handed out by the pool. The packet itself
+ * starts right after it, so the header is found from the packet pointer alone.
+ */
+struct alignas(std::max_align_t) PacketBlock {
+	// References to the packet, its owner's included (see retain/release).
+	std::atomic<uint32_t> references;
+	// Size class of the block, or NO_SIZE_CLASS for blocks too big to be recycled.
+	uint32_t sizeClass;
+	// Usable memory after the header, in bytes.
+	size_t size;
+};
+
+static inline PacketBlock *getPacketBlock(caerEventPacketHeaderConst packet) {
+	return (reinterpret_cast<PacketBlock *>(const_cast<caerEventPacketHeader>(packet)) - 1);
+}
+
+static inline caerEventPacketHeader getBlockPacket(PacketBlock *block) {
+	return (reinterpret_cast<caerEventPacketHeader>(block + 1));
+}
+
+/**
+ * Pool of event packet memory, to recycle the buffers of packets freed at the end
+ * of a mainloop run, instead of going back to the system allocator every time.
+ * Blocks are rounded up to a power of two and kept in one free list per size class,
+ * each with its own lock, so threads allocating and releasing packets of different
+ * sizes never wait on each other. Rounding bounds the waste to half a block.
+ * Pool memory carries a header in front of the packet (see PacketBlock), so it must
+ * only ever be released or resized through the pool, never with free()/realloc().
+ * Thread-safe: packets are released from module threads too (see retain/release).
+ */
+class EventPacketPool {
+private:
+	static constexpr size_t MIN_SIZE_CLASS_SHIFT = 8; // 256 bytes.
+	static constexpr size_t SIZE_CLASSES = 19; // Up to 64 MB.
+	static constexpr uint32_t NO_SIZE_CLASS = UINT32_MAX;
+
+	struct SizeClass {
+		std::mutex lock;
+		std::vector<PacketBlock *> freeBlocks;
+	};
+
+	std::array<SizeClass, SIZE_CLASSES> sizeClasses;
+	// Packets of all the blocks currently owned by the pool, handed out or free.
+	// Only changes when memory is taken from or given back to the system.
+	std::mutex packetsLock;
+	std::unordered_set<caerEventPacketHeaderConst> packets;
+	std::atomic<size_t> maxBuffers;
+	std::atomic<size_t> cachedSize;
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+	std::atomic<uint64_t> recycled;
+	std::atomic<uint64_t> discarded;
+	std::atomic<uint64_t> adopted;
+
+	static uint32_t getSizeClass(size_t size) {
+		size_t blockSize = sizeof(PacketBlock) + size;
+
+		for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASSES; sizeClass++) {
+			if (blockSize <= getSizeClassBlockSize(sizeClass)) {
+				return (sizeClass);
+			}
+		}
+
+		return (NO_SIZE_CLASS);
+	}
+
+	static size_t getSizeClassBlockSize(uint32_t sizeClass) {
+		return (static_cast<size_t>(1) << (MIN_SIZE_CLASS_SHIFT + sizeClass));
+	}
+
+	void freeBlock(PacketBlock *block) {
+		{
+			std::lock_guard<std::mutex> lock(packetsLock);
+
+			packets.erase(getBlockPacket(block));
+		}
+
+		free(block);
+	}
+
+public:
+	struct Statistics {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t recycled;
+		uint64_t discarded;
+		uint64_t adopted;
+		size_t cachedSize;
+	};
+
+	EventPacketPool() :
+			maxBuffers(0),
+			cachedSize(0),
+			hits(0),
+			misses(0),
+			recycled(0),
+			discarded(0),
+			adopted(0) {
+	}
+
+	~EventPacketPool() {
+		clear();
+	}
+
+	caerEventPacketHeader allocate(size_t size) {
+		uint32_t sizeClass = getSizeClass(size);
+
+		if (sizeClass != NO_SIZE_CLASS) {
+			SizeClass &freeList = sizeClasses[sizeClass];
+			PacketBlock *block = nullptr;
+
+			{
+				std::lock_guard<std::mutex> lock(freeList.lock);
+
+				if (!freeList.freeBlocks.empty()) {
+					block = freeList.freeBlocks.back();
+					freeList.freeBlocks.pop_back();
+				}
+			}
+
+			if (block != nullptr) {
+				block->references.store(1, std::memory_order_relaxed);
+
+				cachedSize.fetch_sub(getSizeClassBlockSize(sizeClass), std::memory_order_relaxed);
+				hits.fetch_add(1, std::memory_order_relaxed);
+
+				return (getBlockPacket(block));
+			}
+		}
+
+		misses.fetch_add(1, std::memory_order_relaxed);
+
+		size_t blockSize = (sizeClass != NO_SIZE_CLASS) ?
+			(getSizeClassBlockSize(sizeClass)) : (sizeof(PacketBlock) + size);
+
+		void *memory = malloc(blockSize);
+		if (memory == nullptr) {
+			return (nullptr);
+		}
+
+		PacketBlock *block = new (memory) PacketBlock();
+		block->references.store(1, std::memory_order_relaxed);
+		block->sizeClass = sizeClass;
+		block->size = blockSize - sizeof(PacketBlock);
+
+		caerEventPacketHeader packet = getBlockPacket(block);
+
+		std::lock_guard<std::mutex> lock(packetsLock);
+
+		packets.insert(packet);
+
+		return (packet);
+	}
+
+	caerEventPacketHeader resize(caerEventPacketHeader packet, size_t size) {
+		PacketBlock *block = getPacketBlock(packet);
+
+		// Shrinking, or growing into the rest of the block, needs no work at all.
+		if (size <= block->size) {
+			return (packet);
+		}
+
+		caerEventPacketHeader resizedPacket = allocate(size);
+		if (resizedPacket == nullptr) {
+			// Same as realloc(), the original packet is untouched.
+			return (nullptr);
+		}
+
+		memcpy(resizedPacket, packet, block->size);
+
+		recycle(packet);
+
+		return (resizedPacket);
+	}
+
+	void recycle(caerEventPacketHeader packet) {
+		PacketBlock *block = getPacketBlock(packet);
+
+		if (block->sizeClass != NO_SIZE_CLASS) {
+			SizeClass &freeList = sizeClasses[block->sizeClass];
+
+			std::lock_guard<std::mutex> lock(freeList.lock);
+
+			if (freeList.freeBlocks.size() < maxBuffers.load(std::memory_order_relaxed)) {
+				freeList.freeBlocks.push_back(block);
+
+				cachedSize.fetch_add(getSizeClassBlockSize(block->sizeClass), std::memory_order_relaxed);
+				recycled.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		discarded.fetch_add(1, std::memory_order_relaxed);
+
+		freeBlock(block);
+	}
+
+	/**
+	 * Whether the packet is pool memory. Only needed for packets modules hand to the
+	 * mainloop, which may have been allocated anywhere (libcaer mostly).
+	 */
+	bool owns(caerEventPacketHeaderConst packet) {
+		std::lock_guard<std::mutex> lock(packetsLock);
+
+		return (packets.count(packet) == 1);
+	}
+
+	/**
+	 * Take over a packet allocated outside of the pool: its content is moved into
+	 * pool memory, and the original is freed. Pool packets are returned unchanged.
+	 * Only the events in use are kept, so eventCapacity becomes eventNumber.
+	 */
+	caerEventPacketHeader adopt(caerEventPacketHeader packet) {
+		if (owns(packet)) {
+			return (packet);
+		}
+
+		int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+		size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE
+			+ (static_cast<size_t>(eventNumber) * static_cast<size_t>(caerEventPacketHeaderGetEventSize(packet)));
+
+		caerEventPacketHeader poolPacket = allocate(packetSize);
+		if (poolPacket != nullptr) {
+			memcpy(poolPacket, packet, packetSize);
+			caerEventPacketHeaderSetEventCapacity(poolPacket, eventNumber);
+
+			adopted.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		free(packet);
+
+		return (poolPacket);
+	}
+
+	void setMaxBuffers(size_t max) {
+		maxBuffers.store(max, std::memory_order_relaxed);
+
+		// Shrink free lists that are now too big.
+		for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASSES; sizeClass++) {
+			SizeClass &freeList = sizeClasses[sizeClass];
+
+			std::lock_guard<std::mutex> lock(freeList.lock);
+
+			while (freeList.freeBlocks.size() > max) {
+				cachedSize.fetch_sub(getSizeClassBlockSize(sizeClass), std::memory_order_relaxed);
+				freeBlock(freeList.freeBlocks.back());
+				freeList.freeBlocks.pop_back();
+			}
+		}
+	}
+
+	void clear() {
+		for (uint32_t sizeClass = 0; sizeClass < SIZE_CLASSES; sizeClass++) {
+			SizeClass &freeList = sizeClasses[sizeClass];
+
+			std::lock_guard<std::mutex> lock(freeList.lock);
+
+			for (auto block : freeList.freeBlocks) {
+				cachedSize.fetch_sub(getSizeClassBlockSize(sizeClass), std::memory_order_relaxed);
+				freeBlock(block);
+			}
+
+			// Blocks still in use are still owned, they go back to the pool on release.
+			freeList.freeBlocks.clear();
+		}
+	}
+
+	Statistics getStatistics() const {
+		return (Statistics { hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed),
+			recycled.load(std::memory_order_relaxed), discarded.load(std::memory_order_relaxed),
+			adopted.load(std::memory_order_relaxed), cachedSize.load(std::memory_order_relaxed) });
+	}
+};
+
 static struct {
 	sshsNode configNode;
+	sshsNode mainloopNode;
 	atomic_bool systemRunning;
 	atomic_bool running;
 	atomic_uint_fast32_t dataAvailable;
+	std::mutex dataLock;
+	std::condition_variable dataCond;
+	std::atomic_bool dataWaiting;
+	std::atomic<int64_t> dataNotifyTime;
+	std::atomic<int32_t> wakeupSpinTime;
+	sshsNode wakeupLatencyNode;
+	std::array<uint64_t, WAKEUP_LATENCY_BOUNDS.size() + 1> wakeupLatencyHistogram;
+	uint64_t wakeupLatencySamples;
+	int64_t wakeupLatencyMaximum;
 	size_t copyCount;
 	std::unordered_map<int16_t, ModuleInfo> modules;
 	std::vector<ActiveStreams> streams;
 	std::vector<std::reference_wrapper<ModuleInfo>> globalExecution;
+	std::vector<std::vector<std::reference_wrapper<ModuleInfo>>> parallelExecution;
+	std::unique_ptr<ModuleExecutionPool> executionPool;
 	std::vector<caerEventPacketHeader> eventPackets;
+	sshsNode packetPoolNode;
+	EventPacketPool packetPool;
+	std::chrono::nanoseconds criticalPathTimeSum;
+	size_t executionRuns;
+	std::atomic_bool moduleProfiling;
+	std::atomic<size_t> tapsNumber;
+	std::mutex tapsLock;
+	std::vector<StreamTap> taps;
+	int32_t tapsNextId;
+	bool stopOnInputEnd;
+	int result;
 } glMainloopData;
 
 static int caerMainloopRunner();
+static bool inputsEnded(bool &inputsFailed);
 static void printDebugInformation();
 static void caerMainloopSignalHandler(int signal);
 static void caerMainloopSystemRunningListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -222,8 +774,10 @@ static void caerMainloopRunningListener(sshsNode node, void *userData, enum sshs
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 static void caerModulesUpdateInformation(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+static void caerMainloopConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
-void caerMainloopRun(void) {
+int caerMainloopRun(void) {
 	// Install signal handler for global shutdown.
 #if defined(OS_WINDOWS)
 	if (signal(SIGTERM, &caerMainloopSignalHandler) == SIG_ERR) {
@@ -297,6 +851,8 @@ void caerMainloopRun(void) {
 
 	// No data at start-up.
 	glMainloopData.dataAvailable.store(0);
+	glMainloopData.dataWaiting.store(false);
+	glMainloopData.dataNotifyTime.store(0);
 
 	// System running control, separate to allow mainloop stop/start.
 	glMainloopData.systemRunning.store(true);
@@ -314,6 +870,73 @@ void caerMainloopRun(void) {
 		"Mainloop start/stop.");
 	sshsNodeAddAttributeListener(glMainloopData.configNode, nullptr, &caerMainloopRunningListener);
 
+	// Mainloop execution configuration and statistics.
+	glMainloopData.mainloopNode = sshsGetNode(sshsGetGlobal(), "/caer/mainloop/");
+	sshsNodeCreateBool(glMainloopData.mainloopNode, "parallelExecution", false, SSHS_FLAGS_NORMAL,
+		"Run modules that don't depend on each other's data in parallel (applied on mainloop start).");
+	sshsNodeCreateInt(glMainloopData.mainloopNode, "parallelWorkers", 4, 1, 64, SSHS_FLAGS_NORMAL,
+		"Maximum number of additional threads for parallel module execution (applied on mainloop start).");
+	sshsNodeCreateLong(glMainloopData.mainloopNode, "executionTime", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average time spent running all modules once, in ns.");
+	sshsNodeCreateLong(glMainloopData.mainloopNode, "criticalPathTime", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Average time of the critical path (slowest module of each execution level) per run, in ns.");
+
+	sshsNodeCreateBool(glMainloopData.mainloopNode, "moduleProfiling", false, SSHS_FLAGS_NORMAL,
+		"Collect detailed per-module statistics, published in each module's 'profiling/' node next to the run time.");
+	glMainloopData.moduleProfiling.store(sshsNodeGetBool(glMainloopData.mainloopNode, "moduleProfiling"));
+
+	sshsNodeCreateBool(glMainloopData.mainloopNode, "stopOnInputEnd", false, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
+		"Shut down the whole system once all input modules have stopped, for example at the end of their files. "
+			"Input modules must not restart automatically.");
+	glMainloopData.stopOnInputEnd = sshsNodeGetBool(glMainloopData.mainloopNode, "stopOnInputEnd");
+	glMainloopData.result = EXIT_SUCCESS;
+
+	sshsNodeCreateInt(glMainloopData.mainloopNode, "wakeupSpinTime", 0, 0, 1000000, SSHS_FLAGS_NORMAL,
+		"Time to busy-wait for new data before blocking, in µs. Lowers latency at the cost of CPU usage.");
+	glMainloopData.wakeupSpinTime.store(sshsNodeGetInt(glMainloopData.mainloopNode, "wakeupSpinTime"));
+	sshsNodeAddAttributeListener(glMainloopData.mainloopNode, nullptr, &caerMainloopConfigListener);
+
+	// Histogram of the time between data becoming available and the mainloop running.
+	glMainloopData.wakeupLatencyNode = sshsGetRelativeNode(glMainloopData.mainloopNode, "wakeupLatency/");
+
+	sshsNodeCreateLong(glMainloopData.wakeupLatencyNode, "samples", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of wakeup latency samples.");
+	sshsNodeCreateLong(glMainloopData.wakeupLatencyNode, "maximum", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Maximum wakeup latency, in µs.");
+
+	for (auto bound : WAKEUP_LATENCY_BOUNDS) {
+		const std::string key = "upTo" + std::to_string(bound) + "us";
+		sshsNodeCreateLong(glMainloopData.wakeupLatencyNode, key.c_str(), 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of wakeups with latency in this bucket.");
+	}
+
+	const std::string overKey = "over" + std::to_string(WAKEUP_LATENCY_BOUNDS.back()) + "us";
+	sshsNodeCreateLong(glMainloopData.wakeupLatencyNode, overKey.c_str(), 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of wakeups with latency in this bucket.");
+
+	// Event packet memory recycling.
+	glMainloopData.packetPoolNode = sshsGetRelativeNode(glMainloopData.mainloopNode, "packetPool/");
+
+	sshsNodeCreateInt(glMainloopData.packetPoolNode, "maxBuffers", 32, 0, 4096, SSHS_FLAGS_NORMAL,
+		"Maximum number of free packet buffers to keep for reuse, per size class. 0 disables recycling.");
+	glMainloopData.packetPool.setMaxBuffers(
+		static_cast<size_t>(sshsNodeGetInt(glMainloopData.packetPoolNode, "maxBuffers")));
+	sshsNodeAddAttributeListener(glMainloopData.packetPoolNode, nullptr, &caerMainloopConfigListener);
+
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "hits", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of packet allocations served from the pool.");
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "misses", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of packet allocations that needed new memory.");
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "recycled", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of freed packets kept in the pool for reuse.");
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "discarded", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of freed packets released because the pool was full.");
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "adopted", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of module output packets moved into pool memory.");
+	sshsNodeCreateLong(glMainloopData.packetPoolNode, "cachedSize", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Memory currently held by the pool, in bytes.");
+
 	while (glMainloopData.systemRunning.load()) {
 		if (!glMainloopData.running.load()) {
 			std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -337,6 +960,12 @@ void caerMainloopRun(void) {
 
 		// On failure, make sure to disable mainloop, user will have to fix it.
 		if (result == EXIT_FAILURE) {
+			// Nobody is going to fix it when running unattended, just stop.
+			if (glMainloopData.stopOnInputEnd) {
+				glMainloopData.systemRunning.store(false);
+				glMainloopData.result = EXIT_FAILURE;
+			}
+
 			sshsNodePutBool(glMainloopData.configNode, "running", false);
 
 			log(logLevel::CRITICAL, "Mainloop",
@@ -346,9 +975,13 @@ void caerMainloopRun(void) {
 	}
 
 	// Remove attribute listeners for clean shutdown.
+	sshsNodeRemoveAttributeListener(glMainloopData.packetPoolNode, nullptr, &caerMainloopConfigListener);
+	sshsNodeRemoveAttributeListener(glMainloopData.mainloopNode, nullptr, &caerMainloopConfigListener);
 	sshsNodeRemoveAttributeListener(glMainloopData.configNode, nullptr, &caerMainloopRunningListener);
 	sshsNodeRemoveAttributeListener(systemNode, nullptr, &caerMainloopSystemRunningListener);
 	sshsNodeRemoveAttributeListener(modulesNode, nullptr, &caerModulesUpdateInformation);
+
+	return (glMainloopData.result);
 }
 
 static void checkInputOutputStreamDefinitions(caerModuleInfo info) {
@@ -1373,6 +2006,9 @@ static void buildConnectivity() {
 							// Update active inputs with a viable index.
 							m.get().inputs.push_back(std::make_pair(idx->index, -1));
 
+							// Data is modified in-place.
+							m.get().modifiedSlots.push_back(idx->index);
+
 							// Put combination into indexes table.
 							indexes.push_back(ModuleSlot(orderIn.typeId, m.get().id, idx->index));
 						}
@@ -1382,6 +2018,9 @@ static void buildConnectivity() {
 							// next free one and set copyFrom index to the old one.
 							m.get().inputs.push_back(std::make_pair(nextFreeSlot, idx->index));
 
+							// Data is modified on the copy.
+							m.get().modifiedSlots.push_back(nextFreeSlot);
+
 							// Put combination into indexes table.
 							indexes.push_back(ModuleSlot(orderIn.typeId, m.get().id, nextFreeSlot));
 
@@ -1427,6 +2066,77 @@ static void buildConnectivity() {
 	}
 }
 
+static void buildParallelExecution() {
+	// Determine which global event packet storage slots each module reads and
+	// writes, in global execution order. Copies are done by the thread running
+	// the module, so the copy source is read and the copy destination written.
+	std::vector<std::unordered_set<size_t>> readSlots;
+	std::vector<std::unordered_set<size_t>> writeSlots;
+
+	for (const auto &m : glMainloopData.globalExecution) {
+		std::unordered_set<size_t> reads;
+		std::unordered_set<size_t> writes;
+
+		for (const auto &input : m.get().inputs) {
+			if (input.second == -1) {
+				reads.insert(static_cast<size_t>(input.first));
+			}
+			else {
+				reads.insert(static_cast<size_t>(input.second));
+				writes.insert(static_cast<size_t>(input.first));
+			}
+		}
+
+		for (auto slot : m.get().modifiedSlots) {
+			writes.insert(slot);
+		}
+
+		for (const auto &output : m.get().outputs) {
+			if (output.second >= 0) {
+				writes.insert(static_cast<size_t>(output.second));
+			}
+		}
+
+		readSlots.push_back(reads);
+		writeSlots.push_back(writes);
+	}
+
+	auto intersects = [](const std::unordered_set<size_t> &a, const std::unordered_set<size_t> &b) {
+		return (findIfBool(a.begin(), a.end(), [&b](size_t slot) {return (b.count(slot) == 1);}));
+	};
+
+	// A module's level is one higher than the highest level of any module before
+	// it in the global execution order that it conflicts with: reading what the
+	// other writes, writing what the other reads, or both writing the same slot.
+	// Modules on the same level are thus independent and can run concurrently.
+	glMainloopData.parallelExecution.clear();
+
+	for (size_t i = 0; i < glMainloopData.globalExecution.size(); i++) {
+		ModuleInfo &m = glMainloopData.globalExecution[i].get();
+
+		m.executionLevel = 0;
+
+		for (size_t j = 0; j < i; j++) {
+			const ModuleInfo &prev = glMainloopData.globalExecution[j].get();
+
+			if (prev.executionLevel < m.executionLevel) {
+				continue;
+			}
+
+			if (intersects(writeSlots[j], readSlots[i]) || intersects(writeSlots[j], writeSlots[i])
+				|| intersects(readSlots[j], writeSlots[i])) {
+				m.executionLevel = prev.executionLevel + 1;
+			}
+		}
+
+		if (glMainloopData.parallelExecution.size() <= m.executionLevel) {
+			glMainloopData.parallelExecution.resize(m.executionLevel + 1);
+		}
+
+		glMainloopData.parallelExecution[m.executionLevel].push_back(m);
+	}
+}
+
 static size_t getMaximumInputNumber() {
 	size_t maxSize = 0;
 
@@ -1441,125 +2151,445 @@ static size_t getMaximumInputNumber() {
 	return (maxSize);
 }
 
-static void runModules(caerEventPacketContainer in) {
-	// Run through all modules in order.
-	for (const auto &m : glMainloopData.globalExecution) {
-		// Prepare input container.
-		// Clean up container. NULL pointers, memory has been already freed
-		// previously from the global event packets storage.
-		for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
-			in->eventPackets[i] = nullptr;
+static bool isPacketShared(caerEventPacketHeaderConst packet) {
+	// Only the caller's reference left means no other one can appear concurrently,
+	// as retaining needs a reference. If unique, the fence orders the caller's writes
+	// after the reads done by others before they released their references.
+	bool shared = (getPacketBlock(packet)->references.load(std::memory_order_relaxed) != 1);
+
+	if (!shared) {
+		std::atomic_thread_fence(std::memory_order_acquire);
+	}
+
+	return (shared);
+}
+
+static void tapModuleOutputs(const ModuleInfo &m) {
+	std::lock_guard<std::mutex> lock(glMainloopData.tapsLock);
+
+	for (const auto &tap : glMainloopData.taps) {
+		if (tap.sourceId != m.id) {
+			continue;
+		}
+
+		const auto output = m.outputs.find(tap.typeId);
+		if (output == m.outputs.end() || output->second == -1) {
+			continue;
 		}
 
-		// Insert new packets into container based on declared inputs.
-		// If needed, copy the packet and publish the copy globally.
-		int32_t idx = 0;
+		caerEventPacketHeader packet = glMainloopData.eventPackets[static_cast<size_t>(output->second)];
 
-		for (const auto &input : m.get().inputs) {
-			if (input.second == -1) {
-				// No copy needed.
-				in->eventPackets[idx] = glMainloopData.eventPackets[static_cast<size_t>(input.first)];
-			}
-			else {
-				// Copy is needed. Do it and update the global event packet storage.
-				caerEventPacketHeader packetCopy = caerEventPacketCopyOnlyEvents(
-					glMainloopData.eventPackets[static_cast<size_t>(input.second)]);
+		// Modules that later change this packet in-place get their own copy.
+		if (packet != nullptr) {
+			(*tap.callback)(tap.userData, caerMainloopPacketRetain(packet));
+		}
+	}
+}
 
-				in->eventPackets[idx] = packetCopy;
+static void runModule(ModuleInfo &m, caerEventPacketContainer in) {
+	caerTraceEvent(CAER_TRACE_MODULE_RUN, CAER_TRACE_BEGIN, m.id, 0);
+
+	auto runStart = std::chrono::steady_clock::now();
+
+	bool profiling = glMainloopData.moduleProfiling.load(std::memory_order_relaxed);
+
+	// Prepare input container.
+	// Clean up container. NULL pointers, memory has been already freed
+	// previously from the global event packets storage.
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(in); i++) {
+		in->eventPackets[i] = nullptr;
+	}
+
+	// Insert new packets into container based on declared inputs.
+	// If needed, copy the packet and publish the copy globally.
+	int32_t idx = 0;
+
+	for (const auto &input : m.inputs) {
+		if (input.second == -1) {
+			// No copy needed.
+			caerEventPacketHeader packet = glMainloopData.eventPackets[static_cast<size_t>(input.first)];
+
+			// Copy-on-write: if this module modifies the data in-place, but some other
+			// module has retained the packet, give this module its own copy.
+			if (packet != nullptr
+				&& findBool(m.modifiedSlots.begin(), m.modifiedSlots.end(), static_cast<size_t>(input.first))
+				&& isPacketShared(packet)) {
+				caerEventPacketHeader packetCopy = caerMainloopPacketCopyOnlyEvents(packet);
+
+				caerMainloopPacketRelease(packet);
+
+				packet = packetCopy;
 				glMainloopData.eventPackets[static_cast<size_t>(input.first)] = packetCopy;
+
+				if (profiling && packetCopy != nullptr) {
+					m.profile.packetsCopied++;
+					m.profile.bytesAllocated += static_cast<uint64_t>(caerEventPacketGetSize(packetCopy));
+				}
 			}
 
-			// Only increment container size if we actually added a packet with data.
-			if (in->eventPackets[idx] != nullptr) {
-				idx++;
+			in->eventPackets[idx] = packet;
+		}
+		else {
+			// Copy is needed. Do it and update the global event packet storage.
+			caerEventPacketHeader packetCopy = caerMainloopPacketCopyOnlyEvents(
+				glMainloopData.eventPackets[static_cast<size_t>(input.second)]);
+
+			in->eventPackets[idx] = packetCopy;
+			glMainloopData.eventPackets[static_cast<size_t>(input.first)] = packetCopy;
+
+			if (profiling && packetCopy != nullptr) {
+				m.profile.packetsCopied++;
+				m.profile.bytesAllocated += static_cast<uint64_t>(caerEventPacketGetSize(packetCopy));
 			}
 		}
 
-		// Reset number of contained event packets, this also updates statistics.
-		caerEventPacketContainerSetEventPacketsNumber(in, idx);
+		// Only increment container size if we actually added a packet with data.
+		if (in->eventPackets[idx] != nullptr) {
+			if (profiling) {
+				m.profile.eventsIn += static_cast<uint64_t>(caerEventPacketHeaderGetEventNumber(in->eventPackets[idx]));
+			}
 
-		// Debug logging.
-		caerModuleLog(m.get().runtimeData, CAER_LOG_DEBUG, "Module Input: passing %" PRIi32 " packets.", idx);
-		caerModuleLog(m.get().runtimeData, CAER_LOG_DEBUG, "Module Output: expecting %zu packets.",
-			m.get().outputs.size());
+			idx++;
+		}
+	}
 
-		// Run module state machine.
-		caerEventPacketContainer out = nullptr;
-		caerModuleSM(m.get().libraryInfo->functions, m.get().runtimeData, m.get().libraryInfo->memSize,
-			(idx > 0) ? (in) : (nullptr), (m.get().outputs.size() > 0) ? (&out) : (nullptr));
+	// Reset number of contained event packets, this also updates statistics.
+	caerEventPacketContainerSetEventPacketsNumber(in, idx);
 
-		// Parse possible output container.
-		if (out != nullptr) {
-			caerModuleLog(m.get().runtimeData, CAER_LOG_DEBUG, "Module Output: got %" PRIi32 " packets.",
-				caerEventPacketContainerGetEventPacketsNumber(out));
+	// Debug logging.
+	caerModuleLog(m.runtimeData, CAER_LOG_DEBUG, "Module Input: passing %" PRIi32 " packets.", idx);
+	caerModuleLog(m.runtimeData, CAER_LOG_DEBUG, "Module Output: expecting %zu packets.", m.outputs.size());
 
-			// Go through all packets, put them in their right place inside
-			// the global event storage.
-			for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(out); i++) {
-				caerEventPacketHeader packet = out->eventPackets[i];
+	// Run module state machine.
+	caerEventPacketContainer out = nullptr;
+	caerModuleSM(m.libraryInfo->functions, m.runtimeData, m.libraryInfo->memSize,
+		(idx > 0) ? (in) : (nullptr), (m.outputs.size() > 0) ? (&out) : (nullptr));
 
-				// Got a packet!
-				if (packet != nullptr) {
-					// Check that the source ID indeed comes from this module!
-					int16_t sourceId = caerEventPacketHeaderGetEventSource(packet);
-					if (sourceId != m.get().id) {
-						boost::format exMsg = boost::format(
-							"Got event packet back from module '%s' (ID %d) with source ID set to %d.") % m.get().name
-							% m.get().id % sourceId;
-						throw std::runtime_error(exMsg.str());
-					}
+	// Parse possible output container.
+	if (out != nullptr) {
+		caerModuleLog(m.runtimeData, CAER_LOG_DEBUG, "Module Output: got %" PRIi32 " packets.",
+			caerEventPacketContainerGetEventPacketsNumber(out));
 
-					int16_t typeId = caerEventPacketHeaderGetEventType(packet);
+		// Go through all packets, put them in their right place inside
+		// the global event storage.
+		for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(out); i++) {
+			caerEventPacketHeader packet = out->eventPackets[i];
 
-					ssize_t destIdx = -1;
+			// Got a packet!
+			if (packet != nullptr) {
+				// Check that the source ID indeed comes from this module!
+				int16_t sourceId = caerEventPacketHeaderGetEventSource(packet);
+				if (sourceId != m.id) {
+					boost::format exMsg = boost::format(
+						"Got event packet back from module '%s' (ID %d) with source ID set to %d.") % m.name % m.id
+						% sourceId;
+					throw std::runtime_error(exMsg.str());
+				}
 
-					try {
-						destIdx = m.get().outputs.at(typeId);
-					}
-					catch (const std::out_of_range &) {
-						// If we don't find a match for the type ID, it means
-						// that's an unexpected event packet. If this is a module
-						// with well defined outputs, this is clearly an error;
-						// forgetting to declare an output, so we re-throw the
-						// exception upwards. Else for modules with any (-1)
-						// outputs, they can internally produce whatever and we
-						// only pick what was declared in the 'moduleOutput' config.
-						if (m.get().libraryInfo->outputStreams[0].type != -1) {
-							// Type ANY (-1) is always the first one if it exists,
-							// and outputs must exist since module.outputs is
-							// populated with types we want to pick.
-							throw;
-						}
+				int16_t typeId = caerEventPacketHeaderGetEventType(packet);
+
+				if (profiling) {
+					m.profile.eventsOut += static_cast<uint64_t>(caerEventPacketHeaderGetEventNumber(packet));
+					m.profile.bytesAllocated += static_cast<uint64_t>(caerEventPacketGetSize(packet));
+				}
+
+				ssize_t destIdx = -1;
+
+				try {
+					destIdx = m.outputs.at(typeId);
+				}
+				catch (const std::out_of_range &) {
+					// If we don't find a match for the type ID, it means
+					// that's an unexpected event packet. If this is a module
+					// with well defined outputs, this is clearly an error;
+					// forgetting to declare an output, so we re-throw the
+					// exception upwards. Else for modules with any (-1)
+					// outputs, they can internally produce whatever and we
+					// only pick what was declared in the 'moduleOutput' config.
+					if (m.libraryInfo->outputStreams[0].type != -1) {
+						// Type ANY (-1) is always the first one if it exists,
+						// and outputs must exist since module.outputs is
+						// populated with types we want to pick.
+						throw;
 					}
+				}
 
-					if (destIdx == -1) {
-						// Deallocate packet memory if not used.
-						free(packet);
+				if (destIdx == -1) {
+					// Deallocate packet memory if not used.
+					if (glMainloopData.packetPool.owns(packet)) {
+						glMainloopData.packetPool.recycle(packet);
 					}
 					else {
-						glMainloopData.eventPackets[static_cast<size_t>(destIdx)] = packet;
+						free(packet);
 					}
 				}
 				else {
-					caerModuleLog(m.get().runtimeData, CAER_LOG_DEBUG,
-						"Module Output: got null packet at idx=%" PRIi32 ".", i);
+					// Everything in the global storage is pool memory, so that it can be
+					// shared and recycled. Packets from libcaer are moved into it here.
+					packet = glMainloopData.packetPool.adopt(packet);
+					if (packet == nullptr) {
+						caerModuleLog(m.runtimeData, CAER_LOG_ERROR,
+							"Module Output: failed to allocate memory for packet of type %" PRIi16 ", dropped.",
+							typeId);
+					}
+
+					glMainloopData.eventPackets[static_cast<size_t>(destIdx)] = packet;
 				}
 			}
+			else {
+				caerModuleLog(m.runtimeData, CAER_LOG_DEBUG, "Module Output: got null packet at idx=%" PRIi32 ".", i);
+			}
+		}
 
-			// Deallocate container memory. Packets have been handled above.
-			free(out);
+		// Deallocate container memory. Packets have been handled above.
+		free(out);
+
+		if (glMainloopData.tapsNumber.load(std::memory_order_relaxed) > 0) {
+			tapModuleOutputs(m);
 		}
 	}
 
+	m.runTime = std::chrono::steady_clock::now() - runStart;
+
+	m.profile.runTimeSum += m.runTime;
+	m.profile.runs++;
+
+	if (profiling) {
+		m.profile.runTimes.push_back(m.runTime);
+	}
+
+	caerTraceEvent(CAER_TRACE_MODULE_RUN, CAER_TRACE_END, m.id, 0);
+}
+
+static void runModules(caerEventPacketContainer in) {
+	if (glMainloopData.executionPool != nullptr) {
+		// Run through all levels in order, modules inside a level in parallel.
+		for (const auto &level : glMainloopData.parallelExecution) {
+			if (level.size() == 1) {
+				// Nothing to parallelize, avoid the hand-off overhead.
+				runModule(level[0].get(), in);
+			}
+			else {
+				glMainloopData.executionPool->runLevel(level, in);
+			}
+		}
+	}
+	else {
+		// Run through all modules in order.
+		for (const auto &m : glMainloopData.globalExecution) {
+			runModule(m.get(), in);
+		}
+	}
+
+	// Update timing statistics. The critical path is given by the slowest module
+	// of each level, as that's what limits parallel execution. It is calculated in
+	// serial mode too, to estimate the gains from enabling parallel execution.
+	for (const auto &level : glMainloopData.parallelExecution) {
+		std::chrono::nanoseconds levelTime(0);
+
+		for (const auto &m : level) {
+			if (m.get().runTime > levelTime) {
+				levelTime = m.get().runTime;
+			}
+		}
+
+		glMainloopData.criticalPathTimeSum += levelTime;
+	}
+
+	glMainloopData.executionRuns++;
+
 	// To finish a run, clean up all the leftover packet memory.
+	// Packets retained by modules are only freed once they release them.
 	for (auto &p : glMainloopData.eventPackets) {
 		if (p != nullptr) {
-			free(p);
+			caerMainloopPacketRelease(p);
 			p = nullptr;
 		}
 	}
 }
 
+static void updateModuleProfile(ModuleProfile &profile) {
+	if (profile.runs == 0) {
+		return;
+	}
+
+	auto runTimeAverage = profile.runTimeSum / static_cast<std::chrono::nanoseconds::rep>(profile.runs);
+
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "runs", static_cast<int64_t>(profile.runs));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "runTimeAverage", static_cast<int64_t>(runTimeAverage.count()));
+
+	// Nothing more collected, profiling disabled.
+	if (profile.runTimes.empty()) {
+		profile.clear();
+		return;
+	}
+
+	auto &runTimes = profile.runTimes;
+
+	auto runTimeMin = *std::min_element(runTimes.begin(), runTimes.end());
+
+	// 99th percentile (nearest-rank).
+	auto p99 = runTimes.begin() + static_cast<ssize_t>(((runTimes.size() * 99) + 99) / 100 - 1);
+	std::nth_element(runTimes.begin(), p99, runTimes.end());
+	auto runTimeP99 = *p99;
+
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "runTimeMin", static_cast<int64_t>(runTimeMin.count()));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "runTimeP99", static_cast<int64_t>(runTimeP99.count()));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "eventsIn", static_cast<int64_t>(profile.eventsIn));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "eventsOut", static_cast<int64_t>(profile.eventsOut));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "packetsCopied", static_cast<int64_t>(profile.packetsCopied));
+	sshsNodeUpdateReadOnlyAttribute(profile.node, "bytesAllocated", static_cast<int64_t>(profile.bytesAllocated));
+
+	profile.clear();
+}
+
+static void createModuleProfileAttributes(ModuleInfo &m) {
+	m.profile.node = sshsGetRelativeNode(m.configNode, "profiling/");
+
+	sshsNodeCreateLong(m.profile.node, "runs", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of runs in the last statistics interval (1 second).");
+	sshsNodeCreateLong(m.profile.node, "runTimeMin", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Minimum run time in the last statistics interval, in ns (with moduleProfiling only).");
+	sshsNodeCreateLong(m.profile.node, "runTimeAverage", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average run time in the last statistics interval, in ns.");
+	sshsNodeCreateLong(m.profile.node, "runTimeP99", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"99th percentile of the run time in the last statistics interval, in ns (with moduleProfiling only).");
+	sshsNodeCreateLong(m.profile.node, "eventsIn", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of input events in the last statistics interval.");
+	sshsNodeCreateLong(m.profile.node, "eventsOut", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of output events in the last statistics interval.");
+	sshsNodeCreateLong(m.profile.node, "packetsCopied", 0, 0, INT64_MAX, SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Number of input packets copied for this module in the last statistics interval.");
+	sshsNodeCreateLong(m.profile.node, "bytesAllocated", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Memory of copied input and new output packets in the last statistics interval, in bytes.");
+}
+
+static void updateExecutionStatistics() {
+	if (glMainloopData.executionRuns == 0) {
+		return;
+	}
+
+	auto runs = static_cast<std::chrono::nanoseconds::rep>(glMainloopData.executionRuns);
+
+	// Per-module run times are only kept in their profiling data.
+	std::chrono::nanoseconds executionTimeSum(0);
+
+	for (const auto &m : glMainloopData.globalExecution) {
+		executionTimeSum += m.get().profile.runTimeSum;
+
+		updateModuleProfile(m.get().profile);
+	}
+
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.mainloopNode, "executionTime",
+		static_cast<int64_t>((executionTimeSum / runs).count()));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.mainloopNode, "criticalPathTime",
+		static_cast<int64_t>((glMainloopData.criticalPathTimeSum / runs).count()));
+
+	glMainloopData.criticalPathTimeSum = std::chrono::nanoseconds(0);
+	glMainloopData.executionRuns = 0;
+}
+
+static void updateWakeupLatencyStatistics() {
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.wakeupLatencyNode, "samples",
+		static_cast<int64_t>(glMainloopData.wakeupLatencySamples));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.wakeupLatencyNode, "maximum",
+		glMainloopData.wakeupLatencyMaximum);
+
+	for (size_t i = 0; i < WAKEUP_LATENCY_BOUNDS.size(); i++) {
+		const std::string key = "upTo" + std::to_string(WAKEUP_LATENCY_BOUNDS[i]) + "us";
+		sshsNodeUpdateReadOnlyAttribute(glMainloopData.wakeupLatencyNode, key.c_str(),
+			static_cast<int64_t>(glMainloopData.wakeupLatencyHistogram[i]));
+	}
+
+	const std::string overKey = "over" + std::to_string(WAKEUP_LATENCY_BOUNDS.back()) + "us";
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.wakeupLatencyNode, overKey.c_str(),
+		static_cast<int64_t>(glMainloopData.wakeupLatencyHistogram.back()));
+}
+
+static void updatePacketPoolStatistics() {
+	auto stats = glMainloopData.packetPool.getStatistics();
+
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "hits", static_cast<int64_t>(stats.hits));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "misses", static_cast<int64_t>(stats.misses));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "recycled", static_cast<int64_t>(stats.recycled));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "discarded",
+		static_cast<int64_t>(stats.discarded));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "adopted", static_cast<int64_t>(stats.adopted));
+	sshsNodeUpdateReadOnlyAttribute(glMainloopData.packetPoolNode, "cachedSize",
+		static_cast<int64_t>(stats.cachedSize));
+}
+
+static inline int64_t getSteadyClockNanoseconds() {
+	return (std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void recordWakeupLatency() {
+	// Get time at which data first became available, and reset it for the next run.
+	int64_t notifyTime = glMainloopData.dataNotifyTime.exchange(0);
+	if (notifyTime == 0) {
+		return;
+	}
+
+	int64_t latency = (getSteadyClockNanoseconds() - notifyTime) / 1000;
+
+	size_t bucket = 0;
+	while (bucket < WAKEUP_LATENCY_BOUNDS.size() && latency > WAKEUP_LATENCY_BOUNDS[bucket]) {
+		bucket++;
+	}
+
+	glMainloopData.wakeupLatencyHistogram[bucket]++;
+	glMainloopData.wakeupLatencySamples++;
+
+	if (latency > glMainloopData.wakeupLatencyMaximum) {
+		glMainloopData.wakeupLatencyMaximum = latency;
+	}
+}
+
+static void waitForData(std::chrono::steady_clock::duration timeout) {
+	// Busy-wait first, if configured, to keep the wakeup latency minimal.
+	int32_t spinTime = glMainloopData.wakeupSpinTime.load(std::memory_order_relaxed);
+
+	if (spinTime > 0) {
+		auto spinEnd = std::chrono::steady_clock::now() + std::chrono::microseconds(spinTime);
+
+		while (std::chrono::steady_clock::now() < spinEnd) {
+			if (glMainloopData.dataAvailable.load(std::memory_order_acquire) > 0
+				|| !glMainloopData.running.load(std::memory_order_relaxed)) {
+				return;
+			}
+
+			std::this_thread::yield();
+		}
+	}
+
+	// Then block until notified of new data, or the timeout expires. The waiting
+	// flag is set before checking for data, so that caerMainloopDataNotifyIncrease()
+	// either sees it and wakes us up, or its data is seen by the check.
+	std::unique_lock<std::mutex> lock(glMainloopData.dataLock);
+
+	glMainloopData.dataWaiting.store(true);
+
+	glMainloopData.dataCond.wait_for(lock, timeout, []() {
+		return (glMainloopData.dataAvailable.load() > 0 || !glMainloopData.running.load());
+	});
+
+	glMainloopData.dataWaiting.store(false);
+}
+
+static void wakeupMainloop() {
+	if (glMainloopData.dataWaiting.load()) {
+		// Take the lock to ensure the mainloop is either not yet checking for
+		// data, or already blocked waiting, so the notification can't get lost.
+		{
+			std::lock_guard<std::mutex> lock(glMainloopData.dataLock);
+		}
+
+		glMainloopData.dataCond.notify_one();
+	}
+}
+
 static void cleanupGlobals() {
 	for (auto &m : glMainloopData.modules) {
 		if (m.second.libraryInfo != nullptr) {
@@ -1570,12 +2600,16 @@ static void cleanupGlobals() {
 	glMainloopData.modules.clear();
 	glMainloopData.streams.clear();
 	glMainloopData.globalExecution.clear();
+	glMainloopData.parallelExecution.clear();
 
 	glMainloopData.copyCount = 0;
 
 	std::for_each(glMainloopData.eventPackets.begin(), glMainloopData.eventPackets.end(),
-		[](caerEventPacketHeader p) {free(p);});
+		[](caerEventPacketHeader p) {caerMainloopPacketRelease(p);});
 	glMainloopData.eventPackets.clear();
+
+	// All modules are gone, give the recycled packet memory back.
+	glMainloopData.packetPool.clear();
 }
 
 static int caerMainloopRunner() {
@@ -1883,6 +2917,10 @@ static int caerMainloopRunner() {
 		// all the input and output connections.
 		buildConnectivity();
 
+		// Group modules into levels of independent modules, that can be
+		// executed concurrently if parallel execution is enabled.
+		buildParallelExecution();
+
 		// Last check: detect processors that serve no purpose, ie. no output or
 		// unused output, as well as no further users of modified inputs.
 		for (const auto &m : processorModules) {
@@ -1963,6 +3001,8 @@ static int caerMainloopRunner() {
 		}
 
 		m.get().runtimeData = runData;
+
+		createModuleProfileAttributes(m.get());
 	}
 
 	// Allocate only one packet container to be re-used over all runModules() calls.
@@ -1979,29 +3019,102 @@ static int caerMainloopRunner() {
 		return (EXIT_FAILURE);
 	}
 
+	// Start worker pool for parallel execution, if enabled and useful. The mainloop
+	// thread itself also executes modules, so at most widest level - 1 are needed.
+	if (sshsNodeGetBool(glMainloopData.mainloopNode, "parallelExecution")) {
+		size_t maxLevelSize = 0;
+
+		for (const auto &level : glMainloopData.parallelExecution) {
+			if (level.size() > maxLevelSize) {
+				maxLevelSize = level.size();
+			}
+		}
+
+		size_t workersNumber = std::min(maxLevelSize - 1,
+			static_cast<size_t>(sshsNodeGetInt(glMainloopData.mainloopNode, "parallelWorkers")));
+
+		if (workersNumber == 0) {
+			log(logLevel::NOTICE, "Mainloop",
+				"Parallel execution enabled, but no modules can run concurrently. Using serial execution.");
+		}
+		else {
+			try {
+				glMainloopData.executionPool = std::make_unique<ModuleExecutionPool>(workersNumber,
+					getMaximumInputNumber());
+
+				log(logLevel::INFO, "Mainloop", "Parallel execution enabled: %zu levels, %zu worker threads.",
+					glMainloopData.parallelExecution.size(), workersNumber);
+			}
+			catch (const std::exception &ex) {
+				log(logLevel::ERROR, "Mainloop",
+					"Failed to start parallel execution worker threads (error: '%s'). Using serial execution.",
+					ex.what());
+			}
+		}
+	}
+
+	// Reset execution statistics.
+	glMainloopData.criticalPathTimeSum = std::chrono::nanoseconds(0);
+	glMainloopData.executionRuns = 0;
+
+	glMainloopData.wakeupLatencyHistogram.fill(0);
+	glMainloopData.wakeupLatencySamples = 0;
+	glMainloopData.wakeupLatencyMaximum = 0;
+
 	log(logLevel::INFO, "Mainloop", "Started successfully.");
 
 	// Run modules once right away to give possibility of initializing and
 	// getting some initial data (dataAvailable > 0).
 	runModules(inputContainer);
 
-	// If no data is available, sleep for a millisecond to avoid wasting resources.
+	// If no data is available, wait for it to avoid wasting resources: input
+	// modules wake the mainloop up via caerMainloopDataNotifyIncrease().
 	// Wait for someone to toggle the module shutdown flag OR for the loop
 	// itself to signal termination.
-	size_t sleepCount = 0;
+	auto lastStatisticsUpdate = std::chrono::steady_clock::now();
 
 	while (glMainloopData.running.load(std::memory_order_relaxed)) {
-		// Run only if data available to consume, else sleep. But make a run
+		// Run only if data available to consume, else wait. But make a run
 		// anyway each second, to detect new devices for example.
-		if (glMainloopData.dataAvailable.load(std::memory_order_acquire) > 0 || sleepCount > 1000) {
-			sleepCount = 0;
+		if (glMainloopData.dataAvailable.load(std::memory_order_acquire) == 0) {
+			waitForData(std::chrono::seconds(1));
 
-			runModules(inputContainer);
-			// TODO: handle exceptions here.
+			if (!glMainloopData.running.load(std::memory_order_relaxed)) {
+				break;
+			}
 		}
-		else {
-			sleepCount++;
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		recordWakeupLatency();
+
+		runModules(inputContainer);
+		// TODO: handle exceptions here.
+
+		// Unattended processing: once all inputs are done, shut down everything.
+		// Stopping the modules below lets outputs write out all remaining data.
+		bool inputsFailed = false;
+
+		if (glMainloopData.stopOnInputEnd && inputsEnded(inputsFailed)) {
+			if (inputsFailed) {
+				log(logLevel::ERROR, "Mainloop", "Input modules failed to start, shutting down.");
+				glMainloopData.result = EXIT_FAILURE;
+			}
+			else {
+				log(logLevel::INFO, "Mainloop", "All input modules stopped, shutting down.");
+			}
+
+			glMainloopData.systemRunning.store(false);
+			glMainloopData.running.store(false);
+			break;
+		}
+
+		// Publish execution statistics once per second.
+		auto now = std::chrono::steady_clock::now();
+
+		if ((now - lastStatisticsUpdate) >= std::chrono::seconds(1)) {
+			updateExecutionStatistics();
+			updateWakeupLatencyStatistics();
+			updatePacketPoolStatistics();
+			lastStatisticsUpdate = now;
 		}
 	}
 
@@ -2013,9 +3126,16 @@ static int caerMainloopRunner() {
 	// Run through the loop one last time to correctly shutdown all the modules.
 	runModules(inputContainer);
 
+	// Stop parallel execution worker threads.
+	glMainloopData.executionPool.reset();
+
 	// Destroy the runtime memory for all modules.
 	for (const auto &m : glMainloopData.globalExecution) {
 		caerModuleDestroy(m.get().runtimeData);
+
+		sshsNodeRemoveNode(m.get().profile.node);
+		m.get().profile.node = nullptr;
+		m.get().profile.clear();
 	}
 
 	free(inputContainer);
@@ -2028,6 +3148,35 @@ static int caerMainloopRunner() {
 	return (EXIT_SUCCESS);
 }
 
+/**
+ * Check if all input modules are stopped and will not start again by themselves.
+ * Module state only changes while running the modules, so an input module that
+ * is still stopped but wants to run after a full run failed its initialization.
+ *
+ * @param inputsFailed set to true if any input module failed to start.
+ *
+ * @return true if no input module is running anymore.
+ */
+static bool inputsEnded(bool &inputsFailed) {
+	for (const auto &m : glMainloopData.globalExecution) {
+		if (m.get().libraryInfo->type != CAER_MODULE_INPUT) {
+			continue;
+		}
+
+		caerModuleData moduleData = m.get().runtimeData;
+
+		if (moduleData->moduleStatus == CAER_MODULE_RUNNING) {
+			return (false);
+		}
+
+		if (moduleData->running.load(std::memory_order_relaxed)) {
+			inputsFailed = true;
+		}
+	}
+
+	return (true);
+}
+
 static void printDebugInformation() {
 	// Debug output.
 	for (const auto &st : glMainloopData.streams) {
@@ -2048,6 +3197,14 @@ static void printDebugInformation() {
 
 	log(logLevel::DEBUG, "Mainloop", "Global copy count: %d", glMainloopData.copyCount);
 
+	for (size_t i = 0; i < glMainloopData.parallelExecution.size(); i++) {
+		std::ostringstream levelPrint;
+		for (const auto &m : glMainloopData.parallelExecution[i]) {
+			levelPrint << m.get().id << ", ";
+		}
+		log(logLevel::DEBUG, "Mainloop", "Execution level %zu: %s", i, levelPrint.str().c_str());
+	}
+
 	for (const auto &m : glMainloopData.globalExecution) {
 		log(logLevel::DEBUG, "Mainloop", "Module %d: type %d - %s", m.get().id, m.get().libraryInfo->type,
 			m.get().name.c_str());
@@ -2065,7 +3222,17 @@ static void printDebugInformation() {
 void caerMainloopDataNotifyIncrease(void *p) {
 	UNUSED_ARGUMENT(p);
 
-	glMainloopData.dataAvailable.fetch_add(1, std::memory_order_release);
+	// Remember when data first became available, to measure wakeup latency.
+	if (glMainloopData.dataNotifyTime.load(std::memory_order_relaxed) == 0) {
+		int64_t noTime = 0;
+		glMainloopData.dataNotifyTime.compare_exchange_strong(noTime, getSteadyClockNanoseconds());
+	}
+
+	// Sequentially consistent, to order it with the check of the waiting flag,
+	// see waitForData() for the other side.
+	glMainloopData.dataAvailable.fetch_add(1);
+
+	wakeupMainloop();
 }
 
 void caerMainloopDataNotifyDecrease(void *p) {
@@ -2076,6 +3243,164 @@ void caerMainloopDataNotifyDecrease(void *p) {
 	glMainloopData.dataAvailable.fetch_sub(1, std::memory_order_relaxed);
 }
 
+caerEventPacketHeader caerMainloopPacketRetain(caerEventPacketHeader packet) {
+	if (packet == nullptr) {
+		return (nullptr);
+	}
+
+	getPacketBlock(packet)->references.fetch_add(1, std::memory_order_relaxed);
+
+	return (packet);
+}
+
+void caerMainloopPacketRelease(caerEventPacketHeader packet) {
+	if (packet == nullptr) {
+		return;
+	}
+
+	// Other references may still exist, then just drop this one. The last one sees
+	// all uses of the packet through the others, before recycling its memory.
+	if (getPacketBlock(packet)->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		glMainloopData.packetPool.recycle(packet);
+	}
+}
+
+caerEventPacketHeader caerMainloopPacketAllocate(size_t packetSize) {
+	return (glMainloopData.packetPool.allocate(packetSize));
+}
+
+caerEventPacketHeader caerMainloopPacketResize(caerEventPacketHeader packet, size_t packetSize) {
+	if (packet == nullptr) {
+		return (caerMainloopPacketAllocate(packetSize));
+	}
+
+	return (glMainloopData.packetPool.resize(packet, packetSize));
+}
+
+static caerEventPacketHeader copyEventPacket(caerEventPacketHeaderConst packet, bool validOnly) {
+	if (packet == nullptr) {
+		return (nullptr);
+	}
+
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+	int32_t eventValid = caerEventPacketHeaderGetEventValid(packet);
+	int32_t copyNumber = (validOnly) ? (eventValid) : (eventNumber);
+
+	// Nothing to copy, same as the libcaer copy functions.
+	if (copyNumber == 0) {
+		return (nullptr);
+	}
+
+	caerEventPacketHeader copy = caerMainloopPacketAllocate(
+		CAER_EVENT_PACKET_HEADER_SIZE + (static_cast<size_t>(copyNumber) * static_cast<size_t>(eventSize)));
+	if (copy == nullptr) {
+		return (nullptr);
+	}
+
+	memcpy(copy, packet, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	uint8_t *copyEvents = reinterpret_cast<uint8_t *>(copy) + CAER_EVENT_PACKET_HEADER_SIZE;
+
+	if (copyNumber == eventNumber) {
+		// All events are needed, copy them in one go.
+		memcpy(copyEvents, caerGenericEventGetEvent(packet, 0),
+			static_cast<size_t>(copyNumber) * static_cast<size_t>(eventSize));
+	}
+	else {
+		for (int32_t i = 0; i < eventNumber; i++) {
+			const void *event = caerGenericEventGetEvent(packet, i);
+
+			if (caerGenericEventIsValid(event)) {
+				memcpy(copyEvents, event, static_cast<size_t>(eventSize));
+				copyEvents += eventSize;
+			}
+		}
+	}
+
+	// Copies are always exactly as big as needed.
+	caerEventPacketHeaderSetEventCapacity(copy, copyNumber);
+	caerEventPacketHeaderSetEventNumber(copy, copyNumber);
+	caerEventPacketHeaderSetEventValid(copy, (validOnly) ? (copyNumber) : (eventValid));
+
+	return (copy);
+}
+
+caerEventPacketHeader caerMainloopPacketCopyOnlyEvents(caerEventPacketHeaderConst packet) {
+	return (copyEventPacket(packet, false));
+}
+
+caerEventPacketHeader caerMainloopPacketCopyOnlyValidEvents(caerEventPacketHeaderConst packet) {
+	return (copyEventPacket(packet, true));
+}
+
+caerEventPacketContainer caerMainloopPacketContainerRetain(caerEventPacketContainerConst container) {
+	if (container == nullptr) {
+		return (nullptr);
+	}
+
+	int32_t packetsNumber = 0;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		if (caerEventPacketContainerGetEventPacketConst(container, i) != nullptr) {
+			packetsNumber++;
+		}
+	}
+
+	if (packetsNumber == 0) {
+		return (nullptr);
+	}
+
+	caerEventPacketContainer sharedContainer = caerEventPacketContainerAllocate(packetsNumber);
+	if (sharedContainer == nullptr) {
+		return (nullptr);
+	}
+
+	int32_t idx = 0;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(container, i);
+
+		if (packet != nullptr) {
+			caerEventPacketContainerSetEventPacket(sharedContainer, idx++, caerMainloopPacketRetain(packet));
+		}
+	}
+
+	return (sharedContainer);
+}
+
+int32_t caerMainloopTapAdd(int16_t sourceId, int16_t typeId, caerMainloopTapCallback callback, void *userData) {
+	std::lock_guard<std::mutex> lock(glMainloopData.tapsLock);
+
+	int32_t tapId = glMainloopData.tapsNextId++;
+
+	glMainloopData.taps.push_back(StreamTap { tapId, sourceId, typeId, callback, userData });
+	glMainloopData.tapsNumber.store(glMainloopData.taps.size(), std::memory_order_relaxed);
+
+	return (tapId);
+}
+
+void caerMainloopTapRemove(int32_t tapId) {
+	// Callbacks run with the lock held, so none is running once we have it.
+	std::lock_guard<std::mutex> lock(glMainloopData.tapsLock);
+
+	glMainloopData.taps.erase(std::remove_if(glMainloopData.taps.begin(), glMainloopData.taps.end(),
+		[tapId](const StreamTap &tap) {return (tap.id == tapId);}), glMainloopData.taps.end());
+	glMainloopData.tapsNumber.store(glMainloopData.taps.size(), std::memory_order_relaxed);
+}
+
+void caerMainloopPacketContainerRelease(caerEventPacketContainer container) {
+	if (container == nullptr) {
+		return;
+	}
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerMainloopPacketRelease(caerEventPacketContainerGetEventPacket(container, i));
+	}
+
+	free(container);
+}
+
 bool caerMainloopModuleExists(int16_t id) {
 	return (glMainloopData.modules.count(id) == 1);
 }
@@ -2219,6 +3544,8 @@ static void caerMainloopSystemRunningListener(sshsNode node, void *userData, enu
 	if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL && caerStrEquals(changeKey, "running")) {
 		glMainloopData.systemRunning.store(false);
 		glMainloopData.running.store(false);
+
+		wakeupMainloop();
 	}
 }
 
@@ -2229,6 +3556,25 @@ static void caerMainloopRunningListener(sshsNode node, void *userData, enum sshs
 
 	if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL && caerStrEquals(changeKey, "running")) {
 		glMainloopData.running.store(changeValue.boolean);
+
+		wakeupMainloop();
+	}
+}
+
+static void caerMainloopConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(userData);
+
+	if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_INT && caerStrEquals(changeKey, "wakeupSpinTime")) {
+		glMainloopData.wakeupSpinTime.store(changeValue.iint);
+	}
+	else if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL
+		&& caerStrEquals(changeKey, "moduleProfiling")) {
+		glMainloopData.moduleProfiling.store(changeValue.boolean);
+	}
+	else if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_INT && caerStrEquals(changeKey, "maxBuffers")) {
+		glMainloopData.packetPool.setMaxBuffers(static_cast<size_t>(changeValue.iint));
 	}
 }
 
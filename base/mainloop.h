@@ -15,7 +15,13 @@
 extern "C" {
 #endif
 
-void caerMainloopRun(void);
+/**
+ * Run the mainloop until global shutdown.
+ *
+ * @return EXIT_SUCCESS, or EXIT_FAILURE if the mainloop was configured to stop
+ *         once its inputs end and they could not be started.
+ */
+int caerMainloopRun(void);
 
 void caerMainloopDataNotifyIncrease(void *p) CAER_SYMBOL_EXPORT;
 void caerMainloopDataNotifyDecrease(void *p) CAER_SYMBOL_EXPORT;
@@ -30,6 +36,58 @@ sshsNode caerMainloopGetSourceInfo(int16_t sourceID) CAER_SYMBOL_EXPORT;
 void *caerMainloopGetSourceState(int16_t sourceID) CAER_SYMBOL_EXPORT;
 sshsNode caerMainloopGetModuleNode(int16_t sourceID) CAER_SYMBOL_EXPORT;
 
+/**
+ * Reference-counted sharing of event packets from the mainloop's global storage.
+ * Modules can retain a packet they got as input to keep using it after their run
+ * (for example from a background thread), instead of copying it. The mainloop
+ * guarantees retained packets are never modified: modules that change their
+ * input data in-place get a private copy (copy-on-write) while others hold it.
+ * Every retain must be balanced by a release, the last one recycles the memory.
+ * Packets that were never retained are simply freed by the release call.
+ */
+caerEventPacketHeader caerMainloopPacketRetain(caerEventPacketHeader packet) CAER_SYMBOL_EXPORT;
+void caerMainloopPacketRelease(caerEventPacketHeader packet) CAER_SYMBOL_EXPORT;
+caerEventPacketContainer caerMainloopPacketContainerRetain(caerEventPacketContainerConst container) CAER_SYMBOL_EXPORT;
+void caerMainloopPacketContainerRelease(caerEventPacketContainer container) CAER_SYMBOL_EXPORT;
+
+/**
+ * Pooled event packet memory. Packets freed through caerMainloopPacketRelease() are
+ * kept for reuse per size class, instead of being returned to the system, and
+ * are handed out again by these functions. The allocation does not initialize the
+ * memory (header included), it's the same as malloc(packetSize), and resizing is
+ * the same as realloc(). The copies are equivalent to the libcaer functions
+ * caerEventPacketCopyOnlyEvents()/OnlyValidEvents().
+ * Returned memory must only be released with caerMainloopPacketRelease() and resized
+ * with caerMainloopPacketResize(), never with free()/realloc() or libcaer functions
+ * that reallocate packets (like caerEventPacketAppend()). Only packets that were not
+ * retained by anybody else may be resized.
+ * Packets in module output containers may come from anywhere, the mainloop moves
+ * the ones allocated elsewhere (by libcaer) into pool memory.
+ */
+caerEventPacketHeader caerMainloopPacketAllocate(size_t packetSize) CAER_SYMBOL_EXPORT;
+caerEventPacketHeader caerMainloopPacketResize(caerEventPacketHeader packet, size_t packetSize) CAER_SYMBOL_EXPORT;
+caerEventPacketHeader caerMainloopPacketCopyOnlyEvents(caerEventPacketHeaderConst packet) CAER_SYMBOL_EXPORT;
+caerEventPacketHeader caerMainloopPacketCopyOnlyValidEvents(caerEventPacketHeaderConst packet) CAER_SYMBOL_EXPORT;
+
+/**
+ * Stream taps, to look at the data of any stream from outside the mainloop, without
+ * having to add an output module. Every packet of the (sourceId, typeId) stream is
+ * passed to the callback, right after the source module produced it, with a reference
+ * retained for the callback, which must release it with caerMainloopPacketRelease().
+ * The callback runs on the mainloop (or one of its worker threads) and must return
+ * quickly, for example by just queuing the packet for another thread.
+ * Taps stay across mainloop restarts; the stream doesn't have to exist.
+ * After caerMainloopTapRemove() returns, the callback is not running anymore and
+ * will never be called again. Without taps, the mainloop has no added cost.
+ *
+ * @return tap ID to pass to caerMainloopTapRemove().
+ */
+typedef void (*caerMainloopTapCallback)(void *userData, caerEventPacketHeader packet);
+
+int32_t caerMainloopTapAdd(int16_t sourceId, int16_t typeId, caerMainloopTapCallback callback, void *userData)
+	CAER_SYMBOL_EXPORT;
+void caerMainloopTapRemove(int32_t tapId) CAER_SYMBOL_EXPORT;
+
 void caerMainloopResetInputs(int16_t sourceID) CAER_SYMBOL_EXPORT;
 void caerMainloopResetOutputs(int16_t sourceID) CAER_SYMBOL_EXPORT;
 void caerMainloopResetProcessors(int16_t sourceID) CAER_SYMBOL_EXPORT;
@@ -75,7 +75,7 @@ void caerDaemonize(void) {
 	}
 
 	// Disable stderr logging for caerLog(), keep only the direct logging to file there.
-	caerLogFileDescriptorsSet(-1, CAER_LOG_FILE_FD);
+	caerLogOutputFileDescriptorsSet(-1, CAER_LOG_FILE_FD);
 
 	// At this point everything should be ok and we can return!
 }
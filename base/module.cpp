@@ -6,6 +6,7 @@
  */
 
 #include "module.h"
+#include "log.h"
 
 #include <regex>
 #include <thread>
@@ -224,9 +225,8 @@ void caerModuleConfigDefaultListener(sshsNode node, void *userData, enum sshs_no
 void caerModuleLog(caerModuleData moduleData, enum caer_log_level logLevel, const char *format, ...) {
 	va_list argumentList;
 	va_start(argumentList, format);
-	caerLogVAFull(caerLogFileDescriptorsGetFirst(), caerLogFileDescriptorsGetSecond(),
-		moduleData->moduleLogLevel.load(std::memory_order_relaxed), logLevel, moduleData->moduleSubSystemString, format,
-		argumentList);
+	caerLogVAAsync(moduleData->moduleLogLevel.load(std::memory_order_relaxed), logLevel,
+		moduleData->moduleSubSystemString, format, argumentList);
 	va_end(argumentList);
 }
 
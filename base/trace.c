@@ -0,0 +1,454 @@
+#include "trace.h"
+#include "ext/portable_misc.h"
+#include "ext/portable_time.h"
+#include "ext/pathmax.h"
+#include <stdatomic.h>
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+#include "ext/c11threads_posix.h"
+#endif
+
+/*
+ * Each thread records into its own ring-buffer, the first time it records
+ * anything after tracing is enabled, so there's nothing to synchronize with on
+ * the recording side. A dump copies each buffer while it may be written to,
+ * and then discards the part that the thread could have overwritten meanwhile.
+ */
+
+struct trace_event {
+	uint64_t time; // ns, monotonic clock.
+	uint8_t type;
+	uint8_t phase;
+	int16_t id;
+	int32_t arg;
+};
+
+struct trace_module_name {
+	int16_t id;
+	char *name; // Escaped for JSON strings.
+};
+
+struct trace_buffer {
+	atomic_uint_fast64_t head; // Number of events ever recorded.
+	atomic_bool orphaned; // Thread exited, free after next dump.
+	uint32_t threadId;
+	char threadName[32];
+	struct trace_buffer *next;
+	struct trace_event events[CAER_TRACE_BUFFER_SIZE];
+};
+
+static struct {
+	atomic_bool enabled;
+	atomic_uint_fast64_t enabledSince;
+#if defined(OS_UNIX) && OS_UNIX == 1
+	pthread_key_t bufferKey;
+	mtx_t buffersLock;
+#endif
+	struct trace_buffer *buffers;
+	uint32_t nextThreadId;
+	sshsNode traceNode;
+} glTraceData;
+
+static inline uint64_t caerTraceTime(void);
+static struct trace_buffer *caerTraceBufferGet(void);
+#if defined(OS_UNIX) && OS_UNIX == 1
+static void caerTraceBufferOrphan(void *buffer);
+#endif
+static void caerTraceDumpBuffer(FILE *dumpFile, struct trace_buffer *buffer, struct trace_event *events,
+	uint64_t since, const struct trace_module_name *moduleNames, size_t moduleNamesSize, bool *first);
+static struct trace_module_name *caerTraceModuleNamesGet(size_t *moduleNamesSize);
+static void caerTraceModuleNamesFree(struct trace_module_name *moduleNames, size_t moduleNamesSize);
+static size_t caerTraceJSONEscape(char *dest, size_t destSize, const char *src);
+static int caerTraceModuleNameCmp(const void *a, const void *b);
+static const char *caerTraceModuleName(int16_t id, const struct trace_module_name *moduleNames,
+	size_t moduleNamesSize);
+static void caerTraceConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+void caerTraceInit(void) {
+	glTraceData.traceNode = sshsGetNode(sshsGetGlobal(), "/caer/trace/");
+
+	// Default dump path is a file named caer-trace.json inside the program's CWD.
+	const char *dumpFileName = "/caer-trace.json";
+
+	char *dumpFileDir = getcwd(NULL, 0);
+	char *dumpFileDirClean = portable_realpath(dumpFileDir);
+
+	char *dumpFilePath = malloc(strlen(dumpFileDirClean) + strlen(dumpFileName) + 1); // +1 for terminating NUL byte.
+	strcpy(dumpFilePath, dumpFileDirClean);
+	strcat(dumpFilePath, dumpFileName);
+
+	sshsNodeCreateString(glTraceData.traceNode, "dumpFile", dumpFilePath, 2, PATH_MAX, SSHS_FLAGS_NORMAL,
+		"Path to the file where traces are dumped to, in Chrome trace JSON format.");
+
+	free(dumpFilePath);
+	free(dumpFileDirClean);
+	free(dumpFileDir);
+
+	sshsNodeCreateBool(glTraceData.traceNode, "enabled", false, SSHS_FLAGS_NORMAL | SSHS_FLAGS_NO_EXPORT,
+		"Record timing events (module runs, ring-buffer transfers, packet container commits) from all threads.");
+	sshsNodeCreateBool(glTraceData.traceNode, "dump", false, SSHS_FLAGS_NOTIFY_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Write all events recorded since tracing was enabled to the dump file.");
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+	if (pthread_key_create(&glTraceData.bufferKey, &caerTraceBufferOrphan) != 0
+		|| mtx_init(&glTraceData.buffersLock, mtx_plain) != thrd_success) {
+		// Tracing is optional, just never enable it.
+		caerLog(CAER_LOG_ERROR, "Trace", "Failed to initialize trace recorder, tracing not available.");
+		return;
+	}
+#else
+	// Per-thread buffers need POSIX thread-specific data, just never enable tracing.
+	caerLog(CAER_LOG_WARNING, "Trace", "Trace recorder not supported on this platform, tracing not available.");
+	return;
+#endif
+
+	if (sshsNodeGetBool(glTraceData.traceNode, "enabled")) {
+		atomic_store(&glTraceData.enabledSince, caerTraceTime());
+		atomic_store(&glTraceData.enabled, true);
+	}
+
+	sshsNodeAddAttributeListener(glTraceData.traceNode, NULL, &caerTraceConfigListener);
+}
+
+void caerTraceEvent(enum caer_trace_event_type type, enum caer_trace_phase phase, int16_t id, int32_t arg) {
+	if (!atomic_load_explicit(&glTraceData.enabled, memory_order_relaxed)) {
+		return;
+	}
+
+	struct trace_buffer *buffer = caerTraceBufferGet();
+	if (buffer == NULL) {
+		return;
+	}
+
+	uint_fast64_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+
+	struct trace_event *event = &buffer->events[head % CAER_TRACE_BUFFER_SIZE];
+	event->time = caerTraceTime();
+	event->type = (uint8_t) type;
+	event->phase = (uint8_t) phase;
+	event->id = id;
+	event->arg = arg;
+
+	atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+bool caerTraceDump(const char *filePath) {
+	FILE *dumpFile = fopen(filePath, "w");
+	if (dumpFile == NULL) {
+		return (false);
+	}
+
+	struct trace_event *events = malloc(CAER_TRACE_BUFFER_SIZE * sizeof(struct trace_event));
+	if (events == NULL) {
+		fclose(dumpFile);
+		return (false);
+	}
+
+	// Module names, by ID, collected once for all events.
+	size_t moduleNamesSize = 0;
+	struct trace_module_name *moduleNames = caerTraceModuleNamesGet(&moduleNamesSize);
+
+	uint64_t since = atomic_load(&glTraceData.enabledSince);
+	bool first = true;
+
+	fprintf(dumpFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+	mtx_lock(&glTraceData.buffersLock);
+#endif
+
+	struct trace_buffer **bufferPtr = &glTraceData.buffers;
+
+	while (*bufferPtr != NULL) {
+		struct trace_buffer *buffer = *bufferPtr;
+
+		// Checked first, so that an orphaned buffer is surely complete.
+		bool orphaned = atomic_load_explicit(&buffer->orphaned, memory_order_acquire);
+
+		caerTraceDumpBuffer(dumpFile, buffer, events, since, moduleNames, moduleNamesSize, &first);
+
+		if (orphaned) {
+			*bufferPtr = buffer->next;
+			free(buffer);
+		}
+		else {
+			bufferPtr = &buffer->next;
+		}
+	}
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+	mtx_unlock(&glTraceData.buffersLock);
+#endif
+
+	fprintf(dumpFile, "]}\n");
+
+	caerTraceModuleNamesFree(moduleNames, moduleNamesSize);
+	free(events);
+
+	bool success = !ferror(dumpFile);
+
+	if (fclose(dumpFile) != 0) {
+		success = false;
+	}
+
+	return (success);
+}
+
+static inline uint64_t caerTraceTime(void) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	return ((U64T(currentTime.tv_sec) * 1000000000ULL) + U64T(currentTime.tv_nsec));
+}
+
+static struct trace_buffer *caerTraceBufferGet(void) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	struct trace_buffer *buffer = pthread_getspecific(glTraceData.bufferKey);
+
+	if (buffer != NULL) {
+		return (buffer);
+	}
+
+	// First event from this thread. If allocation fails, it's retried on the next one.
+	buffer = malloc(sizeof(struct trace_buffer));
+	if (buffer == NULL) {
+		return (NULL);
+	}
+
+	atomic_init(&buffer->head, 0);
+	atomic_init(&buffer->orphaned, false);
+
+	if (pthread_setspecific(glTraceData.bufferKey, buffer) != 0) {
+		free(buffer);
+		return (NULL);
+	}
+
+	buffer->threadName[0] = '\0';
+	thrd_get_name(buffer->threadName, sizeof(buffer->threadName));
+
+	mtx_lock(&glTraceData.buffersLock);
+
+	buffer->threadId = ++glTraceData.nextThreadId;
+	buffer->next = glTraceData.buffers;
+	glTraceData.buffers = buffer;
+
+	mtx_unlock(&glTraceData.buffersLock);
+
+	return (buffer);
+#else
+	return (NULL);
+#endif
+}
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+static void caerTraceBufferOrphan(void *buffer) {
+	// Called at thread exit, events stay available for the next dump.
+	atomic_store_explicit(&((struct trace_buffer *) buffer)->orphaned, true, memory_order_release);
+}
+#endif
+
+static void caerTraceDumpBuffer(FILE *dumpFile, struct trace_buffer *buffer, struct trace_event *events,
+	uint64_t since, const struct trace_module_name *moduleNames, size_t moduleNamesSize, bool *first) {
+	static const char *typeNames[] = { "Run", "Commit", "Put", "Get", "Full" };
+	static const char *typeCategories[] = { "module", "input", "ringbuffer", "ringbuffer", "ringbuffer" };
+	static const char *ringNames[] = { "InputPackets", "InputContainers", "OutputContainers", "OutputBuffers" };
+
+	uint_fast64_t head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+	uint_fast64_t start = (head > CAER_TRACE_BUFFER_SIZE) ? (head - CAER_TRACE_BUFFER_SIZE) : (0);
+
+	for (uint_fast64_t i = start; i < head; i++) {
+		events[i - start] = buffer->events[i % CAER_TRACE_BUFFER_SIZE];
+	}
+
+	// Anything the thread could have started overwriting during the copy is unreliable.
+	uint_fast64_t newHead = atomic_load_explicit(&buffer->head, memory_order_acquire);
+	uint_fast64_t valid = (newHead >= CAER_TRACE_BUFFER_SIZE) ? (newHead - CAER_TRACE_BUFFER_SIZE + 1) : (0);
+
+	// Every character escaped takes up to six.
+	char threadName[(sizeof(buffer->threadName) * 6) + 1];
+	caerTraceJSONEscape(threadName, sizeof(threadName),
+		(buffer->threadName[0] != '\0') ? (buffer->threadName) : ("Thread"));
+
+	fprintf(dumpFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%" PRIu32
+		",\"args\":{\"name\":\"%s\"}}", (*first) ? ("") : (","), (long) getpid(), buffer->threadId, threadName);
+	*first = false;
+
+	for (uint_fast64_t i = (valid > start) ? (valid) : (start); i < head; i++) {
+		const struct trace_event *event = &events[i - start];
+
+		if (event->time < since || event->type > CAER_TRACE_RINGBUFFER_FULL) {
+			continue;
+		}
+
+		const char *moduleName = caerTraceModuleName(event->id, moduleNames, moduleNamesSize);
+
+		// Module runs are named after the module, to tell them apart at a glance.
+		fprintf(dumpFile, ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64
+			",\"pid\":%ld,\"tid\":%" PRIu32, (event->type == CAER_TRACE_MODULE_RUN) ? (moduleName)
+			: (typeNames[event->type]), typeCategories[event->type], event->phase, event->time / 1000,
+			event->time % 1000, (long) getpid(), buffer->threadId);
+
+		if (event->phase == CAER_TRACE_INSTANT) {
+			fprintf(dumpFile, ",\"s\":\"t\"");
+		}
+
+		if (event->type == CAER_TRACE_CONTAINER_COMMIT && event->phase == CAER_TRACE_BEGIN) {
+			fprintf(dumpFile, ",\"args\":{\"module\":\"%s\",\"events\":%" PRIi32 "}", moduleName, event->arg);
+		}
+		else if (event->type >= CAER_TRACE_RINGBUFFER_PUT) {
+			fprintf(dumpFile, ",\"args\":{\"module\":\"%s\",\"ring\":\"%s\"}", moduleName,
+				(event->arg >= 0 && event->arg <= CAER_TRACE_RING_OUTPUT_BUFFERS) ? (ringNames[event->arg]) : ("?"));
+		}
+		else {
+			fprintf(dumpFile, ",\"args\":{\"module\":\"%s\"}", moduleName);
+		}
+
+		fprintf(dumpFile, "}");
+	}
+}
+
+static struct trace_module_name *caerTraceModuleNamesGet(size_t *moduleNamesSize) {
+	*moduleNamesSize = 0;
+
+	size_t modulesSize = 0;
+	sshsNode *modules = sshsNodeGetChildren(sshsGetNode(sshsGetGlobal(), "/"), &modulesSize);
+	if (modules == NULL) {
+		return (NULL);
+	}
+
+	// Without names, all modules are simply shown as unknown.
+	struct trace_module_name *moduleNames = malloc(modulesSize * sizeof(struct trace_module_name));
+	if (moduleNames == NULL) {
+		free(modules);
+		return (NULL);
+	}
+
+	for (size_t i = 0; i < modulesSize; i++) {
+		if (sshsNodeAttributeExists(modules[i], "moduleId", SSHS_SHORT)) {
+			const char *name = sshsNodeGetName(modules[i]);
+
+			// Every character escaped takes up to six. Without memory, shown as unknown.
+			size_t escapedNameSize = (strlen(name) * 6) + 1;
+			char *escapedName = malloc(escapedNameSize);
+			if (escapedName == NULL) {
+				continue;
+			}
+
+			caerTraceJSONEscape(escapedName, escapedNameSize, name);
+
+			moduleNames[*moduleNamesSize].id = sshsNodeGetShort(modules[i], "moduleId");
+			moduleNames[*moduleNamesSize].name = escapedName;
+			(*moduleNamesSize)++;
+		}
+	}
+
+	free(modules);
+
+	qsort(moduleNames, *moduleNamesSize, sizeof(struct trace_module_name), &caerTraceModuleNameCmp);
+
+	return (moduleNames);
+}
+
+static void caerTraceModuleNamesFree(struct trace_module_name *moduleNames, size_t moduleNamesSize) {
+	for (size_t i = 0; i < moduleNamesSize; i++) {
+		free(moduleNames[i].name);
+	}
+
+	free(moduleNames);
+}
+
+/**
+ * Escape a string for use inside a JSON string: quotes, backslashes and
+ * control characters. Names come from users and threads, so anything goes.
+ *
+ * @param dest where to write the escaped, NUL-terminated string.
+ * @param destSize size of dest. Escaped strings are at most six times longer.
+ * @param src string to escape.
+ *
+ * @return length of the escaped string, truncated to fit if needed.
+ */
+static size_t caerTraceJSONEscape(char *dest, size_t destSize, const char *src) {
+	size_t length = 0;
+
+	for (; *src != '\0'; src++) {
+		unsigned char c = (unsigned char) *src;
+		char escaped[7];
+
+		if (c == '"' || c == '\\') {
+			escaped[0] = '\\';
+			escaped[1] = (char) c;
+			escaped[2] = '\0';
+		}
+		else if (c < 0x20) {
+			snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+		}
+		else {
+			escaped[0] = (char) c;
+			escaped[1] = '\0';
+		}
+
+		size_t escapedLength = strlen(escaped);
+
+		// Never split an escape sequence.
+		if ((length + escapedLength) >= destSize) {
+			break;
+		}
+
+		memcpy(dest + length, escaped, escapedLength);
+		length += escapedLength;
+	}
+
+	dest[length] = '\0';
+
+	return (length);
+}
+
+static int caerTraceModuleNameCmp(const void *a, const void *b) {
+	const struct trace_module_name *aa = a;
+	const struct trace_module_name *bb = b;
+
+	return (aa->id - bb->id);
+}
+
+static const char *caerTraceModuleName(int16_t id, const struct trace_module_name *moduleNames,
+	size_t moduleNamesSize) {
+	if (moduleNamesSize == 0) {
+		return ("Unknown");
+	}
+
+	struct trace_module_name key = { .id = id, .name = NULL };
+
+	const struct trace_module_name *found = bsearch(&key, moduleNames, moduleNamesSize,
+		sizeof(struct trace_module_name), &caerTraceModuleNameCmp);
+
+	return ((found != NULL) ? (found->name) : ("Unknown"));
+}
+
+static void caerTraceConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(userData);
+
+	if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL && caerStrEquals(changeKey, "enabled")) {
+		if (changeValue.boolean) {
+			// Only events from now on are dumped.
+			atomic_store(&glTraceData.enabledSince, caerTraceTime());
+		}
+
+		atomic_store(&glTraceData.enabled, changeValue.boolean);
+
+		caerLog(CAER_LOG_DEBUG, "Trace", "Tracing %s.", (changeValue.boolean) ? ("enabled") : ("disabled"));
+	}
+	else if (event == SSHS_ATTRIBUTE_MODIFIED && changeType == SSHS_BOOL && caerStrEquals(changeKey, "dump")) {
+		char *dumpFile = sshsNodeGetString(node, "dumpFile");
+
+		if (caerTraceDump(dumpFile)) {
+			caerLog(CAER_LOG_INFO, "Trace", "Trace dumped to '%s'.", dumpFile);
+		}
+		else {
+			caerLog(CAER_LOG_ERROR, "Trace", "Failed to dump trace to '%s'. Error: %d.", dumpFile, errno);
+		}
+
+		free(dumpFile);
+	}
+}
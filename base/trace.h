@@ -0,0 +1,66 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Events kept per thread, older ones are overwritten.
+#define CAER_TRACE_BUFFER_SIZE 32768
+
+// Trace recorder: while enabled through '/caer/trace/enabled', timestamped
+// events are recorded into per-thread ring-buffers, without locks, and can be
+// dumped at any time by setting '/caer/trace/dump' as Chrome trace JSON, which
+// both chrome://tracing and Perfetto can show.
+enum caer_trace_event_type {
+	CAER_TRACE_MODULE_RUN = 0, // Duration. ID is the module, ARG unused.
+	CAER_TRACE_CONTAINER_COMMIT = 1, // Duration. ID is the module, ARG the number of events.
+	CAER_TRACE_RINGBUFFER_PUT = 2, // Instant. ID is the module, ARG the ring-buffer.
+	CAER_TRACE_RINGBUFFER_GET = 3, // Instant. ID is the module, ARG the ring-buffer.
+	CAER_TRACE_RINGBUFFER_FULL = 4, // Instant. ID is the module, ARG the ring-buffer.
+};
+
+enum caer_trace_phase {
+	CAER_TRACE_BEGIN = 'B',
+	CAER_TRACE_END = 'E',
+	CAER_TRACE_INSTANT = 'i',
+};
+
+enum caer_trace_ringbuffer {
+	CAER_TRACE_RING_INPUT_PACKETS = 0,
+	CAER_TRACE_RING_INPUT_CONTAINERS = 1,
+	CAER_TRACE_RING_OUTPUT_CONTAINERS = 2,
+	CAER_TRACE_RING_OUTPUT_BUFFERS = 3,
+};
+
+void caerTraceInit(void);
+
+/**
+ * Record an event on the calling thread's trace buffer.
+ * Does nothing, except for checking a flag, while tracing is disabled.
+ *
+ * @param type what happened.
+ * @param phase begin or end of a duration, or instant.
+ * @param id module ID.
+ * @param arg additional, type-specific information.
+ */
+void caerTraceEvent(enum caer_trace_event_type type, enum caer_trace_phase phase, int16_t id, int32_t arg)
+	CAER_SYMBOL_EXPORT;
+
+/**
+ * Write all recorded events since tracing was last enabled to a file,
+ * in Chrome trace JSON format. Recording continues meanwhile.
+ *
+ * @param filePath file to write to, replaced if it exists.
+ *
+ * @return true on success, false on error (errno is set).
+ */
+bool caerTraceDump(const char *filePath);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
@@ -81,6 +81,79 @@ static inline void simple2DBufferReset##NAME(simple2DBuffer##NAME buffer2d) { \
 	} \
 }
 
+// Contiguous row-major 2D map, so that map->map[y * map->stride + x] (or
+// simple2DMapRowLong(map, y)[x]) accesses element (x, y). Rows are aligned to
+// the cache-line size and surrounded by 'border' unused elements on each
+// side, so that neighbourhood accesses up to 'border' away from a valid
+// element need no bounds checks. Border elements are never read by users,
+// only written, so they can hold anything.
+#define BUFFERS_2D_MAP_ALIGNMENT 64
+
+#define buffers_define_2d_map_typed(TYPE, NAME) \
+\
+	struct simple_2d_map_##TYPE { \
+	size_t sizeX; \
+	size_t sizeY; \
+	size_t border; \
+	/* Distance between rows, in elements. */ \
+	size_t stride; \
+	/* Points to element (0, 0), inside the border. */ \
+	TYPE *map; \
+	/* Start of the whole allocation, including border and alignment. */ \
+	void *memory; \
+	size_t memorySize; \
+}; \
+\
+typedef struct simple_2d_map_##TYPE *simple2DMap##NAME; \
+\
+static inline simple2DMap##NAME simple2DMapInit##NAME(size_t sizeX, size_t sizeY, size_t border) { \
+	simple2DMap##NAME map2d = malloc(sizeof(*map2d)); \
+	if (map2d == NULL) { \
+		return (NULL); \
+	} \
+\
+	/* Pad each row to a whole number of cache-lines, and add as many leading */ \
+	/* elements as needed to have (0, y) start a cache-line. */ \
+	size_t elemsPerLine = BUFFERS_2D_MAP_ALIGNMENT / sizeof(TYPE); \
+	size_t leading = ((border + elemsPerLine - 1) / elemsPerLine) * elemsPerLine; \
+	size_t stride = (((leading + sizeX + border) + elemsPerLine - 1) / elemsPerLine) * elemsPerLine; \
+\
+	map2d->memorySize = (stride * (sizeY + (2 * border)) * sizeof(TYPE)) + BUFFERS_2D_MAP_ALIGNMENT; \
+	map2d->memory = calloc(1, map2d->memorySize); \
+	if (map2d->memory == NULL) { \
+		free(map2d); \
+		return (NULL); \
+	} \
+\
+	uintptr_t aligned = ((uintptr_t) map2d->memory + BUFFERS_2D_MAP_ALIGNMENT - 1) \
+		& ~((uintptr_t) BUFFERS_2D_MAP_ALIGNMENT - 1); \
+\
+	map2d->sizeX = sizeX; \
+	map2d->sizeY = sizeY; \
+	map2d->border = border; \
+	map2d->stride = stride; \
+	map2d->map = (TYPE *) aligned + (border * stride) + leading; \
+\
+	return (map2d); \
+} \
+\
+static inline void simple2DMapFree##NAME(simple2DMap##NAME map2d) { \
+	if (map2d != NULL) { \
+		free(map2d->memory); \
+		free(map2d); \
+	} \
+} \
+\
+static inline void simple2DMapReset##NAME(simple2DMap##NAME map2d) { \
+	if (map2d != NULL) { \
+		memset(map2d->memory, 0, map2d->memorySize); \
+	} \
+} \
+\
+static inline TYPE *simple2DMapRow##NAME(simple2DMap##NAME map2d, size_t y) { \
+	return (map2d->map + (y * map2d->stride)); \
+}
+
 buffers_define_2d_typed(int8_t, Byte)
 buffers_define_2d_typed(int16_t, Short)
 buffers_define_2d_typed(int32_t, Int)
@@ -88,4 +161,11 @@ buffers_define_2d_typed(int64_t, Long)
 buffers_define_2d_typed(float, Float)
 buffers_define_2d_typed(double, Double)
 
+buffers_define_2d_map_typed(int8_t, Byte)
+buffers_define_2d_map_typed(int16_t, Short)
+buffers_define_2d_map_typed(int32_t, Int)
+buffers_define_2d_map_typed(int64_t, Long)
+buffers_define_2d_map_typed(float, Float)
+buffers_define_2d_map_typed(double, Double)
+
 #endif /* BUFFERS_H_ */
@@ -13,6 +13,7 @@ typedef pthread_t thrd_t;
 typedef pthread_once_t once_flag;
 typedef pthread_mutex_t mtx_t;
 typedef pthread_rwlock_t mtx_shared_t; // NON STANDARD!
+typedef pthread_cond_t cnd_t;
 typedef int (*thrd_start_t)(void *);
 
 enum {
@@ -335,4 +336,40 @@ static inline int mtx_shared_unlock_shared(mtx_shared_t *mutex) {
 	return (thrd_success);
 }
 
+static inline int cnd_init(cnd_t *cond) {
+	if (pthread_cond_init(cond, NULL) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline void cnd_destroy(cnd_t *cond) {
+	pthread_cond_destroy(cond);
+}
+
+static inline int cnd_signal(cnd_t *cond) {
+	if (pthread_cond_signal(cond) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline int cnd_broadcast(cnd_t *cond) {
+	if (pthread_cond_broadcast(cond) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
+static inline int cnd_wait(cnd_t *cond, mtx_t *mutex) {
+	if (pthread_cond_wait(cond, mutex) != 0) {
+		return (thrd_error);
+	}
+
+	return (thrd_success);
+}
+
 #endif	/* C11THREADS_POSIX_H_ */
@@ -0,0 +1,296 @@
+#ifndef CLUSTERGRID_H_
+#define CLUSTERGRID_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// Uniform grid over the pixel array, to find the clusters that may capture an
+// event without testing all of them. Each cluster is registered in every cell
+// its capture area (plus some slack) overlaps, so an event only needs to be
+// tested against the clusters in its own cell.
+// Entries in a cell are kept sorted by an order key, chosen by the user to be
+// the order in which its full cluster list would be walked. So visiting the
+// cell gives the same candidates, in the same order, and the same results.
+//
+// The capture area can move without any update to the cluster, as its center
+// may be extrapolated from a velocity. The grid keeps track of the earliest time
+// at which any cluster could leave its cells; after that, or after any change
+// to clusters other than through clusterGridUpdate(), users must rebuild it with
+// clusterGridClear() and clusterGridUpdate() for all clusters.
+
+// Extra space in pixels around a capture area when (re-)registering a cluster,
+// so that small moves don't require moving it to other cells every time.
+#define CLUSTER_GRID_SLACK 2.0f
+// Added to capture areas, to cover rounding errors in the users' distance computations.
+#define CLUSTER_GRID_MARGIN 1.0f
+
+struct cluster_grid_entry {
+	int64_t order;
+	void *cluster;
+};
+
+struct cluster_grid_cell {
+	size_t size;
+	size_t capacity;
+	struct cluster_grid_entry *entries;
+};
+
+struct cluster_grid {
+	int cellSize;
+	int cellsX;
+	int cellsY;
+	struct cluster_grid_cell *cells;
+	/// Incremented on each clear, to invalidate all registrations at once.
+	uint64_t epoch;
+	/// All clusters are in their cells from this time, at least until the other.
+	int64_t validFrom;
+	int64_t validUntil;
+	/// False if a cluster couldn't be registered (out of memory), the grid
+	/// must not be used for lookups then, until the next successful rebuild.
+	bool complete;
+};
+
+typedef struct cluster_grid *clusterGrid;
+
+/// Where a cluster is registered, kept by the user with each cluster.
+struct cluster_grid_registration {
+	uint64_t epoch;
+	int cellX0;
+	int cellY0;
+	int cellX1;
+	int cellY1;
+};
+
+static inline bool clusterGridInit(clusterGrid grid, int sizeX, int sizeY, int cellSize) {
+	grid->cellSize = cellSize;
+	grid->cellsX = (sizeX + cellSize - 1) / cellSize;
+	grid->cellsY = (sizeY + cellSize - 1) / cellSize;
+
+	grid->cells = calloc((size_t) (grid->cellsX * grid->cellsY), sizeof(struct cluster_grid_cell));
+	if (grid->cells == NULL) {
+		return (false);
+	}
+
+	// Start invalid, so the first lookup forces a build.
+	grid->epoch = 1;
+	grid->validFrom = INT64_MAX;
+	grid->validUntil = INT64_MIN;
+	grid->complete = false;
+
+	return (true);
+}
+
+static inline void clusterGridFree(clusterGrid grid) {
+	if (grid->cells == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < (size_t) (grid->cellsX * grid->cellsY); i++) {
+		free(grid->cells[i].entries);
+	}
+
+	free(grid->cells);
+	grid->cells = NULL;
+}
+
+/**
+ * Remove all clusters from the grid, keeping memory around for re-use.
+ * All existing registrations become invalid.
+ */
+static inline void clusterGridClear(clusterGrid grid) {
+	for (size_t i = 0; i < (size_t) (grid->cellsX * grid->cellsY); i++) {
+		grid->cells[i].size = 0;
+	}
+
+	grid->epoch++;
+	grid->validFrom = INT64_MIN;
+	grid->validUntil = INT64_MAX;
+	grid->complete = true;
+}
+
+/**
+ * Force a rebuild before the next lookup, for example after the
+ * clusters were changed or moved around in memory.
+ */
+static inline void clusterGridInvalidate(clusterGrid grid) {
+	grid->validUntil = INT64_MIN;
+}
+
+/**
+ * Check if the grid can be used for lookups at the given time.
+ */
+static inline bool clusterGridIsValid(clusterGrid grid, int64_t ts) {
+	return (grid->complete && ts >= grid->validFrom && ts <= grid->validUntil);
+}
+
+/**
+ * Get the cell containing a pixel, with all the clusters that may capture
+ * an event there, sorted by their order key.
+ */
+static inline struct cluster_grid_cell *clusterGridGetCell(clusterGrid grid, uint16_t x, uint16_t y) {
+	return (&grid->cells[((y / grid->cellSize) * grid->cellsX) + (x / grid->cellSize)]);
+}
+
+static inline bool clusterGridCellInsert(struct cluster_grid_cell *cell, int64_t order, void *cluster) {
+	if (cell->size == cell->capacity) {
+		size_t newCapacity = (cell->capacity == 0) ? (4) : (cell->capacity * 2);
+
+		struct cluster_grid_entry *newEntries = realloc(cell->entries, newCapacity * sizeof(struct cluster_grid_entry));
+		if (newEntries == NULL) {
+			return (false);
+		}
+
+		cell->entries = newEntries;
+		cell->capacity = newCapacity;
+	}
+
+	// Clusters are mostly added in order, so search for the position from the end.
+	size_t pos = cell->size;
+	while (pos > 0 && cell->entries[pos - 1].order > order) {
+		pos--;
+	}
+
+	memmove(&cell->entries[pos + 1], &cell->entries[pos], (cell->size - pos) * sizeof(struct cluster_grid_entry));
+
+	cell->entries[pos].order = order;
+	cell->entries[pos].cluster = cluster;
+	cell->size++;
+
+	return (true);
+}
+
+static inline void clusterGridCellRemove(struct cluster_grid_cell *cell, void *cluster) {
+	for (size_t pos = 0; pos < cell->size; pos++) {
+		if (cell->entries[pos].cluster == cluster) {
+			memmove(&cell->entries[pos], &cell->entries[pos + 1],
+				(cell->size - pos - 1) * sizeof(struct cluster_grid_entry));
+			cell->size--;
+			return;
+		}
+	}
+}
+
+static inline int clusterGridCellIndex(float coord, int cellSize, int cells) {
+	float cell = floorf(coord / (float) cellSize);
+
+	// Also catches NaN.
+	if (!(cell >= 0)) {
+		return (0);
+	}
+	if (cell > (float) (cells - 1)) {
+		return (cells - 1);
+	}
+
+	return ((int) cell);
+}
+
+/**
+ * Distance in pixels a capture area can move along one axis, in the direction
+ * given by the drift, before leaving its registered cells. Grid borders never
+ * limit movement, as there are no events beyond them.
+ */
+static inline float clusterGridRoom(float low, float high, float drift, int cell0, int cell1, int cellSize, int cells) {
+	if (drift > 0) {
+		return ((cell1 == (cells - 1)) ? (INFINITY) : ((float) ((cell1 + 1) * cellSize) - high));
+	}
+
+	if (drift < 0) {
+		return ((cell0 == 0) ? (INFINITY) : (low - (float) (cell0 * cellSize)));
+	}
+
+	return (INFINITY);
+}
+
+/**
+ * Register a new cluster, or update a registered one after it changed. It is only
+ * moved to other cells if its capture area doesn't fit in its current ones anymore.
+ *
+ * The capture area is a square with the given half-side around the center, which
+ * moves with the drift (in pixels per time unit) from the 'since' time onwards.
+ *
+ * @param grid the cluster grid.
+ * @param reg the cluster's registration information.
+ * @param order sort key, the lower it is the earlier the cluster is returned in lookups.
+ * @param cluster the user's cluster.
+ * @param centerX capture area center at 'since' time, X axis.
+ * @param centerY capture area center at 'since' time, Y axis.
+ * @param driftX capture area center movement per time unit, X axis.
+ * @param driftY capture area center movement per time unit, Y axis.
+ * @param since time from which the drift applies.
+ * @param halfSide half the side of the capture area.
+ * @param ts current time.
+ */
+static inline void clusterGridUpdate(clusterGrid grid, struct cluster_grid_registration *reg, int64_t order,
+	void *cluster, float centerX, float centerY, float driftX, float driftY, int64_t since, float halfSide,
+	int64_t ts) {
+	int64_t from = (ts > since) ? (ts) : (since);
+	float elapsed = (float) (from - since);
+
+	float r = halfSide + CLUSTER_GRID_MARGIN;
+	float lowX = centerX + (driftX * elapsed) - r;
+	float highX = centerX + (driftX * elapsed) + r;
+	float lowY = centerY + (driftY * elapsed) - r;
+	float highY = centerY + (driftY * elapsed) + r;
+
+	bool registered = (reg->epoch == grid->epoch);
+
+	bool fits = registered && (reg->cellX0 == 0 || lowX >= (float) (reg->cellX0 * grid->cellSize))
+		&& (reg->cellX1 == (grid->cellsX - 1) || highX < (float) ((reg->cellX1 + 1) * grid->cellSize))
+		&& (reg->cellY0 == 0 || lowY >= (float) (reg->cellY0 * grid->cellSize))
+		&& (reg->cellY1 == (grid->cellsY - 1) || highY < (float) ((reg->cellY1 + 1) * grid->cellSize));
+
+	if (!fits) {
+		if (registered) {
+			for (int cy = reg->cellY0; cy <= reg->cellY1; cy++) {
+				for (int cx = reg->cellX0; cx <= reg->cellX1; cx++) {
+					clusterGridCellRemove(&grid->cells[(cy * grid->cellsX) + cx], cluster);
+				}
+			}
+		}
+
+		reg->epoch = grid->epoch;
+		reg->cellX0 = clusterGridCellIndex(lowX - CLUSTER_GRID_SLACK, grid->cellSize, grid->cellsX);
+		reg->cellY0 = clusterGridCellIndex(lowY - CLUSTER_GRID_SLACK, grid->cellSize, grid->cellsY);
+		reg->cellX1 = clusterGridCellIndex(highX + CLUSTER_GRID_SLACK, grid->cellSize, grid->cellsX);
+		reg->cellY1 = clusterGridCellIndex(highY + CLUSTER_GRID_SLACK, grid->cellSize, grid->cellsY);
+
+		for (int cy = reg->cellY0; cy <= reg->cellY1; cy++) {
+			for (int cx = reg->cellX0; cx <= reg->cellX1; cx++) {
+				if (!clusterGridCellInsert(&grid->cells[(cy * grid->cellsX) + cx], order, cluster)) {
+					grid->complete = false;
+				}
+			}
+		}
+	}
+
+	// Time until the capture area leaves its cells, along the first axis to do so.
+	float timeX = clusterGridRoom(lowX, highX, driftX, reg->cellX0, reg->cellX1, grid->cellSize, grid->cellsX)
+		/ fabsf(driftX);
+	float timeY = clusterGridRoom(lowY, highY, driftY, reg->cellY0, reg->cellY1, grid->cellSize, grid->cellsY)
+		/ fabsf(driftY);
+	float time = (timeX < timeY) ? (timeX) : (timeY);
+
+	// Also catches NaN, in which case the grid is rebuilt on the next lookup.
+	int64_t validUntil = INT64_MAX;
+	if (!(time >= 0)) {
+		validUntil = INT64_MIN;
+	}
+	else if (time < 1e15f) {
+		validUntil = from + (int64_t) time;
+	}
+
+	if (validUntil < grid->validUntil) {
+		grid->validUntil = validUntil;
+	}
+
+	// Only the capture area from now on is known to be covered, earlier
+	// ones aren't when the center is moving.
+	if (from > grid->validFrom) {
+		grid->validFrom = from;
+	}
+}
+
+#endif /* CLUSTERGRID_H_ */
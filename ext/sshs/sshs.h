@@ -33,6 +33,7 @@ extern "C" {
 
 // SSHS node
 typedef struct sshs_node *sshsNode;
+typedef struct sshs_node_attr *sshsNodeAttr;
 
 enum sshs_node_attr_value_type {
 	SSHS_UNKNOWN = -1,
@@ -125,8 +126,27 @@ void sshsNodeClearSubTree(sshsNode startNode, bool clearStartNode) CAER_SYMBOL_E
 bool sshsNodeAttributeExists(sshsNode node, const char *key, enum sshs_node_attr_value_type type) CAER_SYMBOL_EXPORT;
 bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	union sshs_node_attr_value value) CAER_SYMBOL_EXPORT;
+bool sshsNodeCheckAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) CAER_SYMBOL_EXPORT;
 union sshs_node_attr_value sshsNodeGetAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type)
 	CAER_SYMBOL_EXPORT;
+/**
+ * Attribute handles, for lock-free reads of frequently accessed attributes, for example
+ * from a module's run function. The handle is looked up once and then always reflects
+ * the current value, without taking the node lock. Strings are not supported.
+ * A handle stays valid as long as its attribute exists: it must not be used anymore
+ * after the attribute is removed (sshsNodeRemoveAttribute(), sshsNodeRemoveNode(), ...).
+ */
+sshsNodeAttr sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type)
+	CAER_SYMBOL_EXPORT;
+union sshs_node_attr_value sshsNodeAttributeHandleGet(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+bool sshsNodeAttributeHandleGetBool(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+int8_t sshsNodeAttributeHandleGetByte(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+int16_t sshsNodeAttributeHandleGetShort(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+int32_t sshsNodeAttributeHandleGetInt(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+int64_t sshsNodeAttributeHandleGetLong(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+float sshsNodeAttributeHandleGetFloat(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
+double sshsNodeAttributeHandleGetDouble(sshsNodeAttr attr) CAER_SYMBOL_EXPORT;
 bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
 	union sshs_node_attr_value value) CAER_SYMBOL_EXPORT;
 void sshsNodeCreateBool(sshsNode node, const char *key, bool defaultValue, int flags, const char *description)
@@ -100,6 +100,13 @@ inline bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, cons
 	return (sshsNodeUpdateReadOnlyAttribute(node, key, SSHS_STRING, newValue));
 }
 
+// Additional updater for int64_t.
+inline bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, int64_t value) {
+	union sshs_node_attr_value newValue;
+	newValue.ilong = value;
+	return (sshsNodeUpdateReadOnlyAttribute(node, key, SSHS_LONG, newValue));
+}
+
 // std::string variants of node getters.
 inline bool sshsExistsNode(sshs st, const std::string &nodePath) {
 	return (sshsExistsNode(st, nodePath.c_str()));
@@ -19,7 +19,6 @@
 	}
 
 // SSHS node
-typedef struct sshs_node_attr *sshsNodeAttr;
 typedef struct sshs_node_listener *sshsNodeListener;
 typedef struct sshs_node_attr_listener *sshsNodeAttrListener;
 
@@ -2,6 +2,7 @@
 #include "ext/uthash/uthash.h"
 #include "ext/uthash/utlist.h"
 #include <float.h>
+#include <stdatomic.h>
 
 struct sshs_node {
 	char *name;
@@ -23,6 +24,7 @@ struct sshs_node_attr {
 	int flags;
 	char *description;
 	union sshs_node_attr_value value;
+	atomic_uint_fast64_t valueAtomic; // Copy of value for lock-free reads, see sshsNodeAttrPublishValue().
 	enum sshs_node_attr_value_type value_type;
 	char key[];
 };
@@ -384,6 +386,15 @@ static bool sshsNodeCheckRange(enum sshs_node_attr_value_type type, union sshs_n
 	}
 }
 
+// Make the current value visible to lock-free readers (attribute handles).
+// Must be called, with the node lock held, after every change to the value.
+static inline void sshsNodeAttrPublishValue(sshsNodeAttr attr) {
+	uint64_t valueBits = 0;
+	memcpy(&valueBits, &attr->value, sizeof(attr->value));
+
+	atomic_store_explicit(&attr->valueAtomic, valueBits, memory_order_relaxed);
+}
+
 static inline void sshsNodeFreeAttribute(sshsNodeAttr attr) {
 	// Free attribute's string memory, then attribute itself.
 	if (attr->value_type == SSHS_STRING) {
@@ -473,6 +484,8 @@ void sshsNodeCreateAttribute(sshsNode node, const char *key, enum sshs_node_attr
 		newAttr->value = defaultValue;
 	}
 
+	sshsNodeAttrPublishValue(newAttr);
+
 	newAttr->min = minValue;
 	newAttr->max = maxValue;
 	newAttr->flags = flags;
@@ -523,6 +536,7 @@ void sshsNodeCreateAttribute(sshsNode node, const char *key, enum sshs_node_attr
 			}
 
 			oldAttr->value = newAttr->value;
+			sshsNodeAttrPublishValue(oldAttr);
 
 			free(newAttr);
 
@@ -791,6 +805,8 @@ bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_va
 		else {
 			attr->value = value;
 		}
+
+		sshsNodeAttrPublishValue(attr);
 	}
 
 	// Let's check if anything changed with this update and call
@@ -816,6 +832,35 @@ bool sshsNodePutAttribute(sshsNode node, const char *key, enum sshs_node_attr_va
 	return (true);
 }
 
+// Check that sshsNodePutAttribute() would accept the value, without changing anything.
+// On failure, errno is ENOENT, EPERM or ERANGE, like for sshsNodePutAttribute().
+bool sshsNodeCheckAttribute(sshsNode node, const char *key, enum sshs_node_attr_value_type type,
+	union sshs_node_attr_value value) {
+	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
+
+	if (attr == NULL) {
+		mtx_unlock(&node->node_lock);
+		errno = ENOENT;
+		return (false);
+	}
+
+	if (attr->flags & SSHS_FLAGS_READ_ONLY) {
+		mtx_unlock(&node->node_lock);
+		errno = EPERM;
+		return (false);
+	}
+
+	if (!sshsNodeCheckRange(type, value, attr->min, attr->max)) {
+		mtx_unlock(&node->node_lock);
+		errno = ERANGE;
+		return (false);
+	}
+
+	mtx_unlock(&node->node_lock);
+
+	return (true);
+}
+
 static bool sshsNodeCheckAttributeValueChanged(enum sshs_node_attr_value_type type, union sshs_node_attr_value oldValue,
 	union sshs_node_attr_value newValue) {
 	// Check that the two values changed, that there is a difference between then.
@@ -874,6 +919,66 @@ union sshs_node_attr_value sshsNodeGetAttribute(sshsNode node, const char *key,
 	return (value);
 }
 
+sshsNodeAttr sshsNodeGetAttributeHandle(sshsNode node, const char *key, enum sshs_node_attr_value_type type) {
+	if (type == SSHS_STRING) {
+		char errorMsg[1024];
+		snprintf(errorMsg, 1024,
+			"sshsNodeGetAttributeHandle(): attribute '%s' is of type 'string', which has no handle support. "
+				"Please use sshsNodeGetString() instead!", key);
+
+		(*sshsGetGlobalErrorLogCallback())(errorMsg);
+
+		// This is a critical usage error that *must* be fixed!
+		exit(EXIT_FAILURE);
+	}
+
+	sshsNodeAttr attr = sshsNodeFindAttribute(node, key, type);
+
+	// Verify that a valid attribute exists.
+	sshsNodeVerifyValidAttribute(attr, key, type, "sshsNodeGetAttributeHandle");
+
+	mtx_unlock(&node->node_lock);
+
+	return (attr);
+}
+
+union sshs_node_attr_value sshsNodeAttributeHandleGet(sshsNodeAttr attr) {
+	uint64_t valueBits = atomic_load_explicit(&attr->valueAtomic, memory_order_relaxed);
+
+	union sshs_node_attr_value value;
+	memcpy(&value, &valueBits, sizeof(value));
+
+	return (value);
+}
+
+bool sshsNodeAttributeHandleGetBool(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).boolean);
+}
+
+int8_t sshsNodeAttributeHandleGetByte(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).ibyte);
+}
+
+int16_t sshsNodeAttributeHandleGetShort(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).ishort);
+}
+
+int32_t sshsNodeAttributeHandleGetInt(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).iint);
+}
+
+int64_t sshsNodeAttributeHandleGetLong(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).ilong);
+}
+
+float sshsNodeAttributeHandleGetFloat(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).ffloat);
+}
+
+double sshsNodeAttributeHandleGetDouble(sshsNodeAttr attr) {
+	return (sshsNodeAttributeHandleGet(attr).ddouble);
+}
+
 static inline bool strEndsWith(const char *str, const char *suffix) {
 	if (str == NULL || suffix == NULL) {
 		return (false);
@@ -975,6 +1080,8 @@ bool sshsNodeUpdateReadOnlyAttribute(sshsNode node, const char *key, enum sshs_n
 		attr->value = value;
 	}
 
+	sshsNodeAttrPublishValue(attr);
+
 	// Let's check if anything changed with this update and call
 	// the appropriate listeners if needed.
 	if (sshsNodeCheckAttributeValueChanged(type, attrValueOld, value)) {
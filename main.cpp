@@ -1,9 +1,11 @@
 #include "main.h"
+#include "base/batch.h"
 #include "base/config.h"
 #include "base/config_server.h"
 #include "base/log.h"
 #include "base/mainloop.h"
 #include "base/misc.h"
+#include "base/trace.h"
 
 int main(int argc, char **argv) {
 	// Initialize config storage from file, support command-line overrides.
@@ -13,6 +15,15 @@ int main(int argc, char **argv) {
 	// Initialize logging sub-system.
 	caerLogInit();
 
+	// Initialize trace recorder, disabled by default.
+	caerTraceInit();
+
+	// Batch processing of files runs unattended and exits when done,
+	// so no configuration server is needed.
+	if (caerBatchEnabled()) {
+		return (caerBatchRun());
+	}
+
 	// Daemonize the application (run in background, NOT AVAILABLE ON WINDOWS).
 	// caerDaemonize();
 
@@ -5,10 +5,55 @@
 
 #include <libcaer/events/polarity.h>
 
+#ifdef HAVE_PTHREADS
+#include "ext/c11threads_posix.h"
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Below this many events per packet, waking up tile workers costs more than it gains.
+#define BAF_TILES_MIN_EVENTS 4096
+
+struct BAFilter_state;
+
+struct BAFilter_tile_worker {
+	struct BAFilter_state *state;
+	/// Tile processed by this worker. Tile zero is always done by the mainloop thread.
+	size_t tile;
+	thrd_t thread;
+};
+
+struct BAFilter_tiles {
+	/// Number of tiles, one per thread. One means filter serially.
+	size_t tilesNumber;
+	/// Worker threads, one for each tile except the first.
+	struct BAFilter_tile_worker *workers;
+	/// Protects all the fields below.
+	mtx_t lock;
+	/// Signal workers that there is a new packet, or that they have to shut down.
+	cnd_t packetAvailable;
+	/// Signal the mainloop thread that all workers are done with the packet.
+	cnd_t packetDone;
+	bool shutdown;
+	/// Incremented for each new packet, so workers can tell it apart from the last one.
+	uint64_t packetGeneration;
+	size_t workersPending;
+	caerPolarityEventPacket packet;
+	/// Filtering decision for each event of the current packet, by event index.
+	/// Each entry is only written by the tile that owns the event's row.
+	uint8_t *invalidate;
+	size_t invalidateSize;
+};
+
 struct BAFilter_state {
-	simple2DBufferLong timestampMap;
+	simple2DMapLong timestampMap;
 	int32_t deltaT;
 	int8_t subSampleBy;
+	struct BAFilter_tiles tiles;
 };
 
 typedef struct BAFilter_state *BAFilterState;
@@ -20,6 +65,14 @@ static void caerBackgroundActivityFilterRun(caerModuleData moduleData, caerEvent
 static void caerBackgroundActivityFilterConfig(caerModuleData moduleData);
 static void caerBackgroundActivityFilterExit(caerModuleData moduleData);
 static void caerBackgroundActivityFilterReset(caerModuleData moduleData, int16_t resetCallSourceID);
+static void filterSerial(BAFilterState state, caerPolarityEventPacket polarity);
+static void filterTiled(BAFilterState state, caerPolarityEventPacket polarity);
+static void filterTile(BAFilterState state, caerPolarityEventPacket polarity, size_t tile);
+static bool tilesStart(caerModuleData moduleData, size_t tilesNumber);
+static void tilesStop(caerModuleData moduleData);
+static int tileWorkerThread(void *workerArg);
+static inline void updateNeighbourhood(int64_t *center, size_t stride, int64_t ts);
+static inline void updateNeighbourRow(int64_t *left, int64_t ts);
 
 static const struct caer_module_functions BAFilterFunctions = { .moduleConfigInit =
 	&caerBackgroundActivityFilterConfigInit, .moduleInit = &caerBackgroundActivityFilterInit, .moduleRun =
@@ -43,6 +96,9 @@ static void caerBackgroundActivityFilterConfigInit(sshsNode moduleNode) {
 		"Maximum time difference in µs for events to be considered correlated and not be filtered out.");
 	sshsNodeCreateByte(moduleNode, "subSampleBy", 0, 0, 20, SSHS_FLAGS_NORMAL,
 		"Sub-sample event addresses by shifting right by this amount.");
+	sshsNodeCreateInt(moduleNode, "tileThreads", 1, 1, 64, SSHS_FLAGS_NORMAL,
+		"Number of threads filtering large packets in parallel, each on its own horizontal tile of the pixel array. "
+			"Results are identical to serial filtering, which is used when set to 1.");
 }
 
 static bool caerBackgroundActivityFilterInit(caerModuleData moduleData) {
@@ -67,7 +123,8 @@ static bool caerBackgroundActivityFilterInit(caerModuleData moduleData) {
 	int16_t sizeX = sshsNodeGetShort(sourceInfo, "polaritySizeX");
 	int16_t sizeY = sshsNodeGetShort(sourceInfo, "polaritySizeY");
 
-	state->timestampMap = simple2DBufferInitLong((size_t) sizeX, (size_t) sizeY);
+	// One element of border around the map, so neighbours can always be written.
+	state->timestampMap = simple2DMapInitLong((size_t) sizeX, (size_t) sizeY, 1);
 	if (state->timestampMap == NULL) {
 		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for timestampMap.");
 		return (false);
@@ -96,6 +153,19 @@ static void caerBackgroundActivityFilterRun(caerModuleData moduleData, caerEvent
 
 	BAFilterState state = moduleData->moduleState;
 
+	if (state->tiles.tilesNumber > 1
+		&& caerEventPacketHeaderGetEventValid(&polarity->packetHeader) >= BAF_TILES_MIN_EVENTS) {
+		filterTiled(state, polarity);
+	}
+	else {
+		filterSerial(state, polarity);
+	}
+}
+
+static void filterSerial(BAFilterState state, caerPolarityEventPacket polarity) {
+	int64_t *timestampMap = state->timestampMap->map;
+	size_t stride = state->timestampMap->stride;
+
 	// Iterate over events and filter out ones that are not supported by other
 	// events within a certain region in the specified timeframe.
 	CAER_POLARITY_ITERATOR_VALID_START(polarity)
@@ -109,45 +179,320 @@ static void caerBackgroundActivityFilterRun(caerModuleData moduleData, caerEvent
 		y = U16T(y >> state->subSampleBy);
 
 		// Get value from map.
-		int64_t lastTS = state->timestampMap->buffer2d[x][y];
+		int64_t *center = timestampMap + ((size_t) y * stride) + x;
+		int64_t lastTS = *center;
 
 		if ((I64T(ts - lastTS) >= I64T(state->deltaT)) || (lastTS == 0)) {
 			// Filter out invalid.
 			caerPolarityEventInvalidate(caerPolarityIteratorElement, polarity);
 		}
 
-		// Update neighboring region.
-		size_t sizeMaxX = (state->timestampMap->sizeX - 1);
-		size_t sizeMaxY = (state->timestampMap->sizeY - 1);
+		// Update neighboring region. Writes that fall outside the
+		// map go to its border, which is never read.
+		updateNeighbourhood(center, stride, ts);
+	}
+}
 
-		if (x > 0) {
-			state->timestampMap->buffer2d[x - 1][y] = ts;
+/**
+ * Filter a packet in parallel, with the pixel array split into horizontal tiles
+ * of whole rows. Every tile goes through all events in packet order, but only
+ * decides on events in its own rows and only writes its own rows of the map.
+ * Events in the row just above and just below a tile (its halo) are still used
+ * to update the tile's border rows. So each map element sees exactly the same
+ * sequence of reads and writes as with serial filtering, and the results are
+ * identical. Rows are cache-line aligned, so tiles never share cache-lines.
+ *
+ * Invalidating also updates the packet header, so the decisions are collected
+ * per event first, and then applied here once all tiles are done.
+ *
+ * @param state module state.
+ * @param polarity the polarity packet to filter in-place.
+ */
+static void filterTiled(BAFilterState state, caerPolarityEventPacket polarity) {
+	struct BAFilter_tiles *tiles = &state->tiles;
+
+	size_t eventsNumber = (size_t) caerEventPacketHeaderGetEventNumber(&polarity->packetHeader);
+
+	if (eventsNumber > tiles->invalidateSize) {
+		uint8_t *newInvalidate = realloc(tiles->invalidate, eventsNumber * sizeof(uint8_t));
+		if (newInvalidate == NULL) {
+			// Not fatal, serial filtering gives the same results.
+			filterSerial(state, polarity);
+			return;
 		}
-		if (x < sizeMaxX) {
-			state->timestampMap->buffer2d[x + 1][y] = ts;
+
+		tiles->invalidate = newInvalidate;
+		tiles->invalidateSize = eventsNumber;
+	}
+
+	// Wake up the workers, and do the first tile ourselves meanwhile.
+	mtx_lock(&tiles->lock);
+
+	tiles->packet = polarity;
+	tiles->packetGeneration++;
+	tiles->workersPending = tiles->tilesNumber - 1;
+
+	cnd_broadcast(&tiles->packetAvailable);
+
+	mtx_unlock(&tiles->lock);
+
+	filterTile(state, polarity, 0);
+
+	mtx_lock(&tiles->lock);
+
+	while (tiles->workersPending > 0) {
+		cnd_wait(&tiles->packetDone, &tiles->lock);
+	}
+
+	tiles->packet = NULL;
+
+	mtx_unlock(&tiles->lock);
+
+	// All events valid at the start have a decision now.
+	CAER_POLARITY_ITERATOR_VALID_START(polarity)
+		if (tiles->invalidate[caerPolarityIteratorCounter]) {
+			caerPolarityEventInvalidate(caerPolarityIteratorElement, polarity);
+		}
+	}
+}
+
+static void filterTile(BAFilterState state, caerPolarityEventPacket polarity, size_t tile) {
+	int64_t *timestampMap = state->timestampMap->map;
+	size_t stride = state->timestampMap->stride;
+	uint8_t *invalidate = state->tiles.invalidate;
+
+	// Split only the rows that can actually be hit after sub-sampling.
+	size_t rows = ((state->timestampMap->sizeY - 1) >> state->subSampleBy) + 1;
+	size_t rowStart = (tile * rows) / state->tiles.tilesNumber;
+	size_t rowEnd = ((tile + 1) * rows) / state->tiles.tilesNumber;
+
+	if (rowStart == rowEnd) {
+		// More tiles than rows, nothing to do for this one.
+		return;
+	}
+
+	CAER_POLARITY_ITERATOR_VALID_START(polarity)
+		uint16_t y = U16T(caerPolarityEventGetY(caerPolarityIteratorElement) >> state->subSampleBy);
+
+		// Skip events that are neither in this tile nor in its halo.
+		if (((size_t) y + 1) < rowStart || (size_t) y > rowEnd) {
+			continue;
+		}
+
+		int64_t ts = caerPolarityEventGetTimestamp64(caerPolarityIteratorElement, polarity);
+		uint16_t x = U16T(caerPolarityEventGetX(caerPolarityIteratorElement) >> state->subSampleBy);
+
+		int64_t *center = timestampMap + ((size_t) y * stride) + x;
+
+		if (y < rowStart) {
+			// Halo above: only its row below is in this tile.
+			updateNeighbourRow(center + stride - 1, ts);
+		}
+		else if (y >= rowEnd) {
+			// Halo below: only its row above is in this tile.
+			updateNeighbourRow(center - stride - 1, ts);
+		}
+		else {
+			int64_t lastTS = *center;
+
+			invalidate[caerPolarityIteratorCounter] = ((I64T(ts - lastTS) >= I64T(state->deltaT)) || (lastTS == 0));
+
+			if (y > rowStart) {
+				updateNeighbourRow(center - stride - 1, ts);
+			}
+
+			center[-1] = ts;
+			center[1] = ts;
+
+			// The last tile also owns the row after the last one, which is only
+			// part of the map when sub-sampling, and must be kept up-to-date too.
+			if (((size_t) y + 1) < rowEnd || tile == (state->tiles.tilesNumber - 1)) {
+				updateNeighbourRow(center + stride - 1, ts);
+			}
+		}
+	}
+}
+
+static bool tilesStart(caerModuleData moduleData, size_t tilesNumber) {
+	BAFilterState state = moduleData->moduleState;
+	struct BAFilter_tiles *tiles = &state->tiles;
+
+	tiles->workers = calloc(tilesNumber - 1, sizeof(struct BAFilter_tile_worker));
+	if (tiles->workers == NULL) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate tile workers memory, filtering serially.");
+		return (false);
+	}
+
+	if (mtx_init(&tiles->lock, mtx_plain) != thrd_success) {
+		free(tiles->workers);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize tile workers lock, filtering serially.");
+		return (false);
+	}
+
+	if (cnd_init(&tiles->packetAvailable) != thrd_success) {
+		mtx_destroy(&tiles->lock);
+		free(tiles->workers);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize tile workers condition, filtering serially.");
+		return (false);
+	}
+
+	if (cnd_init(&tiles->packetDone) != thrd_success) {
+		cnd_destroy(&tiles->packetAvailable);
+		mtx_destroy(&tiles->lock);
+		free(tiles->workers);
+
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to initialize tile workers condition, filtering serially.");
+		return (false);
+	}
+
+	tiles->shutdown = false;
+	tiles->packetGeneration = 0;
+	tiles->workersPending = 0;
+	tiles->packet = NULL;
+
+	// Tiles are assigned to threads statically, so all must be running.
+	size_t started = 0;
+
+	for (; started < (tilesNumber - 1); started++) {
+		tiles->workers[started].state = state;
+		tiles->workers[started].tile = started + 1;
+
+		if (thrd_create(&tiles->workers[started].thread, &tileWorkerThread, &tiles->workers[started])
+			!= thrd_success) {
+			break;
 		}
+	}
+
+	if (started < (tilesNumber - 1)) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to start tile worker thread %zu, filtering serially.",
+			started);
 
-		if (y > 0) {
-			state->timestampMap->buffer2d[x][y - 1] = ts;
+		if (started > 0) {
+			// Stop and join the ones already running, this also frees everything.
+			tiles->tilesNumber = started + 1;
+			tilesStop(moduleData);
 		}
-		if (y < sizeMaxY) {
-			state->timestampMap->buffer2d[x][y + 1] = ts;
+		else {
+			cnd_destroy(&tiles->packetDone);
+			cnd_destroy(&tiles->packetAvailable);
+			mtx_destroy(&tiles->lock);
+			free(tiles->workers);
+			tiles->workers = NULL;
 		}
 
-		if (x > 0 && y > 0) {
-			state->timestampMap->buffer2d[x - 1][y - 1] = ts;
+		return (false);
+	}
+
+	tiles->tilesNumber = tilesNumber;
+
+	return (true);
+}
+
+static void tilesStop(caerModuleData moduleData) {
+	BAFilterState state = moduleData->moduleState;
+	struct BAFilter_tiles *tiles = &state->tiles;
+
+	if (tiles->tilesNumber <= 1) {
+		return;
+	}
+
+	mtx_lock(&tiles->lock);
+	tiles->shutdown = true;
+	cnd_broadcast(&tiles->packetAvailable);
+	mtx_unlock(&tiles->lock);
+
+	for (size_t i = 0; i < (tiles->tilesNumber - 1); i++) {
+		if ((errno = thrd_join(tiles->workers[i].thread, NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Failed to join tile worker thread. Error: %d.", errno);
 		}
-		if (x < sizeMaxX && y < sizeMaxY) {
-			state->timestampMap->buffer2d[x + 1][y + 1] = ts;
+	}
+
+	tiles->tilesNumber = 1;
+
+	cnd_destroy(&tiles->packetDone);
+	cnd_destroy(&tiles->packetAvailable);
+	mtx_destroy(&tiles->lock);
+	free(tiles->workers);
+	tiles->workers = NULL;
+}
+
+static int tileWorkerThread(void *workerArg) {
+	struct BAFilter_tile_worker *worker = workerArg;
+	struct BAFilter_tiles *tiles = &worker->state->tiles;
+
+	thrd_set_name("BAFilter[Tile Worker]");
+
+	uint64_t lastGeneration = 0;
+
+	mtx_lock(&tiles->lock);
+
+	while (true) {
+		while (tiles->packetGeneration == lastGeneration && !tiles->shutdown) {
+			cnd_wait(&tiles->packetAvailable, &tiles->lock);
 		}
 
-		if (x > 0 && y < sizeMaxY) {
-			state->timestampMap->buffer2d[x - 1][y + 1] = ts;
+		if (tiles->shutdown) {
+			break;
 		}
-		if (x < sizeMaxX && y > 0) {
-			state->timestampMap->buffer2d[x + 1][y - 1] = ts;
+
+		lastGeneration = tiles->packetGeneration;
+		caerPolarityEventPacket polarity = tiles->packet;
+
+		mtx_unlock(&tiles->lock);
+
+		// The mainloop thread waits for all workers, so the packet and the
+		// map can't change while we filter.
+		filterTile(worker->state, polarity, worker->tile);
+
+		mtx_lock(&tiles->lock);
+
+		tiles->workersPending--;
+		if (tiles->workersPending == 0) {
+			cnd_signal(&tiles->packetDone);
 		}
 	}
+
+	mtx_unlock(&tiles->lock);
+
+	return (thrd_success);
+}
+
+/**
+ * Write a timestamp to the eight neighbours of an element, but not to
+ * the element itself, as an event must not support itself.
+ * The rows above and below are covered by two overlapping two-element
+ * stores each, instead of three single ones.
+ */
+static inline void updateNeighbourhood(int64_t *center, size_t stride, int64_t ts) {
+	updateNeighbourRow(center - stride - 1, ts);
+	updateNeighbourRow(center + stride - 1, ts);
+
+	center[-1] = ts;
+	center[1] = ts;
+}
+
+/**
+ * Write a timestamp to three consecutive elements of a row.
+ */
+static inline void updateNeighbourRow(int64_t *left, int64_t ts) {
+#if defined(__SSE2__)
+	__m128i tsPair = _mm_set1_epi64x(ts);
+
+	_mm_storeu_si128((__m128i *) left, tsPair);
+	_mm_storeu_si128((__m128i *) (left + 1), tsPair);
+#elif defined(__ARM_NEON)
+	int64x2_t tsPair = vdupq_n_s64(ts);
+
+	vst1q_s64(left, tsPair);
+	vst1q_s64(left + 1, tsPair);
+#else
+	left[0] = ts;
+	left[1] = ts;
+	left[2] = ts;
+#endif
 }
 
 static void caerBackgroundActivityFilterConfig(caerModuleData moduleData) {
@@ -157,6 +502,18 @@ static void caerBackgroundActivityFilterConfig(caerModuleData moduleData) {
 
 	state->deltaT = sshsNodeGetInt(moduleData->moduleNode, "deltaT");
 	state->subSampleBy = sshsNodeGetByte(moduleData->moduleNode, "subSampleBy");
+
+	// Only restart the tile workers if their number actually changed.
+	size_t tilesNumber = (size_t) sshsNodeGetInt(moduleData->moduleNode, "tileThreads");
+	size_t currentTilesNumber = (state->tiles.tilesNumber > 1) ? (state->tiles.tilesNumber) : (1);
+
+	if (tilesNumber != currentTilesNumber) {
+		tilesStop(moduleData);
+
+		if (tilesNumber > 1) {
+			tilesStart(moduleData, tilesNumber);
+		}
+	}
 }
 
 static void caerBackgroundActivityFilterExit(caerModuleData moduleData) {
@@ -165,8 +522,15 @@ static void caerBackgroundActivityFilterExit(caerModuleData moduleData) {
 
 	BAFilterState state = moduleData->moduleState;
 
+	// Stop tile workers before freeing what they use.
+	tilesStop(moduleData);
+
+	free(state->tiles.invalidate);
+	state->tiles.invalidate = NULL;
+	state->tiles.invalidateSize = 0;
+
 	// Ensure map is freed.
-	simple2DBufferFreeLong(state->timestampMap);
+	simple2DMapFreeLong(state->timestampMap);
 }
 
 static void caerBackgroundActivityFilterReset(caerModuleData moduleData, int16_t resetCallSourceID) {
@@ -175,5 +539,5 @@ static void caerBackgroundActivityFilterReset(caerModuleData moduleData, int16_t
 	BAFilterState state = moduleData->moduleState;
 
 	// Reset timestamp map to all zeros (startup state).
-	simple2DBufferResetLong(state->timestampMap);
+	simple2DMapResetLong(state->timestampMap);
 }
@@ -45,9 +45,26 @@ static bool caerInputFileInit(caerModuleData moduleData) {
 	}
 
 	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened input file '%s' successfully for reading.", filePath);
+
+	// Open the packet index file, if present: same path, with index suffix.
+	// It's loaded fully during initialization, so we can close it right after.
+	size_t indexPathLength = strlen(filePath) + strlen(AEDAT3_INDEX_FILE_SUFFIX) + 1; // +1 for NUL.
+	char indexPath[indexPathLength];
+	snprintf(indexPath, indexPathLength, "%s%s", filePath, AEDAT3_INDEX_FILE_SUFFIX);
+
+	inputCommonState state = moduleData->moduleState;
+	state->indexFileDescriptor = open(indexPath, O_RDONLY);
+
 	free(filePath);
 
-	if (!caerInputCommonInit(moduleData, fileFd, false, false)) {
+	bool initSuccess = caerInputCommonInit(moduleData, fileFd, false, false);
+
+	if (state->indexFileDescriptor >= 0) {
+		close(state->indexFileDescriptor);
+		state->indexFileDescriptor = -1;
+	}
+
+	if (!initSuccess) {
 		close(fileFd);
 
 		return (false);
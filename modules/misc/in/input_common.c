@@ -1,13 +1,25 @@
 #include "input_common.h"
 #include "base/mainloop.h"
+#include "base/trace.h"
 #include "ext/portable_time.h"
 #include "ext/uthash/utlist.h"
 #include "ext/nets.h"
 
+#if defined(OS_UNIX) && OS_UNIX == 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <poll.h>
+#endif
+
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 #include <png.h>
 #endif
 
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+#include <lz4.h>
+#endif
+
 #include <stdatomic.h>
 #include <libcaer/events/common.h>
 #include <libcaer/events/packetContainer.h>
@@ -16,6 +28,10 @@
 #include <libcaer/events/frame.h>
 
 #define MAX_HEADER_LINE_SIZE 1024
+#define MAPPING_WINDOW_SIZE (8 * 1024 * 1024) // Parse memory-mapped files in 8MB steps.
+#define SHM_MAX_SPIN_COUNT 1000 // Yield this many times waiting for shared-memory data, before sleeping.
+#define MAX_DATAGRAM_SIZE (AEDAT3_NETWORK_HEADER_LENGTH + AEDAT3_MAX_UDP_SIZE)
+#define REAL_TIME_SLEEP_SLICE 100000 // Sleep at most 100ms at once in real-time playback, in µs.
 
 enum input_reader_state {
 	READER_OK = 0,
@@ -26,6 +42,17 @@ enum input_reader_state {
 };
 
 static bool newInputBuffer(inputCommonState state);
+static bool mapInputFile(inputCommonState state);
+static void loadPacketIndex(inputCommonState state);
+static void seekToTimestamp(inputCommonState state, int64_t timestamp);
+static void unmapInputFile(inputCommonState state);
+static ssize_t nextSharedMemoryData(inputCommonState state);
+static bool newMessageBuffers(inputCommonState state);
+static void freeMessageBuffers(inputCommonState state);
+static void updateMessageStatistics(inputCommonState state);
+static ssize_t nextNetworkMessage(inputCommonState state);
+static void discardPartialPacket(inputCommonState state);
+static ssize_t nextInputData(inputCommonState state);
 static bool parseNetworkHeader(inputCommonState state);
 static char *getFileHeaderLine(inputCommonState state);
 static void parseSourceString(char *sourceString, inputCommonState state);
@@ -40,11 +67,18 @@ static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader
 static int inputReaderThread(void *stateArg);
 
 static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader newPacket, packetData newPacketData);
+static caerEventPacketHeader appendEventPacket(caerEventPacketHeader packet, caerEventPacketHeader appendPacket);
 static caerEventPacketContainer generatePacketContainer(inputCommonState state, bool forceFlush);
 static void commitPacketContainer(inputCommonState state, bool forceFlush);
+static void doPlaybackDelay(inputCommonState state, int64_t containerTimestamp, bool timeCommit);
+static bool updatePlaybackConfig(inputCommonState state);
 static void doTimeDelay(inputCommonState state);
+static void doRealTimeDelay(inputCommonState state, int64_t containerTimestamp);
+static void updatePlaybackStatistics(inputCommonState state);
+static enum input_common_playback_mode parsePlaybackMode(const char *playbackMode);
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force);
 static bool handleTSReset(inputCommonState state);
+static caerEventPacketHeader allocateTSResetPacket(inputCommonState state, int32_t tsOverflow);
 static void getPacketInfo(caerEventPacketHeader packet, packetData packetInfoData);
 static int inputAssemblerThread(void *stateArg);
 
@@ -89,10 +123,507 @@ static bool newInputBuffer(inputCommonState state) {
 	return (true);
 }
 
+/**
+ * Map the whole input file into memory, so that the data can be parsed
+ * directly from the page cache, instead of being first copied into the
+ * data buffer by read(). Packets are still assembled into their own memory,
+ * as they are modified (source ID, decompression) and handed on to other
+ * modules, but this removes one full copy of all the data.
+ *
+ * @param state common input data structure.
+ *
+ * @return true if the file was mapped, false if the data buffer has to be used.
+ */
+static bool mapInputFile(inputCommonState state) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	struct stat fileStat;
+
+	if (fstat(state->fileDescriptor, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0) {
+		// Not a regular file or empty, nothing to map.
+		return (false);
+	}
+
+	if ((uintmax_t) fileStat.st_size > SIZE_MAX) {
+		// File doesn't fit into address space.
+		return (false);
+	}
+
+	void *mapping = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, state->fileDescriptor, 0);
+	if (mapping == MAP_FAILED) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+			"Failed to memory-map input file, using buffered reads. Error: %d.", errno);
+		return (false);
+	}
+
+	// We only ever go through the file once, front to back: enable aggressive read-ahead.
+	madvise(mapping, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+
+	state->dataMapping = mapping;
+	state->dataMappingSize = (size_t) fileStat.st_size;
+
+	return (true);
+#else
+	UNUSED_ARGUMENT(state);
+
+	return (false);
+#endif
+}
+
+static void unmapInputFile(inputCommonState state) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	if (state->dataMapping != NULL) {
+		munmap(state->dataMapping, state->dataMappingSize);
+
+		state->dataMapping = NULL;
+		state->dataMappingSize = 0;
+	}
+#else
+	UNUSED_ARGUMENT(state);
+#endif
+}
+
+/**
+ * Get the next chunk of data to parse from the shared-memory ring, directly
+ * in place. All data handed out previously has been fully parsed by now, so
+ * its space is released to the writer first. The network header comes first,
+ * then the data from where the reader attached, up to the end of the ring
+ * at most (wrap-around data comes with the next call).
+ *
+ * @param state common input data structure.
+ *
+ * @return size of the new data in bytes, 0 if the writer went away.
+ */
+static ssize_t nextSharedMemoryData(inputCommonState state) {
+	struct aedat3_shm_ring *ring = state->sharedMemory;
+	struct aedat3_shm_reader *reader = &ring->readers[state->sharedMemoryReader];
+
+	atomic_store_explicit(&reader->readPosition, state->sharedMemoryPosition, memory_order_release);
+
+	size_t spinCount = 0;
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		// Check writer presence first: it publishes all its data before going away.
+		bool writerActive = atomic_load_explicit(&ring->writerActive, memory_order_acquire);
+
+		if (!state->header.isValidHeader) {
+			if (atomic_load_explicit(&ring->headerValid, memory_order_acquire)) {
+				state->dataView.data = ring->networkHeader;
+				state->dataView.size = AEDAT3_NETWORK_HEADER_LENGTH;
+				state->dataView.position = 0;
+
+				return (AEDAT3_NETWORK_HEADER_LENGTH);
+			}
+		}
+		else {
+			uint64_t writePosition = atomic_load_explicit(&ring->writePosition, memory_order_acquire);
+
+			if (writePosition != state->sharedMemoryPosition) {
+				size_t dataOffset = (size_t) (state->sharedMemoryPosition % ring->dataSize);
+				size_t dataSize = (size_t) (writePosition - state->sharedMemoryPosition);
+
+				if (dataSize > (ring->dataSize - dataOffset)) {
+					dataSize = (size_t) (ring->dataSize - dataOffset);
+				}
+
+				state->dataView.data = ring->data + dataOffset;
+				state->dataView.size = dataSize;
+				state->dataView.position = 0;
+
+				state->sharedMemoryPosition += dataSize;
+
+				return ((ssize_t) dataSize);
+			}
+		}
+
+		if (!writerActive) {
+			return (0);
+		}
+
+		// Poll for new data: spin a little first for lowest latency, then sleep for 100 µs.
+		if (spinCount < SHM_MAX_SPIN_COUNT) {
+			spinCount++;
+			thrd_yield();
+		}
+		else {
+			struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 100000 };
+			thrd_sleep(&noDataSleep, NULL);
+		}
+	}
+
+	return (0);
+}
+
+static bool newMessageBuffers(inputCommonState state) {
+	struct input_common_message_data *messages = &state->messages;
+
+	messages->window = calloc(messages->windowSize, sizeof(struct input_common_datagram));
+	if (messages->window == NULL) {
+		return (false);
+	}
+
+	// One buffer per window slot, plus one to receive into and one being parsed.
+	for (size_t i = 0; i < messages->windowSize; i++) {
+		messages->window[i].data = malloc(MAX_DATAGRAM_SIZE);
+		if (messages->window[i].data == NULL) {
+			freeMessageBuffers(state);
+			return (false);
+		}
+	}
+
+	messages->receiveBuffer = malloc(MAX_DATAGRAM_SIZE);
+	messages->parseBuffer = malloc(MAX_DATAGRAM_SIZE);
+	if (messages->receiveBuffer == NULL || messages->parseBuffer == NULL) {
+		freeMessageBuffers(state);
+		return (false);
+	}
+
+	return (true);
+}
+
+static void freeMessageBuffers(inputCommonState state) {
+	struct input_common_message_data *messages = &state->messages;
+
+	if (messages->window != NULL) {
+		for (size_t i = 0; i < messages->windowSize; i++) {
+			free(messages->window[i].data);
+		}
+
+		free(messages->window);
+		messages->window = NULL;
+	}
+
+	free(messages->receiveBuffer);
+	messages->receiveBuffer = NULL;
+	free(messages->parseBuffer);
+	messages->parseBuffer = NULL;
+}
+
+static void updateMessageStatistics(inputCommonState state) {
+	struct input_common_message_data *messages = &state->messages;
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - messages->statisticsTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - messages->statisticsTime.tv_nsec) / 1000;
+
+	// Update once per second.
+	if (elapsedTime < 1000000) {
+		return;
+	}
+
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "datagramsLost", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = I64T(messages->datagramsLost) });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "datagramsReordered", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = I64T(messages->datagramsReordered) });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "datagramsDropped", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = I64T(messages->datagramsDropped) });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "senderRestarts", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = I64T(messages->senderRestarts) });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "reorderLatencyMax", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = messages->latencyMax });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "reorderLatencyAverage", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = (messages->latencyCount == 0) ?
+			(0) : (messages->latencySum / I64T(messages->latencyCount)) });
+
+	messages->latencyMax = 0;
+	messages->latencySum = 0;
+	messages->latencyCount = 0;
+	messages->statisticsTime = currentTime;
+}
+
+static void clearMessageWindow(struct input_common_message_data *messages) {
+	for (size_t i = 0; i < messages->windowSize; i++) {
+		messages->window[i].valid = false;
+	}
+
+	messages->windowUsed = 0;
+}
+
+/**
+ * Get the next datagram to parse from a message-based network stream.
+ * Datagrams are placed into a reorder window by their sequence number, and
+ * handed out strictly in order. A missing datagram is waited for until the
+ * oldest datagram in the window exceeds the maximum latency, or the window
+ * fills up; then it is declared lost, any partially parsed packet is dropped
+ * and parsing resumes with the next datagram that starts a new packet.
+ * A sender restart, seen as sequence numbers jumping back by more than the
+ * window size, is handled the same way.
+ *
+ * @param state common input data structure.
+ *
+ * @return size of the new data in bytes, 0 on shutdown, negative on error.
+ */
+static ssize_t nextNetworkMessage(inputCommonState state) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+	struct input_common_message_data *messages = &state->messages;
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		updateMessageStatistics(state);
+
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		// Hand out the next datagram in order, if it's here.
+		struct input_common_datagram *next = &messages->window[(size_t) messages->nextSequenceNumber
+			% messages->windowSize];
+
+		if (messages->synchronized && next->valid && next->sequenceNumber == messages->nextSequenceNumber) {
+			next->valid = false;
+			messages->windowUsed--;
+			messages->nextSequenceNumber++;
+
+			int64_t latency = I64T(currentTime.tv_sec - next->arrivalTime.tv_sec) * 1000000LL
+				+ I64T(currentTime.tv_nsec - next->arrivalTime.tv_nsec) / 1000;
+
+			if (latency > messages->latencyMax) {
+				messages->latencyMax = latency;
+			}
+			messages->latencySum += latency;
+			messages->latencyCount++;
+
+			// After a loss, only a new packet can be parsed again.
+			if (messages->resync) {
+				if (!next->packetStart) {
+					messages->datagramsDropped++;
+					continue;
+				}
+
+				messages->resync = false;
+			}
+
+			// Swap buffers, the window slot can be reused while we parse.
+			uint8_t *datagram = next->data;
+			next->data = messages->parseBuffer;
+			messages->parseBuffer = datagram;
+
+			// The very first datagram still has its network header parsed
+			// by parseHeader(), for all others we skip over it.
+			state->dataView.data = datagram;
+			state->dataView.size = next->size;
+			state->dataView.position = (state->header.isValidHeader) ? (AEDAT3_NETWORK_HEADER_LENGTH) : (0);
+
+			return ((ssize_t) next->size);
+		}
+
+		// Something is missing. Find out how long the oldest datagram waited for it.
+		int64_t oldestLatency = 0;
+
+		for (size_t i = 0; i < messages->windowSize && messages->windowUsed > 0; i++) {
+			if (messages->window[i].valid) {
+				int64_t latency = I64T(currentTime.tv_sec - messages->window[i].arrivalTime.tv_sec) * 1000000LL
+					+ I64T(currentTime.tv_nsec - messages->window[i].arrivalTime.tv_nsec) / 1000;
+
+				if (latency > oldestLatency) {
+					oldestLatency = latency;
+				}
+			}
+		}
+
+		// Give up on the missing datagram, if waiting any longer doesn't make sense.
+		if (messages->windowUsed > 0
+			&& (oldestLatency >= messages->maxLatency || messages->windowUsed == messages->windowSize)) {
+			messages->nextSequenceNumber++;
+			messages->datagramsLost++;
+
+			messages->resync = true;
+			discardPartialPacket(state);
+
+			continue;
+		}
+
+		// Wait for new data, but not longer than the remaining latency budget.
+		int timeout = 100;
+
+		if (messages->windowUsed > 0) {
+			timeout = (int) ((messages->maxLatency - oldestLatency + 999) / 1000);
+		}
+
+		struct pollfd pollSocket = { .fd = state->fileDescriptor, .events = POLLIN, .revents = 0 };
+
+		int pollResult = poll(&pollSocket, 1, timeout);
+		if (pollResult < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return (-1);
+		}
+		else if (pollResult == 0) {
+			// Timeout, check again.
+			continue;
+		}
+
+		ssize_t result = recv(state->fileDescriptor, messages->receiveBuffer, MAX_DATAGRAM_SIZE, 0);
+		if (result < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+				continue;
+			}
+
+			return (-1);
+		}
+
+		portable_clock_gettime_monotonic(&currentTime);
+
+		// Only valid AEDAT 3.1 datagrams with some data make sense.
+		if ((size_t) result <= AEDAT3_NETWORK_HEADER_LENGTH) {
+			messages->datagramsDropped++;
+			continue;
+		}
+
+		struct aedat3_network_header networkHeader = caerParseNetworkHeader(messages->receiveBuffer);
+
+		if (networkHeader.magicNumber != AEDAT3_NETWORK_MAGIC_NUMBER) {
+			messages->datagramsDropped++;
+			continue;
+		}
+
+		bool packetStart = (networkHeader.sequenceNumber < 0);
+		int64_t sequenceNumber = networkHeader.sequenceNumber & I64T(0x7FFFFFFFFFFFFFFFLL);
+
+		// Far behind what was already handed out: the sender restarted, and its
+		// sequence numbers started over. Nothing waiting belongs to the new stream,
+		// so synchronize again on its first datagram that starts a new packet.
+		if (messages->synchronized
+			&& sequenceNumber < (messages->nextSequenceNumber - I64T(messages->windowSize))) {
+			messages->senderRestarts++;
+
+			clearMessageWindow(messages);
+			messages->synchronized = false;
+
+			messages->resync = true;
+			discardPartialPacket(state);
+		}
+
+		// Start with the first datagram that starts a new packet.
+		if (!messages->synchronized) {
+			if (!packetStart) {
+				messages->datagramsDropped++;
+				continue;
+			}
+
+			messages->synchronized = true;
+			messages->nextSequenceNumber = sequenceNumber;
+			messages->highestSequenceNumber = sequenceNumber;
+		}
+
+		// Already handed out or declared lost: duplicate or too late.
+		if (sequenceNumber < messages->nextSequenceNumber) {
+			messages->datagramsDropped++;
+			continue;
+		}
+
+		// Too far ahead to fit into the window: a lot was lost.
+		// Give up on everything in between and continue from here.
+		if (sequenceNumber >= (messages->nextSequenceNumber + I64T(messages->windowSize))) {
+			messages->datagramsLost += U64T(sequenceNumber - messages->nextSequenceNumber);
+
+			clearMessageWindow(messages);
+			messages->nextSequenceNumber = sequenceNumber;
+			messages->highestSequenceNumber = sequenceNumber;
+
+			messages->resync = true;
+			discardPartialPacket(state);
+		}
+
+		struct input_common_datagram *slot = &messages->window[(size_t) sequenceNumber % messages->windowSize];
+
+		if (slot->valid) {
+			messages->datagramsDropped++;
+			continue;
+		}
+
+		if (sequenceNumber < messages->highestSequenceNumber) {
+			messages->datagramsReordered++;
+		}
+		else {
+			messages->highestSequenceNumber = sequenceNumber;
+		}
+
+		// Swap buffers, slot now holds the received datagram.
+		uint8_t *datagram = messages->receiveBuffer;
+		messages->receiveBuffer = slot->data;
+		slot->data = datagram;
+
+		slot->size = (size_t) result;
+		slot->valid = true;
+		slot->packetStart = packetStart;
+		slot->sequenceNumber = sequenceNumber;
+		slot->arrivalTime = currentTime;
+
+		messages->windowUsed++;
+	}
+
+	return (0);
+#else
+	UNUSED_ARGUMENT(state);
+
+	return (-1);
+#endif
+}
+
+/**
+ * Drop the packet currently being parsed, so that parsing can continue at
+ * a new packet boundary, after a seek or lost data.
+ *
+ * @param state common input data structure.
+ */
+static void discardPartialPacket(inputCommonState state) {
+	caerMainloopPacketRelease(state->packets.currPacket);
+	state->packets.currPacket = NULL;
+	free(state->packets.currPacketData);
+	state->packets.currPacketData = NULL;
+	state->packets.currPacketHeaderSize = 0;
+	state->packets.skipSize = 0;
+}
+
+/**
+ * Get the next chunk of data to parse into the data view, either
+ * by reading into the data buffer, or by moving the window over the
+ * memory-mapped file or shared-memory ring forward.
+ *
+ * @param state common input data structure.
+ *
+ * @return size of the new data in bytes, 0 on EOF, negative on error.
+ */
+static ssize_t nextInputData(inputCommonState state) {
+	if (state->sharedMemory != NULL) {
+		return (nextSharedMemoryData(state));
+	}
+
+	if (state->isNetworkMessageBased) {
+		return (nextNetworkMessage(state));
+	}
+
+	if (state->dataMapping != NULL) {
+		size_t remainingData = state->dataMappingSize - state->dataBufferOffset;
+		size_t windowSize = (remainingData < MAPPING_WINDOW_SIZE) ? (remainingData) : (MAPPING_WINDOW_SIZE);
+
+		state->dataView.data = state->dataMapping + state->dataBufferOffset;
+		state->dataView.size = windowSize;
+		state->dataView.position = 0;
+
+		return ((ssize_t) windowSize);
+	}
+
+	// Read data from disk or socket.
+	ssize_t result = readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+	if (result <= 0) {
+		return (result);
+	}
+
+	// Go and parse the full buffer, starting at position 0.
+	state->dataView.data = state->dataBuffer->buffer;
+	state->dataView.size = (size_t) result;
+	state->dataView.position = 0;
+
+	return (result);
+}
+
 static bool parseNetworkHeader(inputCommonState state) {
 	// Network header is 20 bytes long. Use struct to interpret.
-	struct aedat3_network_header networkHeader = caerParseNetworkHeader(state->dataBuffer->buffer);
-	state->dataBuffer->bufferPosition += AEDAT3_NETWORK_HEADER_LENGTH;
+	struct aedat3_network_header networkHeader = caerParseNetworkHeader(state->dataView.data);
+	state->dataView.position += AEDAT3_NETWORK_HEADER_LENGTH;
 
 	// Check header values.
 	if (networkHeader.magicNumber != AEDAT3_NETWORK_MAGIC_NUMBER) {
@@ -104,9 +635,9 @@ static bool parseNetworkHeader(inputCommonState state) {
 	state->header.majorVersion = 3;
 
 	if (state->isNetworkMessageBased) {
-		// For message based streams, use the sequence number.
-		// TODO: Network: check this for missing packets in message mode!
-		state->header.networkSequenceNumber = networkHeader.sequenceNumber;
+		// For message based streams, use the sequence number. Missing datagrams
+		// are detected and reordered on reception, see nextNetworkMessage().
+		state->header.networkSequenceNumber = networkHeader.sequenceNumber & I64T(0x7FFFFFFFFFFFFFFFLL);
 	}
 	else {
 		// For stream based transports, this is always zero.
@@ -153,9 +684,9 @@ static bool parseNetworkHeader(inputCommonState state) {
 }
 
 static char *getFileHeaderLine(inputCommonState state) {
-	simpleBuffer buf = state->dataBuffer;
+	inputCommonDataView view = &state->dataView;
 
-	if (buf->buffer[buf->bufferPosition] == '#') {
+	if (view->position < view->size && view->data[view->position] == '#') {
 		size_t headerLinePos = 0;
 		char *headerLine = malloc(MAX_HEADER_LINE_SIZE);
 		if (headerLine == NULL) {
@@ -164,22 +695,28 @@ static char *getFileHeaderLine(inputCommonState state) {
 		}
 
 		headerLine[headerLinePos++] = '#';
-		buf->bufferPosition++;
+		view->position++;
 
-		while (buf->buffer[buf->bufferPosition] != '\n') {
+		while (view->position < view->size && view->data[view->position] != '\n') {
 			if (headerLinePos >= (MAX_HEADER_LINE_SIZE - 2)) { // -1 for terminating new-line, -1 for end NUL char.
 				// Overlong header line, refuse it.
 				free(headerLine);
 				return (NULL);
 			}
 
-			headerLine[headerLinePos++] = (char) buf->buffer[buf->bufferPosition];
-			buf->bufferPosition++;
+			headerLine[headerLinePos++] = (char) view->data[view->position];
+			view->position++;
+		}
+
+		if (view->position >= view->size) {
+			// Data ends in the middle of the header line.
+			free(headerLine);
+			return (NULL);
 		}
 
 		// Found terminating new-line character.
 		headerLine[headerLinePos++] = '\n';
-		buf->bufferPosition++;
+		view->position++;
 
 		// Now let's just verify that the previous character was indeed a carriage-return.
 		if (headerLine[headerLinePos - 2] == '\r') {
@@ -330,6 +867,13 @@ static bool parseFileHeader(inputCommonState state) {
 	while (!endHeader) {
 		char *headerLine = getFileHeaderLine(state);
 		if (headerLine == NULL) {
+			// Data ended before the header did, this is never a valid header.
+			if (state->dataView.position >= state->dataView.size) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+					"Header not terminated before end of data. Invalid file.");
+				return (false);
+			}
+
 			// Failed to parse header line; this is an invalid header for AEDAT 3.1!
 			// For AEDAT 2.0 and 3.0, since there is no END-HEADER, this might be
 			// the right way for headers to stop, so we consider this valid IFF we
@@ -415,6 +959,10 @@ static bool parseFileHeader(inputCommonState state) {
 						state->header.formatID |= 0x02;
 					}
 
+					if (strstr(formatString, "LZ4") != NULL) {
+						state->header.formatID |= 0x04;
+					}
+
 					if (!state->header.formatID) {
 						// No valid format found.
 						free(headerLine);
@@ -511,7 +1059,8 @@ static bool parseFileHeader(inputCommonState state) {
 		free(headerLine);
 	}
 
-	// Parsed AEDAT 3.1 header successfully.
+	// Parsed AEDAT 3.1 header successfully. Packets start right after it.
+	state->dataStartOffset = state->dataBufferOffset + state->dataView.position;
 	state->header.isValidHeader = true;
 	return (true);
 }
@@ -526,7 +1075,7 @@ static bool parseHeader(inputCommonState state) {
 }
 
 static bool parseData(inputCommonState state) {
-	while (state->dataBuffer->bufferPosition < state->dataBuffer->bufferUsedSize) {
+	while (state->dataView.position < state->dataView.size) {
 		int pRes = -1;
 
 		// Try getting packet and packetData from buffer.
@@ -586,6 +1135,9 @@ static bool parseData(inputCommonState state) {
 			thrd_sleep(&retrySleep, NULL);
 		}
 
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_PUT, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_INPUT_PACKETS);
+
 		state->packets.currPacket = NULL;
 	}
 
@@ -634,7 +1186,7 @@ static int aedat2GetPacket(inputCommonState state, int16_t chipID) {
  * -2 on decompression failure.
  */
 static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
-	simpleBuffer buf = state->dataBuffer;
+	inputCommonDataView view = &state->dataView;
 
 	// So now we're somewhere inside the buffer (usually at start), and want to
 	// read in a very long sequence of event packets.
@@ -643,7 +1195,7 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 	// the next event packet boundary is. So we get the full header first, then
 	// the data, but careful, it can all be split across two (header+data) or
 	// more (data) buffers, so we need to reassemble!
-	size_t remainingData = buf->bufferUsedSize - buf->bufferPosition;
+	size_t remainingData = view->size - view->position;
 
 	// First thing, handle skip packet requests. This can happen if packets
 	// from another source are mixed in, or we forbid some packet types.
@@ -654,11 +1206,11 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 			state->packets.skipSize -= remainingData;
 
 			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
+			view->position += remainingData;
 			return (1);
 		}
 		else {
-			buf->bufferPosition += state->packets.skipSize;
+			view->position += state->packets.skipSize;
 			remainingData -= state->packets.skipSize;
 			state->packets.skipSize = 0; // Don't skip anymore, continue as usual.
 		}
@@ -668,12 +1220,12 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 	if (state->packets.currPacketHeaderSize != CAER_EVENT_PACKET_HEADER_SIZE) {
 		if (remainingData < CAER_EVENT_PACKET_HEADER_SIZE) {
 			// Reaching end of buffer, the header is split across two buffers!
-			memcpy(state->packets.currPacketHeader, buf->buffer + buf->bufferPosition, remainingData);
+			memcpy(state->packets.currPacketHeader, view->data + view->position, remainingData);
 
 			state->packets.currPacketHeaderSize = remainingData;
 
 			// Go and get next buffer. bufferPosition is at end of buffer.
-			buf->bufferPosition += remainingData;
+			view->position += remainingData;
 			return (1);
 		}
 		else {
@@ -681,10 +1233,10 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 			size_t dataToRead = CAER_EVENT_PACKET_HEADER_SIZE - state->packets.currPacketHeaderSize;
 
 			memcpy(state->packets.currPacketHeader + state->packets.currPacketHeaderSize,
-				buf->buffer + buf->bufferPosition, dataToRead);
+				view->data + view->position, dataToRead);
 
 			state->packets.currPacketHeaderSize += dataToRead;
-			buf->bufferPosition += dataToRead;
+			view->position += dataToRead;
 			remainingData -= dataToRead;
 		}
 
@@ -699,6 +1251,33 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 		int32_t eventValid = caerEventPacketHeaderGetEventValid(packet);
 		int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
 
+		// The header comes from a file, a network peer or shared memory, so it can't be trusted:
+		// the events must fit in memory, and compressed data must fit into the space of the
+		// decompressed events, as that's all that gets allocated for the packet.
+		bool validEvents = (eventNumber >= 0 && eventSize > 0
+			&& (size_t) eventNumber <= ((SIZE_MAX - CAER_EVENT_PACKET_HEADER_SIZE) / (size_t) eventSize));
+		size_t eventsSize = (validEvents) ? ((size_t) eventNumber * (size_t) eventSize) : (0);
+
+		if (!validEvents || eventNumber == 0 || eventValid < 0 || eventValid > eventNumber
+			|| (isCompressed && (eventCapacity < 0 || (size_t) eventCapacity > eventsSize))) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Invalid event packet header (type %" PRIi16 ", capacity %" PRIi32 ", number %" PRIi32 ", "
+				"valid %" PRIi32 ", size %" PRIi32 "). Discarding event packet.", eventType, eventCapacity,
+				eventNumber, eventValid, eventSize);
+
+			// Without a usable length, the start of the next packet can't be found anymore.
+			if ((isCompressed && eventCapacity < 0) || (!isCompressed && !validEvents)) {
+				return (-2);
+			}
+
+			// Skip packet. If packet is compressed, eventCapacity carries the size.
+			state->packets.skipSize = (isCompressed) ? ((size_t) eventCapacity) : (eventsSize);
+			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
+
+			// Run function again to skip data. bufferPosition is already up-to-date.
+			return (2);
+		}
+
 		// First we verify that the source ID remained unique (only one source per I/O module supported!).
 		if (state->header.sourceID != eventSource) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
@@ -707,7 +1286,7 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 				"Discarding event packet.", eventSource, state->header.sourceID);
 
 			// Skip packet. If packet is compressed, eventCapacity carries the size.
-			state->packets.skipSize = (isCompressed) ? (size_t) (eventCapacity) : (size_t) (eventNumber * eventSize);
+			state->packets.skipSize = (isCompressed) ? ((size_t) eventCapacity) : (eventsSize);
 			state->packets.currPacketHeaderSize = 0; // Get new header after skipping.
 
 			// Run function again to skip data. bufferPosition is already up-to-date.
@@ -715,11 +1294,21 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 		}
 
 		// If packet is compressed, eventCapacity carries the size in bytes to read.
-		state->packets.currPacketDataSize =
-			(isCompressed) ? (size_t) (eventCapacity) : (size_t) (eventNumber * eventSize);
+		state->packets.currPacketDataSize = (isCompressed) ? ((size_t) eventCapacity) : (eventsSize);
+
+		// A memory-mapped file is all there is: a packet reaching past its end is truncated.
+		if (state->dataMapping != NULL
+			&& state->packets.currPacketDataSize
+				> (state->dataMappingSize - state->dataBufferOffset - view->position)) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+				"Event packet of %zu bytes goes past the end of the file. Truncated or corrupted file.",
+				state->packets.currPacketDataSize);
+			return (-2);
+		}
 
 		// Allocate space for the full packet, so we can reassemble it (and decompress it later).
-		state->packets.currPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t) (eventNumber * eventSize));
+		// Memory is recycled from packets the mainloop is done with, if possible.
+		state->packets.currPacket = caerMainloopPacketAllocate(CAER_EVENT_PACKET_HEADER_SIZE + eventsSize);
 		if (state->packets.currPacket == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for new event packet.");
 			return (-1);
@@ -733,18 +1322,20 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 		// Rewrite event source to reflect this module, not the original one.
 		caerEventPacketHeaderSetEventSource(state->packets.currPacket, I16T(state->parentModule->moduleID));
 
-		// If packet was compressed, restore original eventType and eventCapacity,
-		// for in-memory usage (no mark bit, eventCapacity == eventNumber).
+		// If packet was compressed, restore original eventType (no mark bit).
 		if (isCompressed) {
 			state->packets.currPacket->eventType = htole16(
 				le16toh(state->packets.currPacket->eventType) & I16T(0x7FFF));
-			state->packets.currPacket->eventCapacity = htole32(eventNumber);
 		}
 
+		// Only eventNumber events were allocated, whatever capacity the sender had,
+		// or carried the compressed size in it, so always set eventCapacity == eventNumber.
+		state->packets.currPacket->eventCapacity = htole32(eventNumber);
+
 		// Now we can also start keeping track of this packet's meta-data.
 		state->packets.currPacketData = calloc(1, sizeof(struct input_packet_data));
 		if (state->packets.currPacketData == NULL) {
-			free(state->packets.currPacket);
+			caerMainloopPacketRelease(state->packets.currPacket);
 			state->packets.currPacket = NULL;
 
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
@@ -756,7 +1347,7 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 		state->packets.currPacketData->id = state->packets.packetCount++;
 		state->packets.currPacketData->offset =
 			(state->isNetworkStream) ?
-				(0) : (state->dataBufferOffset + buf->bufferPosition - CAER_EVENT_PACKET_HEADER_SIZE);
+				(0) : (state->dataBufferOffset + view->position - CAER_EVENT_PACKET_HEADER_SIZE);
 		state->packets.currPacketData->size = CAER_EVENT_PACKET_HEADER_SIZE + state->packets.currPacketDataSize;
 		state->packets.currPacketData->isCompressed = isCompressed;
 		state->packets.currPacketData->eventType = caerEventPacketHeaderGetEventType(state->packets.currPacket);
@@ -772,29 +1363,29 @@ static int aedat3GetPacket(inputCommonState state, bool isAEDAT30) {
 	if (state->packets.currPacketDataSize > remainingData) {
 		// We need to copy more data than in this buffer.
 		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
-			buf->buffer + buf->bufferPosition, remainingData);
+			view->data + view->position, remainingData);
 
 		state->packets.currPacketDataOffset += remainingData;
 		state->packets.currPacketDataSize -= remainingData;
 
 		// Go and get next buffer. bufferPosition is at end of buffer.
-		buf->bufferPosition += remainingData;
+		view->position += remainingData;
 		return (1);
 	}
 	else {
 		// We copy the last bytes of data and we're done.
 		memcpy(((uint8_t *) state->packets.currPacket) + state->packets.currPacketDataOffset,
-			buf->buffer + buf->bufferPosition, state->packets.currPacketDataSize);
+			view->data + view->position, state->packets.currPacketDataSize);
 
 		// This packet is fully copied and done, so reset variables for next iteration.
 		state->packets.currPacketHeaderSize = 0; // Get new header next iteration.
-		buf->bufferPosition += state->packets.currPacketDataSize;
+		view->position += state->packets.currPacketDataSize;
 
 		// Decompress packet.
 		if (state->packets.currPacketData->isCompressed) {
 			if (!decompressEventPacket(state, state->packets.currPacket, state->packets.currPacketData->size)) {
 				// Failed to decompress packet. Error exit.
-				free(state->packets.currPacket);
+				caerMainloopPacketRelease(state->packets.currPacket);
 				state->packets.currPacket = NULL;
 				free(state->packets.currPacketData);
 				state->packets.currPacketData = NULL;
@@ -1064,6 +1655,40 @@ static bool decompressFramePNG(inputCommonState state, caerEventPacketHeader pac
 
 #endif
 
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+
+static bool decompressPacketLZ4(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	// The packet memory is already large enough for the full decompressed data, as it was allocated
+	// according to the number and size of events. LZ4 can't decompress in-place, so we copy the
+	// compressed block out first, and then decompress it into its final position.
+	size_t compressedSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+	size_t dataSize = (size_t) caerEventPacketHeaderGetEventNumber(packet)
+		* (size_t) caerEventPacketHeaderGetEventSize(packet);
+
+	char *inBuffer = malloc(compressedSize);
+	if (inBuffer == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for LZ4 decompression.");
+		return (false);
+	}
+
+	char *data = ((char *) packet) + CAER_EVENT_PACKET_HEADER_SIZE;
+	memcpy(inBuffer, data, compressedSize);
+
+	int outSize = LZ4_decompress_safe(inBuffer, data, (int) compressedSize, (int) dataSize);
+
+	free(inBuffer);
+
+	if (outSize < 0 || (size_t) outSize != dataSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to decompress LZ4 packet, expected %zu bytes, got %d.", dataSize, outSize);
+		return (false);
+	}
+
+	return (true);
+}
+
+#endif
+
 static bool decompressTimestampSerialize(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
 	// To decompress this, we have to allocate memory to hold the expanded events. There is
 	// no efficient way to avoid this; working backwards from the last compressed event might
@@ -1075,7 +1700,18 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
 	int32_t eventTSOffset = caerEventPacketHeaderGetEventTSOffset(packet);
 
-	uint8_t *events = malloc((size_t) (eventNumber * eventSize));
+	// Timestamps are 4 bytes at the end of each event.
+	if (eventTSOffset < 0 || (eventTSOffset + I32T(sizeof(int32_t))) > eventSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
+			"Invalid timestamp offset %" PRIi32 ".", eventTSOffset);
+		return (false);
+	}
+
+	// The compressed data can't be trusted, so no copy may go past either of these.
+	size_t eventsSize = (size_t) eventNumber * (size_t) eventSize;
+	size_t eventSizeBytes = (size_t) eventSize;
+
+	uint8_t *events = malloc(eventsSize);
 	if (events == NULL) {
 		// Memory allocation failure.
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
@@ -1088,10 +1724,21 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 	size_t recoveredEventsNumber = 0;
 
 	while (currPacketOffset < packetSize) {
+		if ((packetSize - currPacketOffset) < eventSizeBytes
+			|| (eventsSize - recoveredEventsPosition) < eventSizeBytes) {
+			break;
+		}
+
 		void *firstEvent = ((uint8_t *) packet) + currPacketOffset;
 		int32_t currTS = caerGenericEventGetTimestamp(firstEvent, packet);
 
 		if (currTS & I32T(0x80000000)) {
+			// A run has at least two full events.
+			if ((packetSize - currPacketOffset) < (2 * eventSizeBytes)
+				|| (eventsSize - recoveredEventsPosition) < (2 * eventSizeBytes)) {
+				break;
+			}
+
 			// Compressed run starts here! Must clear the compression bit from
 			// this first timestamp and restore the timestamp to the others.
 			// So first we clean the timestamp.
@@ -1122,6 +1769,11 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 			// timestamp. We do this by copying the data and then adding the timestamp,
 			// which is always the last in an event.
 			while (tsRun > 0) {
+				if ((packetSize - currPacketOffset) < (size_t) eventTSOffset
+					|| (eventsSize - recoveredEventsPosition) < eventSizeBytes) {
+					break;
+				}
+
 				void *thirdEvent = ((uint8_t *) packet) + currPacketOffset;
 				memcpy(events + recoveredEventsPosition, thirdEvent, (size_t) eventTSOffset);
 
@@ -1136,6 +1788,11 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 				recoveredEventsNumber++;
 				tsRun--;
 			}
+
+			if (tsRun > 0) {
+				// Run doesn't fit, the checks below fail.
+				break;
+			}
 		}
 		else {
 			// Normal event, nothing compressed.
@@ -1150,18 +1807,24 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 
 	// Check we really recovered all events from compression.
 	if (currPacketOffset != packetSize) {
+		free(events);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
 			"Length of compressed packet and read data don't match.");
 		return (false);
 	}
 
-	if ((size_t) (eventNumber * eventSize) != recoveredEventsPosition) {
+	if (eventsSize != recoveredEventsPosition) {
+		free(events);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
 			"Length of uncompressed packet and uncompressed data don't match.");
 		return (false);
 	}
 
 	if ((size_t) eventNumber != recoveredEventsNumber) {
+		free(events);
+
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to decode serialized timestamp. "
 			"Number of expected and recovered events don't match.");
 		return (false);
@@ -1177,15 +1840,25 @@ static bool decompressTimestampSerialize(inputCommonState state, caerEventPacket
 
 static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
 	bool retVal = false;
+	int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+	bool fastCompression = ((state->header.formatID & 0x04)
+		&& (eventType == POLARITY_EVENT || eventType == FRAME_EVENT));
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	// Data compression technique 3: fast LZ4 compression, takes precedence for polarity and frames.
+	if (fastCompression) {
+		retVal = decompressPacketLZ4(state, packet, packetSize);
+	}
+#endif
 
 	// Data compression technique 1: serialized timestamps.
-	if ((state->header.formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+	if (!fastCompression && (state->header.formatID & 0x01) && eventType == POLARITY_EVENT) {
 		retVal = decompressTimestampSerialize(state, packet, packetSize);
 	}
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 	// Data compression technique 2: frame PNG compression.
-	if ((state->header.formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+	if (!fastCompression && (state->header.formatID & 0x02) && eventType == FRAME_EVENT) {
 		retVal = decompressFramePNG(state, packet, packetSize);
 	}
 #endif
@@ -1193,6 +1866,135 @@ static bool decompressEventPacket(inputCommonState state, caerEventPacketHeader
 	return (retVal);
 }
 
+/**
+ * Load the packet index of the input file, if any, which maps each packet's
+ * first timestamp to its position in the file, for fast seeking.
+ *
+ * @param state common input data structure.
+ */
+static void loadPacketIndex(inputCommonState state) {
+	off_t indexFileSize = lseek(state->indexFileDescriptor, 0, SEEK_END);
+	if (indexFileSize < 0 || lseek(state->indexFileDescriptor, 0, SEEK_SET) < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to get packet index size. Error: %d.", errno);
+		return;
+	}
+
+	size_t indexSize = (size_t) indexFileSize / sizeof(struct aedat3_index_entry);
+	if (indexSize == 0) {
+		return;
+	}
+
+	struct aedat3_index_entry *index = malloc(indexSize * sizeof(struct aedat3_index_entry));
+	if (index == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for packet index.");
+		return;
+	}
+
+	ssize_t result = readUntilDone(state->indexFileDescriptor, (uint8_t *) index,
+		indexSize * sizeof(struct aedat3_index_entry));
+	if (result != (ssize_t) (indexSize * sizeof(struct aedat3_index_entry))) {
+		free(index);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to read packet index. Error: %d.", errno);
+		return;
+	}
+
+	for (size_t i = 0; i < indexSize; i++) {
+		index[i].firstTimestamp = le64toh(index[i].firstTimestamp);
+		index[i].packetOffset = le64toh(index[i].packetOffset);
+		index[i].eventNumber = le32toh(index[i].eventNumber);
+		index[i].eventType = le16toh(index[i].eventType);
+
+		// Binary search needs monotonic timestamps, which timestamp resets break.
+		if (i > 0 && index[i].firstTimestamp < index[i - 1].firstTimestamp) {
+			free(index);
+
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Packet index timestamps are not monotonic (timestamp reset in recording?), seeking disabled.");
+			return;
+		}
+	}
+
+	state->packetIndex = index;
+	state->packetIndexSize = indexSize;
+
+	caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Loaded packet index with %zu entries.", indexSize);
+}
+
+/**
+ * Continue reading from the packet containing the given timestamp, found with
+ * a binary search over the packet index instead of parsing the file up to it.
+ * Reading restarts at the last packet starting at or before the timestamp, so
+ * some earlier events may be included. A timestamp reset is sent on first, so
+ * that both the assembler and all following modules start a new timeline.
+ *
+ * @param state common input data structure.
+ * @param timestamp the timestamp to seek to, in µs.
+ */
+static void seekToTimestamp(inputCommonState state, int64_t timestamp) {
+	if (state->packetIndex == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_WARNING, "Cannot seek, no packet index available.");
+		return;
+	}
+
+	// Find the first packet starting after the timestamp, the one before is the one we want.
+	size_t low = 0;
+	size_t high = state->packetIndexSize;
+
+	while (low < high) {
+		size_t mid = low + ((high - low) / 2);
+
+		if (state->packetIndex[mid].firstTimestamp <= timestamp) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	size_t seekIndex = (low > 0) ? (low - 1) : (0);
+	size_t seekOffset = state->dataStartOffset + (size_t) state->packetIndex[seekIndex].packetOffset;
+
+	if (state->dataMapping != NULL) {
+		if (seekOffset >= state->dataMappingSize) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Packet index points past end of file.");
+			return;
+		}
+	}
+	else if (lseek(state->fileDescriptor, (off_t) seekOffset, SEEK_SET) < 0) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to seek in input file. Error: %d.", errno);
+		return;
+	}
+
+	state->dataBufferOffset = seekOffset;
+
+	// Discard any partially parsed packet, we continue at a packet boundary.
+	discardPartialPacket(state);
+
+	// The timestamp reset uses the highest possible timestamp, so the assembler never
+	// considers it out of order, independent of where we were before.
+	caerEventPacketHeader tsResetPacket = allocateTSResetPacket(state, INT32_MAX);
+	if (tsResetPacket == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate seek tsReset special event packet.");
+		return;
+	}
+
+	while (!caerRingBufferPut(state->transferRingPackets, tsResetPacket)) {
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			caerMainloopPacketRelease(tsResetPacket);
+			return;
+		}
+
+		// Delay by 10 µs if no change, to avoid a wasteful busy loop.
+		struct timespec retrySleep = { .tv_sec = 0, .tv_nsec = 10000 };
+		thrd_sleep(&retrySleep, NULL);
+	}
+
+	caerModuleLog(state->parentModule, CAER_LOG_INFO,
+		"Seeking to timestamp %" PRIi64 ": continuing from packet %zu (timestamp %" PRIi64 ").", timestamp,
+		seekIndex, state->packetIndex[seekIndex].firstTimestamp);
+}
+
 static int inputReaderThread(void *stateArg) {
 	inputCommonState state = stateArg;
 
@@ -1211,17 +2013,24 @@ static int inputReaderThread(void *stateArg) {
 
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
 		// Handle configuration changes affecting buffer management.
+		// Memory-mapped files, shared memory and datagrams don't use the data buffer at all.
 		if (atomic_load_explicit(&state->bufferUpdate, memory_order_relaxed)) {
 			atomic_store(&state->bufferUpdate, false);
 
-			if (!newInputBuffer(state)) {
+			if (state->dataMapping == NULL && state->sharedMemory == NULL && !state->isNetworkMessageBased
+				&& !newInputBuffer(state)) {
 				caerModuleLog(state->parentModule, CAER_LOG_ERROR,
 					"Failed to allocate new input data buffer. Continue using old one.");
 			}
 		}
 
-		// Read data from disk or socket.
-		ssize_t result = readUntilDone(state->fileDescriptor, state->dataBuffer->buffer, state->dataBuffer->bufferSize);
+		// Handle seek requests. Offsets are only known once the header has been parsed.
+		if (state->header.isValidHeader && atomic_exchange(&state->seekRequest, false)) {
+			seekToTimestamp(state, atomic_load(&state->seekTimestamp));
+		}
+
+		// Get new data to parse.
+		ssize_t result = nextInputData(state);
 		if (result <= 0) {
 			// Error or EOF with no data. Let's just stop at this point.
 			close(state->fileDescriptor);
@@ -1238,7 +2047,6 @@ static int inputReaderThread(void *stateArg) {
 			}
 			break;
 		}
-		state->dataBuffer->bufferUsedSize = (size_t) result;
 
 		// Parse header and setup header info structure.
 		if (!state->header.isValidHeader && !parseHeader(state)) {
@@ -1257,12 +2065,22 @@ static int inputReaderThread(void *stateArg) {
 			break;
 		}
 
-		// Go and get a full buffer on next iteration again, starting at position 0.
-		state->dataBuffer->bufferPosition = 0;
+#if defined(OS_UNIX) && OS_UNIX == 1
+		// All data in this window has been copied into packets, so its pages
+		// can be dropped, to not keep the whole file resident. After a seek, the
+		// window may not start on a page boundary anymore, so align it down.
+		if (state->dataMapping != NULL) {
+			uintptr_t pageMask = (uintptr_t) sysconf(_SC_PAGESIZE) - 1;
+			uintptr_t windowStart = (uintptr_t) state->dataView.data & ~pageMask;
+
+			madvise((void *) windowStart, state->dataView.size + ((uintptr_t) state->dataView.data - windowStart),
+				MADV_DONTNEED);
+		}
+#endif
 
 		// Update offset. Makes sense for files only.
 		if (!state->isNetworkStream) {
-			state->dataBufferOffset += state->dataBuffer->bufferUsedSize;
+			state->dataBufferOffset += state->dataView.size;
 		}
 	}
 
@@ -1288,6 +2106,38 @@ static inline void updateSizeCommitCriteria(inputCommonState state, caerEventPac
 	}
 }
 
+/**
+ * Append the events of one packet to another, same as caerEventPacketAppend(), but
+ * growing the packet through the mainloop's packet pool, which owns its memory.
+ * Both packets must have the same type, event size and timestamp overflow.
+ *
+ * @param packet packet to append to. Invalid after a successful call.
+ * @param appendPacket packet whose events are appended. Not changed.
+ *
+ * @return the merged packet, or NULL on memory allocation failure (packet is unchanged).
+ */
+static caerEventPacketHeader appendEventPacket(caerEventPacketHeader packet, caerEventPacketHeader appendPacket) {
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+	int32_t appendEventNumber = caerEventPacketHeaderGetEventNumber(appendPacket);
+
+	caerEventPacketHeader mergedPacket = caerMainloopPacketResize(packet,
+	CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) (eventNumber + appendEventNumber) * (size_t) eventSize));
+	if (mergedPacket == NULL) {
+		return (NULL);
+	}
+
+	memcpy(((uint8_t *) mergedPacket) + CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) eventNumber * (size_t) eventSize),
+		((uint8_t *) appendPacket) + CAER_EVENT_PACKET_HEADER_SIZE, (size_t) appendEventNumber * (size_t) eventSize);
+
+	caerEventPacketHeaderSetEventCapacity(mergedPacket, eventNumber + appendEventNumber);
+	caerEventPacketHeaderSetEventNumber(mergedPacket, eventNumber + appendEventNumber);
+	caerEventPacketHeaderSetEventValid(mergedPacket,
+		caerEventPacketHeaderGetEventValid(mergedPacket) + caerEventPacketHeaderGetEventValid(appendPacket));
+
+	return (mergedPacket);
+}
+
 /**
  * Add the given packet to a packet container that acts as accumulator. This way all
  * events are in a common place, from which the right event amounts/times can be sliced.
@@ -1321,7 +2171,7 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 		// Merge newPacket with '*packet'. Since packets from the same source,
 		// and having the same time, are guaranteed to have monotonic timestamps,
 		// the merge operation becomes a simple append operation.
-		caerEventPacketHeader mergedPacket = caerEventPacketAppend(*packet, newPacket);
+		caerEventPacketHeader mergedPacket = appendEventPacket(*packet, newPacket);
 		if (mergedPacket == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR,
 				"%s: Failed to allocate memory for packet merge operation.", __func__);
@@ -1330,7 +2180,7 @@ static bool addToPacketContainer(inputCommonState state, caerEventPacketHeader n
 
 		// Merged content with existing packet, data copied: free new one.
 		// Update references to old/new packets to point to merged one.
-		free(newPacket);
+		caerMainloopPacketRelease(newPacket);
 		*packet = mergedPacket;
 		newPacket = mergedPacket;
 	}
@@ -1418,7 +2268,7 @@ static caerEventPacketContainer generatePacketContainer(inputCommonState state,
 			// Allocate a new packet, with space for the remaining events that we don't send off
 			// (the ones after cutoff point).
 			int32_t nextPacketEventNumber = currPacketEventNumber - cutoffIndex;
-			caerEventPacketHeader nextPacket = malloc(
+			caerEventPacketHeader nextPacket = caerMainloopPacketAllocate(
 			CAER_EVENT_PACKET_HEADER_SIZE + (size_t) (currPacketEventSize * nextPacketEventNumber));
 			if (nextPacket == NULL) {
 				caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
@@ -1437,13 +2287,13 @@ static caerEventPacketContainer generatePacketContainer(inputCommonState state,
 			}
 
 			// Resize current packet to include only the events up until cutoff point.
-			caerEventPacketHeader currPacketResized = realloc(*currPacket,
+			caerEventPacketHeader currPacketResized = caerMainloopPacketResize(*currPacket,
 			CAER_EVENT_PACKET_HEADER_SIZE + (size_t) (currPacketEventSize * cutoffIndex));
 			if (currPacketResized == NULL) {
 				// This is unlikely to happen as we always shrink here!
 				caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
 					"Failed memory allocation for currPacketResized. Discarding current data.");
-				free(*currPacket);
+				caerMainloopPacketRelease(*currPacket);
 			}
 			else {
 				// Set header sizes for resized packet correctly.
@@ -1495,6 +2345,10 @@ static void commitPacketContainer(inputCommonState state, bool forceFlush) {
 		return;
 	}
 
+	// Remember up to which timestamp this container goes, to pace its commit.
+	int64_t containerTimestamp = (sizeCommit) ? (state->packetContainer.sizeLimitTimestamp) :
+		(state->packetContainer.newContainerTimestampEnd);
+
 	// Update wanted timestamp for next time slice.
 	// Only do this if size limit was not active, since size limit can only be active
 	// if the slice would (in time) be smaller than the time limit end, so the next run
@@ -1505,11 +2359,11 @@ static void commitPacketContainer(inputCommonState state, bool forceFlush) {
 	if (!sizeCommit && !forceFlush) {
 		state->packetContainer.newContainerTimestampEnd += I32T(
 			atomic_load_explicit(&state->packetContainer.timeSlice, memory_order_relaxed));
+	}
 
-		// Only do time delay operation if time is actually changing. On size hits or
-		// full flushes, this would slow down everything incorrectly as it would be an
-		// extra delay operation inside the same time window.
-		doTimeDelay(state);
+	// Full flushes happen at the end of a timeline, they are never delayed.
+	if (!forceFlush) {
+		doPlaybackDelay(state, containerTimestamp, !sizeCommit);
 	}
 
 	doPacketContainerCommit(state, packetContainer, atomic_load_explicit(&state->keepPackets, memory_order_relaxed));
@@ -1535,6 +2389,62 @@ static void commitPacketContainer(inputCommonState state, bool forceFlush) {
 	}
 }
 
+/**
+ * Delay the commit of a packet container according to the playback mode.
+ *
+ * @param state common input data structure.
+ * @param containerTimestamp timestamp up to which the container holds events.
+ * @param timeCommit true if the container ends because its time slice is complete,
+ *                   false if it ends early due to a size limit.
+ */
+static void doPlaybackDelay(inputCommonState state, int64_t containerTimestamp, bool timeCommit) {
+	if (updatePlaybackConfig(state)) {
+		state->playback.anchored = false;
+	}
+
+	switch (state->playback.mode) {
+		case PLAYBACK_FIXED_DELAY:
+			// Only do time delay operation if time is actually changing. On size hits,
+			// this would slow down everything incorrectly as it would be an extra delay
+			// operation inside the same time window.
+			if (timeCommit) {
+				doTimeDelay(state);
+			}
+			break;
+
+		case PLAYBACK_REAL_TIME:
+			doRealTimeDelay(state, containerTimestamp);
+			break;
+
+		case PLAYBACK_UNTHROTTLED:
+		default:
+			break;
+	}
+
+	updatePlaybackStatistics(state);
+}
+
+/**
+ * Apply changes to the playback mode and speed, if there were any.
+ *
+ * @param state common input data structure.
+ *
+ * @return true if the playback configuration was changed.
+ */
+static bool updatePlaybackConfig(inputCommonState state) {
+	if (!atomic_exchange(&state->playback.update, false)) {
+		return (false);
+	}
+
+	char *playbackMode = sshsNodeGetString(state->parentModule->moduleNode, "playbackMode");
+	state->playback.mode = parsePlaybackMode(playbackMode);
+	free(playbackMode);
+
+	state->playback.speed = (double) sshsNodeGetFloat(state->parentModule->moduleNode, "playbackSpeed");
+
+	return (true);
+}
+
 static void doTimeDelay(inputCommonState state) {
 	// Got packet container, delay it until user-defined time.
 	uint64_t timeDelay = U64T(atomic_load_explicit(&state->packetContainer.timeDelay, memory_order_relaxed));
@@ -1574,30 +2484,200 @@ static void doTimeDelay(inputCommonState state) {
 	}
 }
 
+/**
+ * Commit packet containers when the wall-clock time since the anchor matches the
+ * event time since the anchor, divided by the playback speed. As commit times are
+ * always calculated from the anchor, sleep inaccuracies and slow processing don't
+ * accumulate: late containers are committed right away, until playback catches up.
+ * How late each container is gets recorded as drift.
+ * Long waits are split into slices of at most REAL_TIME_SLEEP_SLICE µs, so that
+ * shutdown, pause and changes to the playback mode or speed are noticed quickly.
+ *
+ * @param state common input data structure.
+ * @param containerTimestamp timestamp up to which the container holds events.
+ */
+static void doRealTimeDelay(inputCommonState state, int64_t containerTimestamp) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	// New timeline, or time went backwards: this container is due right now.
+	if (!state->playback.anchored || containerTimestamp < state->playback.anchorTimestamp) {
+		state->playback.anchored = true;
+		state->playback.anchorTimestamp = containerTimestamp;
+		state->playback.anchorTime = currentTime;
+		return;
+	}
+
+	int64_t dueTime = (int64_t) ((double) (containerTimestamp - state->playback.anchorTimestamp)
+		/ state->playback.speed);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - state->playback.anchorTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - state->playback.anchorTime.tv_nsec) / 1000;
+
+	while (dueTime > elapsedTime) {
+		if (!atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			return;
+		}
+
+		if (atomic_load_explicit(&state->pause, memory_order_relaxed)) {
+			// Hold this container back while paused, then continue playback from it.
+			while (atomic_load_explicit(&state->pause, memory_order_relaxed)
+				&& atomic_load_explicit(&state->running, memory_order_relaxed)) {
+				struct timespec pauseSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
+				thrd_sleep(&pauseSleep, NULL);
+			}
+
+			state->playback.anchorTimestamp = containerTimestamp;
+			portable_clock_gettime_monotonic(&state->playback.anchorTime);
+			return;
+		}
+
+		double oldSpeed = state->playback.speed;
+
+		if (updatePlaybackConfig(state)) {
+			if (state->playback.mode != PLAYBACK_REAL_TIME) {
+				state->playback.anchored = false;
+				return;
+			}
+
+			// Re-anchor at the position reached so far, to continue from it at the new speed.
+			state->playback.anchorTimestamp += (int64_t) ((double) elapsedTime * oldSpeed);
+			state->playback.anchorTime = currentTime;
+
+			dueTime = (int64_t) ((double) (containerTimestamp - state->playback.anchorTimestamp)
+				/ state->playback.speed);
+			elapsedTime = 0;
+
+			continue;
+		}
+
+		// Sleep for the remaining time, in slices.
+		int64_t sleepTime = dueTime - elapsedTime;
+		if (sleepTime > REAL_TIME_SLEEP_SLICE) {
+			sleepTime = REAL_TIME_SLEEP_SLICE;
+		}
+
+		struct timespec delaySleep = { .tv_sec = sleepTime / 1000000, .tv_nsec = (sleepTime % 1000000) * 1000 };
+		thrd_sleep(&delaySleep, NULL);
+
+		portable_clock_gettime_monotonic(&currentTime);
+
+		elapsedTime = I64T(currentTime.tv_sec - state->playback.anchorTime.tv_sec) * 1000000LL
+			+ I64T(currentTime.tv_nsec - state->playback.anchorTime.tv_nsec) / 1000;
+	}
+
+	int64_t drift = elapsedTime - dueTime;
+
+	if (drift > state->playback.driftMax) {
+		state->playback.driftMax = drift;
+	}
+
+	state->playback.driftSum += drift;
+	state->playback.driftCount++;
+}
+
+static void updatePlaybackStatistics(inputCommonState state) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - state->playback.statisticsTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - state->playback.statisticsTime.tv_nsec) / 1000;
+
+	// Update once per second.
+	if (elapsedTime < 1000000) {
+		return;
+	}
+
+	int64_t driftAverage = (state->playback.driftCount == 0) ?
+		(0) : (state->playback.driftSum / state->playback.driftCount);
+
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "playbackDriftAverage", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = driftAverage });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "playbackDriftMax", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = state->playback.driftMax });
+
+	state->playback.driftMax = 0;
+	state->playback.driftSum = 0;
+	state->playback.driftCount = 0;
+	state->playback.statisticsTime = currentTime;
+}
+
+static enum input_common_playback_mode parsePlaybackMode(const char *playbackMode) {
+	if (caerStrEquals(playbackMode, "unthrottled")) {
+		return (PLAYBACK_UNTHROTTLED);
+	}
+	else if (caerStrEquals(playbackMode, "realTime")) {
+		return (PLAYBACK_REAL_TIME);
+	}
+	else {
+		return (PLAYBACK_FIXED_DELAY);
+	}
+}
+
 static void doPacketContainerCommit(inputCommonState state, caerEventPacketContainer packetContainer, bool force) {
 	// Could be that the packet container is empty of events. Don't commit empty containers.
 	if (caerEventPacketContainerGetEventsNumber(packetContainer) == 0) {
 		return;
 	}
 
+	caerTraceEvent(CAER_TRACE_CONTAINER_COMMIT, CAER_TRACE_BEGIN, state->parentModule->moduleID,
+		caerEventPacketContainerGetEventsNumber(packetContainer));
+
 	retry: if (!caerRingBufferPut(state->transferRingPacketContainers, packetContainer)) {
 		if (force && atomic_load_explicit(&state->running, memory_order_relaxed)) {
 			// Retry forever if requested, at least while the module is running.
 			goto retry;
 		}
 
-		caerEventPacketContainerFree(packetContainer);
+		caerMainloopPacketContainerRelease(packetContainer);
+
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_FULL, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_INPUT_CONTAINERS);
 
 		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
 			"Failed to put new packet container on transfer ring-buffer: full.");
 	}
 	else {
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_PUT, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_INPUT_CONTAINERS);
+
 		// Signal availability of new data to the mainloop on packet container commit.
 		atomic_fetch_add_explicit(&state->dataAvailableModule, 1, memory_order_release);
 		caerMainloopDataNotifyIncrease(NULL);
 
 		caerModuleLog(state->parentModule, CAER_LOG_DEBUG, "Submitted packet container successfully.");
 	}
+
+	caerTraceEvent(CAER_TRACE_CONTAINER_COMMIT, CAER_TRACE_END, state->parentModule->moduleID, 0);
+}
+
+/**
+ * Allocate a special event packet holding just a timestamp reset event. Like all
+ * packets this module hands out, it lives in the mainloop's packet pool memory.
+ *
+ * @param state common input data structure.
+ * @param tsOverflow timestamp overflow counter for the new packet.
+ *
+ * @return the new event packet, or NULL on memory allocation failure.
+ */
+static caerEventPacketHeader allocateTSResetPacket(inputCommonState state, int32_t tsOverflow) {
+	caerSpecialEventPacket tsResetPacket = caerSpecialEventPacketAllocate(1, I16T(state->parentModule->moduleID),
+		tsOverflow);
+	if (tsResetPacket == NULL) {
+		return (NULL);
+	}
+
+	// Create timestamp reset event.
+	caerSpecialEvent tsResetEvent = caerSpecialEventPacketGetEvent(tsResetPacket, 0);
+	caerSpecialEventSetTimestamp(tsResetEvent, INT32_MAX);
+	caerSpecialEventSetType(tsResetEvent, TIMESTAMP_RESET);
+	caerSpecialEventValidate(tsResetEvent, tsResetPacket);
+
+	caerEventPacketHeader poolPacket = caerMainloopPacketCopyOnlyEvents((caerEventPacketHeader) tsResetPacket);
+
+	free(tsResetPacket);
+
+	return (poolPacket);
 }
 
 static bool handleTSReset(inputCommonState state) {
@@ -1613,21 +2693,14 @@ static bool handleTSReset(inputCommonState state) {
 	}
 
 	// Allocate special packet just for this event.
-	caerSpecialEventPacket tsResetPacket = caerSpecialEventPacketAllocate(1, I16T(state->parentModule->moduleID),
-		state->packetContainer.lastTimestampOverflow);
+	caerEventPacketHeader tsResetPacket = allocateTSResetPacket(state, state->packetContainer.lastTimestampOverflow);
 	if (tsResetPacket == NULL) {
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Failed to allocate tsReset special event packet.");
 		return (false);
 	}
 
-	// Create timestamp reset event.
-	caerSpecialEvent tsResetEvent = caerSpecialEventPacketGetEvent(tsResetPacket, 0);
-	caerSpecialEventSetTimestamp(tsResetEvent, INT32_MAX);
-	caerSpecialEventSetType(tsResetEvent, TIMESTAMP_RESET);
-	caerSpecialEventValidate(tsResetEvent, tsResetPacket);
-
 	// Assign special packet to packet container.
-	caerEventPacketContainerSetEventPacket(tsResetContainer, SPECIAL_EVENT, (caerEventPacketHeader) tsResetPacket);
+	caerEventPacketContainerSetEventPacket(tsResetContainer, SPECIAL_EVENT, tsResetPacket);
 
 	// Guaranteed commit of timestamp reset container.
 	doPacketContainerCommit(state, tsResetContainer, true);
@@ -1681,6 +2754,9 @@ static int inputAssemblerThread(void *stateArg) {
 			struct timespec pauseSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
 			thrd_sleep(&pauseSleep, NULL);
 
+			// Real-time playback continues from where it was paused.
+			state->playback.anchored = false;
+
 			continue;
 		}
 
@@ -1701,6 +2777,9 @@ static int inputAssemblerThread(void *stateArg) {
 			continue;
 		}
 
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_GET, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_INPUT_PACKETS);
+
 		// If validOnly flag is enabled, clean the packets up here, removing all
 		// invalid events prior to the get info and merge steps.
 		if (atomic_load_explicit(&state->validOnly, memory_order_relaxed)) {
@@ -1715,7 +2794,7 @@ static int inputAssemblerThread(void *stateArg) {
 		// of each packet (the first timestamp) must be smaller or equal than next packet's.
 		if (currPacketData.startTimestamp < state->packetContainer.lastPacketTimestamp) {
 			// Discard non-compliant packets.
-			free(currPacket);
+			caerMainloopPacketRelease(currPacket);
 
 			caerModuleLog(state->parentModule, CAER_LOG_NOTICE, "Dropping packet due to incorrect timestamp order. "
 				"Order-relevant timestamp is %" PRIi64 ", but expected was at least %" PRIi64 ".",
@@ -1734,6 +2813,9 @@ static int inputAssemblerThread(void *stateArg) {
 				+ (atomic_load_explicit(&state->packetContainer.timeSlice, memory_order_relaxed) - 1);
 
 			portable_clock_gettime_monotonic(&state->packetContainer.lastCommitTime);
+
+			// New timeline, start real-time playback over.
+			state->playback.anchored = false;
 		}
 
 		// If it's a special packet, it might contain TIMESTAMP_RESET as event, which affects
@@ -1775,7 +2857,7 @@ static int inputAssemblerThread(void *stateArg) {
 
 		if (tsReset) {
 			// Current packet not used.
-			free(currPacket);
+			caerMainloopPacketRelease(currPacket);
 
 			// We don't merge the current packet, that should only contain the timestamp reset,
 			// but instead generate one to ensure that's the case. Also, all counters are reset.
@@ -1796,7 +2878,7 @@ static int inputAssemblerThread(void *stateArg) {
 		// We've got a full event packet, store it (merge with current).
 		if (!addToPacketContainer(state, currPacket, &currPacketData)) {
 			// Discard on merge failure.
-			free(currPacket);
+			caerMainloopPacketRelease(currPacket);
 
 			continue;
 		}
@@ -1849,6 +2931,12 @@ bool isNetworkMessageBased) {
 	state->isNetworkStream = isNetworkStream;
 	state->isNetworkMessageBased = isNetworkMessageBased;
 
+	// The packet index only exists for files, where indexFileDescriptor was
+	// already set by the file input module.
+	if (state->isNetworkStream) {
+		state->indexFileDescriptor = -1;
+	}
+
 	// Add auto-restart setting.
 	sshsNodeCreateBool(moduleData->moduleNode, "autoRestart", true, SSHS_FLAGS_NORMAL,
 		"Automatically restart module after shutdown.");
@@ -1869,7 +2957,20 @@ bool isNetworkMessageBased) {
 	sshsNodeCreateInt(moduleData->moduleNode, "PacketContainerInterval", 10000, 1, 120 * 1000 * 1000, SSHS_FLAGS_NORMAL,
 		"Time interval in µs, each sent EventPacketContainer will span this interval.");
 	sshsNodeCreateInt(moduleData->moduleNode, "PacketContainerDelay", 10000, 1, 120 * 1000 * 1000, SSHS_FLAGS_NORMAL,
-		"Time delay in µs between consecutive EventPacketContainers sent for processing.");
+		"Time delay in µs between consecutive EventPacketContainers sent for processing, in 'fixedDelay' mode.");
+
+	sshsNodeCreateString(moduleData->moduleNode, "playbackMode", "fixedDelay", 8, 11, SSHS_FLAGS_NORMAL,
+		"How to pace EventPacketContainers: 'fixedDelay' (use PacketContainerDelay), 'unthrottled' (as fast as "
+			"possible) or 'realTime' (follow event timestamps, times playbackSpeed).");
+	sshsNodeCreateFloat(moduleData->moduleNode, "playbackSpeed", 1.0f, 0.01f, 1000.0f, SSHS_FLAGS_NORMAL,
+		"Speed multiplier for 'realTime' playback, 2 is twice as fast as recorded.");
+
+	sshsNodeCreateLong(moduleData->moduleNode, "playbackDriftAverage", 0, INT64_MIN, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Average delay of EventPacketContainers relative to their timestamps in 'realTime' mode, in µs.");
+	sshsNodeCreateLong(moduleData->moduleNode, "playbackDriftMax", 0, INT64_MIN, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT,
+		"Maximum delay of EventPacketContainers relative to their timestamps in 'realTime' mode, in µs.");
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
 	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
@@ -1881,6 +2982,10 @@ bool isNetworkMessageBased) {
 	atomic_store(&state->packetContainer.timeSlice, sshsNodeGetInt(moduleData->moduleNode, "PacketContainerInterval"));
 	atomic_store(&state->packetContainer.timeDelay, sshsNodeGetInt(moduleData->moduleNode, "PacketContainerDelay"));
 
+	// Playback mode and speed are read by the assembler thread on first use.
+	atomic_store(&state->playback.update, true);
+	portable_clock_gettime_monotonic(&state->playback.statisticsTime);
+
 	// Initialize transfer ring-buffers. ringBufferSize only changes here at init time!
 	state->transferRingPackets = caerRingBufferInit((size_t) ringSize);
 	if (state->transferRingPackets == NULL) {
@@ -1895,8 +3000,55 @@ bool isNetworkMessageBased) {
 		return (false);
 	}
 
-	// Allocate data buffer. bufferSize is updated here.
-	if (!newInputBuffer(state)) {
+	// Files can be memory-mapped, in which case no data buffer is needed.
+	bool fileMapped = false;
+
+	if (!isNetworkStream) {
+		sshsNodeCreateBool(moduleData->moduleNode, "memoryMapped", true, SSHS_FLAGS_NORMAL,
+			"Parse file directly from a memory mapping, instead of reading it into a buffer (takes effect on restart).");
+
+		if (sshsNodeGetBool(moduleData->moduleNode, "memoryMapped")) {
+			fileMapped = mapInputFile(state);
+		}
+	}
+
+	// Message-based streams parse each datagram directly from its own buffer,
+	// after putting it in order.
+	if (isNetworkMessageBased) {
+		sshsNodeCreateInt(moduleData->moduleNode, "reorderWindow", 64, 1, 1024, SSHS_FLAGS_NORMAL,
+			"Number of datagrams to hold for reordering (takes effect on restart).");
+		sshsNodeCreateInt(moduleData->moduleNode, "reorderLatency", 5000, 0, 1000000, SSHS_FLAGS_NORMAL,
+			"Maximum time in µs to wait for a missing datagram, before declaring it lost (takes effect on restart).");
+
+		sshsNodeCreateLong(moduleData->moduleNode, "datagramsLost", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Datagrams that never arrived in time.");
+		sshsNodeCreateLong(moduleData->moduleNode, "datagramsReordered", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Datagrams that arrived out of order.");
+		sshsNodeCreateLong(moduleData->moduleNode, "datagramsDropped", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Datagrams discarded as invalid, duplicate or too late.");
+		sshsNodeCreateLong(moduleData->moduleNode, "senderRestarts", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Times the sender restarted its stream.");
+		sshsNodeCreateLong(moduleData->moduleNode, "reorderLatencyMax", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Highest time in µs a datagram waited for reordering.");
+		sshsNodeCreateLong(moduleData->moduleNode, "reorderLatencyAverage", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average time in µs a datagram waited for reordering.");
+
+		// reorderWindow and reorderLatency only change here at init time!
+		state->messages.windowSize = (size_t) sshsNodeGetInt(moduleData->moduleNode, "reorderWindow");
+		state->messages.maxLatency = sshsNodeGetInt(moduleData->moduleNode, "reorderLatency");
+
+		portable_clock_gettime_monotonic(&state->messages.statisticsTime);
+
+		if (!newMessageBuffers(state)) {
+			caerRingBufferFree(state->transferRingPackets);
+			caerRingBufferFree(state->transferRingPacketContainers);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate datagram reorder window.");
+			return (false);
+		}
+	}
+	// Otherwise allocate data buffer, unless parsing from shared memory. bufferSize is updated here.
+	else if (!fileMapped && state->sharedMemory == NULL && !newInputBuffer(state)) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 
@@ -1904,6 +3056,20 @@ bool isNetworkMessageBased) {
 		return (false);
 	}
 
+	// Files can have a packet index, to support seeking.
+	if (!isNetworkStream) {
+		sshsNodeCreateLong(moduleData->moduleNode, "seekTimestamp", 0, 0, INT64_MAX, SSHS_FLAGS_NORMAL,
+			"Timestamp in µs to seek to on 'seek', requires a packet index file.");
+		sshsNodeCreateBool(moduleData->moduleNode, "seek", false, SSHS_FLAGS_NOTIFY_ONLY,
+			"Continue reading from 'seekTimestamp' onwards.");
+
+		atomic_store(&state->seekTimestamp, sshsNodeGetLong(moduleData->moduleNode, "seekTimestamp"));
+
+		if (state->indexFileDescriptor >= 0) {
+			loadPacketIndex(state);
+		}
+	}
+
 	// Initialize array for packets -> packet container.
 	utarray_new(state->packetContainer.eventPackets, &ut_caerEventPacketHeader_icd);
 
@@ -1919,6 +3085,9 @@ bool isNetworkMessageBased) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
+		unmapInputFile(state);
+		freeMessageBuffers(state);
+		free(state->packetIndex);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start input assembler thread.");
 		return (false);
@@ -1928,6 +3097,9 @@ bool isNetworkMessageBased) {
 		caerRingBufferFree(state->transferRingPackets);
 		caerRingBufferFree(state->transferRingPacketContainers);
 		free(state->dataBuffer);
+		unmapInputFile(state);
+		freeMessageBuffers(state);
+		free(state->packetIndex);
 
 		// Stop assembler thread (started just above) and wait on it.
 		atomic_store(&state->running, false);
@@ -1971,7 +3143,7 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	// Now clean up the transfer ring-buffers and its contents.
 	caerEventPacketContainer packetContainer;
 	while ((packetContainer = caerRingBufferGet(state->transferRingPacketContainers)) != NULL) {
-		caerEventPacketContainerFree(packetContainer);
+		caerMainloopPacketContainerRelease(packetContainer);
 
 		// If we're here, then nobody will (or even can) consume this data afterwards.
 		caerMainloopDataNotifyDecrease(NULL);
@@ -1990,7 +3162,7 @@ void caerInputCommonExit(caerModuleData moduleData) {
 
 	caerEventPacketHeader packet;
 	while ((packet = caerRingBufferGet(state->transferRingPackets)) != NULL) {
-		free(packet);
+		caerMainloopPacketRelease(packet);
 	}
 
 	caerRingBufferFree(state->transferRingPackets);
@@ -1998,7 +3170,7 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	// Free all waiting packets.
 	caerEventPacketHeader *packetPtr = NULL;
 	while ((packetPtr = (caerEventPacketHeader *) utarray_next(state->packetContainer.eventPackets, packetPtr)) != NULL) {
-		free(*packetPtr);
+		caerMainloopPacketRelease(*packetPtr);
 	}
 
 	// Clear and free packet array used for packet container construction.
@@ -2011,6 +3183,9 @@ void caerInputCommonExit(caerModuleData moduleData) {
 
 	// Free allocated memory.
 	free(state->dataBuffer);
+	unmapInputFile(state);
+	freeMessageBuffers(state);
+	free(state->packetIndex);
 
 	// Remove lingering packet parsing data.
 	packetData curr, curr_tmp;
@@ -2021,7 +3196,7 @@ void caerInputCommonExit(caerModuleData moduleData) {
 	}
 
 	free(state->packets.currPacketData);
-	free(state->packets.currPacket);
+	caerMainloopPacketRelease(state->packets.currPacket);
 
 	// Clear sourceInfo node.
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
@@ -2041,6 +3216,9 @@ void caerInputCommonRun(caerModuleData moduleData, caerEventPacketContainer in,
 	*out = caerRingBufferGet(state->transferRingPacketContainers);
 
 	if (*out != NULL) {
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_GET, CAER_TRACE_INSTANT, moduleData->moduleID,
+			CAER_TRACE_RING_INPUT_CONTAINERS);
+
 		// No special memory order for decrease, because the acquire load to even start running
 		// through a mainloop already synchronizes with the release store above.
 		caerMainloopDataNotifyDecrease(NULL);
@@ -2093,6 +3271,24 @@ static void caerInputCommonConfigListener(sshsNode node, void *userData, enum ss
 		else if (changeType == SSHS_INT && caerStrEquals(changeKey, "PacketContainerDelay")) {
 			atomic_store(&state->packetContainer.timeDelay, changeValue.iint);
 		}
+		else if (changeType == SSHS_STRING && caerStrEquals(changeKey, "playbackMode")) {
+			if (!caerStrEquals(changeValue.string, "fixedDelay")
+				&& parsePlaybackMode(changeValue.string) == PLAYBACK_FIXED_DELAY) {
+				caerModuleLog(moduleData, CAER_LOG_WARNING, "Unknown playback mode '%s', using 'fixedDelay'.",
+					changeValue.string);
+			}
+
+			atomic_store(&state->playback.update, true);
+		}
+		else if (changeType == SSHS_FLOAT && caerStrEquals(changeKey, "playbackSpeed")) {
+			atomic_store(&state->playback.update, true);
+		}
+		else if (changeType == SSHS_LONG && caerStrEquals(changeKey, "seekTimestamp")) {
+			atomic_store(&state->seekTimestamp, changeValue.ilong);
+		}
+		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "seek") && changeValue.boolean) {
+			atomic_store(&state->seekRequest, true);
+		}
 	}
 }
 
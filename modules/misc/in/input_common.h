@@ -101,13 +101,112 @@ struct input_common_packet_container_data {
 	/// Time slice (in µs), for which to generate a packet container.
 	atomic_int_fast32_t timeSlice;
 	/// Time delay (in µs) between the start of two consecutive time slices.
-	/// This is used for real-time slow-down.
+	/// This is used for real-time slow-down in fixed delay playback mode.
 	atomic_int_fast32_t timeDelay;
 	/// Time when the last packet container was sent out, used to calculate
 	/// sleep time to reach user configured 'timeDelay'.
 	struct timespec lastCommitTime;
 };
 
+enum input_common_playback_mode {
+	/// Fixed wall-clock delay between packet containers ('PacketContainerDelay').
+	PLAYBACK_FIXED_DELAY = 0,
+	/// No delay at all, as fast as the data can be read and processed.
+	PLAYBACK_UNTHROTTLED = 1,
+	/// Follow the event timestamps, optionally sped up or slowed down.
+	PLAYBACK_REAL_TIME = 2,
+};
+
+struct input_common_playback {
+	/// Playback mode or speed changed, re-read them from the configuration.
+	atomic_bool update;
+	/// How to pace packet container commits. Assembler thread only, as all below.
+	enum input_common_playback_mode mode;
+	/// Playback speed in real-time mode, relative to the event timestamps (2 is twice as fast).
+	double speed;
+	/// An anchor maps the event timeline onto wall-clock time. It's reset when the timeline
+	/// changes (start, timestamp reset, seek), on pause and on configuration changes.
+	bool anchored;
+	/// Event timestamp of the anchor, in µs.
+	int64_t anchorTimestamp;
+	/// Wall-clock time of the anchor.
+	struct timespec anchorTime;
+	/// Maximum lateness of packet containers relative to their timestamps, in µs.
+	int64_t driftMax;
+	/// Sum of lateness, for averaging.
+	int64_t driftSum;
+	/// Number of packet containers contributing to the sums.
+	int64_t driftCount;
+	/// Last time the drift statistics were published.
+	struct timespec statisticsTime;
+};
+
+struct input_common_data_view {
+	/// Start of the data to parse: either the read buffer's content,
+	/// or the current window into the memory-mapped input file.
+	const uint8_t *data;
+	/// Size of the data, in bytes.
+	size_t size;
+	/// Current parsing position inside the data.
+	size_t position;
+};
+
+typedef struct input_common_data_view *inputCommonDataView;
+
+struct input_common_datagram {
+	/// Datagram memory, network header included.
+	uint8_t *data;
+	/// Datagram size, in bytes.
+	size_t size;
+	/// Slot holds a datagram waiting to be parsed.
+	bool valid;
+	/// Datagram starts with a new packet (highest sequence number bit set).
+	bool packetStart;
+	/// Sequence number, without the packet start flag.
+	int64_t sequenceNumber;
+	/// Arrival time, to limit how long we wait for missing datagrams.
+	struct timespec arrivalTime;
+};
+
+struct input_common_message_data {
+	/// Reorder window, datagrams are placed by sequence number modulo windowSize.
+	struct input_common_datagram *window;
+	/// Number of slots in the reorder window.
+	size_t windowSize;
+	/// Number of datagrams currently waiting in the reorder window.
+	size_t windowUsed;
+	/// Maximum time (in µs) to wait for a missing datagram, before declaring it lost.
+	int64_t maxLatency;
+	/// Buffer to receive the next datagram into, swapped into the window afterwards.
+	uint8_t *receiveBuffer;
+	/// Buffer of the datagram being parsed, swapped out of the window.
+	uint8_t *parseBuffer;
+	/// First datagram starting a packet was received, sequence numbers are valid.
+	bool synchronized;
+	/// Sequence number of the next datagram to parse.
+	int64_t nextSequenceNumber;
+	/// Highest sequence number received so far.
+	int64_t highestSequenceNumber;
+	/// Data was lost, skip datagrams until the next one starting a packet.
+	bool resync;
+	/// Datagrams that never arrived in time.
+	uint64_t datagramsLost;
+	/// Datagrams that arrived after one with a higher sequence number.
+	uint64_t datagramsReordered;
+	/// Datagrams discarded as invalid, duplicate or too late.
+	uint64_t datagramsDropped;
+	/// Times the sender restarted, detected by its sequence numbers going back.
+	uint64_t senderRestarts;
+	/// Highest time (in µs) a datagram waited in the reorder window since the last statistics update.
+	int64_t latencyMax;
+	/// Sum of all waiting times (in µs) since the last statistics update, for the average.
+	int64_t latencySum;
+	/// Number of datagrams in latencySum.
+	uint64_t latencyCount;
+	/// Time of the last statistics update.
+	struct timespec statisticsTime;
+};
+
 struct input_common_state {
 	/// Control flag for input handling threads.
 	atomic_bool running;
@@ -156,12 +255,44 @@ struct input_common_state {
 	struct input_common_packet_data packets;
 	/// Packet container data structure, to generate from packets.
 	struct input_common_packet_container_data packetContainer;
+	/// Pacing of packet containers, for file playback.
+	struct input_common_playback playback;
 	/// The file descriptor for reading.
 	int fileDescriptor;
 	/// Data buffer for reading from file descriptor (buffered I/O).
 	simpleBuffer dataBuffer;
 	/// Offset for current data buffer.
 	size_t dataBufferOffset;
+	/// Memory mapping of the whole input file, used in place of the data buffer
+	/// if possible, to avoid copying all data first into it. Files only.
+	uint8_t *dataMapping;
+	/// Size of the memory mapping, in bytes.
+	size_t dataMappingSize;
+	/// Data currently being parsed, from either the data buffer or the mapping.
+	struct input_common_data_view dataView;
+	/// Shared-memory ring to parse data from in place, NULL if not used.
+	/// Set by the shared-memory input module before initialization.
+	struct aedat3_shm_ring *sharedMemory;
+	/// Reader slot owned in the shared-memory ring.
+	size_t sharedMemoryReader;
+	/// Total number of bytes handed out for parsing from the shared-memory ring.
+	uint64_t sharedMemoryPosition;
+	/// Datagram reordering and loss detection, message-based network streams only.
+	struct input_common_message_data messages;
+	/// The file descriptor for reading the packet index, -1 if there is none.
+	/// Set by the file input module before initialization, files only.
+	int indexFileDescriptor;
+	/// Packet index, in file order (and as such by increasing first timestamp).
+	struct aedat3_index_entry *packetIndex;
+	/// Number of entries in the packet index.
+	size_t packetIndexSize;
+	/// Position of the first packet in the file, right after the header.
+	/// Packet index offsets are relative to this.
+	size_t dataStartOffset;
+	/// Timestamp to seek to on the next seek request.
+	atomic_int_fast64_t seekTimestamp;
+	/// Seek request, handled asynchronously by the reader thread.
+	atomic_bool seekRequest;
 	/// Flag to signal update to buffer configuration asynchronously.
 	atomic_bool bufferUpdate;
 	/// Reference to parent module's original data.
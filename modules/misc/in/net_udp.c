@@ -0,0 +1,86 @@
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "input_common.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+static bool caerInputNetUDPInit(caerModuleData moduleData);
+
+static const struct caer_module_functions InputNetUDPFunctions = { .moduleInit = &caerInputNetUDPInit, .moduleRun =
+	&caerInputCommonRun, .moduleConfig = NULL, .moduleExit = &caerInputCommonExit };
+
+static const struct caer_event_stream_out InputNetUDPOutputs[] = { { .type = -1 } };
+
+static const struct caer_module_info InputNetUDPInfo = { .version = 1, .name = "NetUDPInput", .description =
+	"Read AEDAT data from UDP datagrams, with loss detection and reordering.", .type = CAER_MODULE_INPUT, .memSize =
+	sizeof(struct input_common_state), .functions = &InputNetUDPFunctions, .inputStreams = NULL, .inputStreamsSize = 0,
+	.outputStreams = InputNetUDPOutputs, .outputStreamsSize = CAER_EVENT_STREAM_OUT_SIZE(InputNetUDPOutputs), };
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&InputNetUDPInfo);
+}
+
+static bool caerInputNetUDPInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "ipAddress", "127.0.0.1", 7, 15, SSHS_FLAGS_NORMAL,
+		"IPv4 address to listen on.");
+	sshsNodeCreateInt(moduleData->moduleNode, "portNumber", 6666, 1, UINT16_MAX, SSHS_FLAGS_NORMAL,
+		"Port number to listen on.");
+	sshsNodeCreateInt(moduleData->moduleNode, "socketBufferSize", 4 * 1024 * 1024, 64 * 1024, 256 * 1024 * 1024,
+		SSHS_FLAGS_NORMAL, "Size of the kernel receive buffer in bytes, to absorb bursts.");
+
+	// Open a UDP socket, on which we'll receive data packets.
+	int sockFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (sockFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create UDP socket. Error: %d.", errno);
+		return (false);
+	}
+
+	// A larger receive buffer avoids losing datagrams while the reader is busy.
+	// The system may limit this, so only warn on failure.
+	int socketBufferSize = sshsNodeGetInt(moduleData->moduleNode, "socketBufferSize");
+	if (setsockopt(sockFd, SOL_SOCKET, SO_RCVBUF, &socketBufferSize, sizeof(socketBufferSize)) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_WARNING, "Could not set UDP socket receive buffer size. Error: %d.",
+		errno);
+	}
+
+	struct sockaddr_in udpServer;
+	memset(&udpServer, 0, sizeof(struct sockaddr_in));
+
+	udpServer.sin_family = AF_INET;
+	udpServer.sin_port = htons(U16T(sshsNodeGetInt(moduleData->moduleNode, "portNumber")));
+
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	if (inet_pton(AF_INET, ipAddress, &udpServer.sin_addr) == 0) {
+		close(sockFd);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "No valid IP address found. '%s' is invalid!", ipAddress);
+
+		free(ipAddress);
+		return (false);
+	}
+	free(ipAddress);
+
+	if (bind(sockFd, (struct sockaddr *) &udpServer, sizeof(struct sockaddr_in)) != 0) {
+		close(sockFd);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not bind UDP socket to %s:%" PRIu16 ". Error: %d.",
+			inet_ntop(AF_INET, &udpServer.sin_addr, (char[INET_ADDRSTRLEN] ) { 0x00 }, INET_ADDRSTRLEN),
+			ntohs(udpServer.sin_port), errno);
+		return (false);
+	}
+
+	if (!caerInputCommonInit(moduleData, sockFd, true, true)) {
+		close(sockFd);
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "UDP socket listening on %s:%" PRIu16 ".",
+		inet_ntop(AF_INET, &udpServer.sin_addr, (char[INET_ADDRSTRLEN] ) { 0x00 }, INET_ADDRSTRLEN),
+		ntohs(udpServer.sin_port));
+
+	return (true);
+}
@@ -0,0 +1,140 @@
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "input_common.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_SHM_NAME_LENGTH 250
+
+static bool caerInputSharedMemoryInit(caerModuleData moduleData);
+static void caerInputSharedMemoryExit(caerModuleData moduleData);
+
+static const struct caer_module_functions InputSharedMemoryFunctions = { .moduleInit = &caerInputSharedMemoryInit,
+	.moduleRun = &caerInputCommonRun, .moduleConfig = NULL, .moduleExit = &caerInputSharedMemoryExit };
+
+static const struct caer_event_stream_out InputSharedMemoryOutputs[] = { { .type = -1 } };
+
+static const struct caer_module_info InputSharedMemoryInfo = { .version = 1, .name = "SharedMemoryInput",
+	.description = "Read AEDAT data from a shared-memory ring of another local process.", .type = CAER_MODULE_INPUT,
+	.memSize = sizeof(struct input_common_state), .functions = &InputSharedMemoryFunctions, .inputStreams = NULL,
+	.inputStreamsSize = 0, .outputStreams = InputSharedMemoryOutputs, .outputStreamsSize =
+		CAER_EVENT_STREAM_OUT_SIZE(InputSharedMemoryOutputs), };
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&InputSharedMemoryInfo);
+}
+
+static bool caerInputSharedMemoryInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "/caer-shm", 2, MAX_SHM_NAME_LENGTH, SSHS_FLAGS_NORMAL,
+		"Name of an existing shared-memory object to read input data from.");
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+
+	// Open existing shared-memory ring. We need write access to publish our read position.
+	int shmFd = shm_open(shmName, O_RDWR, 0);
+	if (shmFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not open shared-memory object '%s'. Error: %d.", shmName,
+		errno);
+		free(shmName);
+
+		return (false);
+	}
+
+	struct stat shmStat;
+	if (fstat(shmFd, &shmStat) != 0 || (size_t) shmStat.st_size < sizeof(struct aedat3_shm_ring)) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Shared-memory object '%s' is not a valid ring.", shmName);
+		close(shmFd);
+		free(shmName);
+
+		return (false);
+	}
+
+	size_t shmSize = (size_t) shmStat.st_size;
+
+	struct aedat3_shm_ring *ring = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+
+	// The mapping stays valid without the file descriptor.
+	close(shmFd);
+
+	if (ring == MAP_FAILED) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not map shared-memory object '%s'. Error: %d.", shmName,
+		errno);
+		free(shmName);
+
+		return (false);
+	}
+
+	if (atomic_load(&ring->magicNumber) != AEDAT3_SHM_MAGIC_NUMBER
+		|| ring->dataSize != (shmSize - sizeof(struct aedat3_shm_ring)) || !atomic_load(&ring->writerActive)) {
+		munmap(ring, shmSize);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Shared-memory object '%s' is not a valid, active ring.",
+			shmName);
+		free(shmName);
+
+		return (false);
+	}
+
+	// Claim a free reader slot. Until its position is set below, the writer may
+	// see a stale one and drop a few packets, but never overwrite data we need.
+	size_t readerSlot = AEDAT3_SHM_MAX_READERS;
+
+	for (size_t i = 0; i < AEDAT3_SHM_MAX_READERS; i++) {
+		int_fast32_t freeSlot = 0;
+		if (atomic_compare_exchange_strong(&ring->readers[i].processID, &freeSlot, getpid())) {
+			readerSlot = i;
+			break;
+		}
+	}
+
+	if (readerSlot == AEDAT3_SHM_MAX_READERS) {
+		munmap(ring, shmSize);
+
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Shared-memory object '%s' has no free reader slots (max %d).",
+			shmName, AEDAT3_SHM_MAX_READERS);
+		free(shmName);
+
+		return (false);
+	}
+
+	inputCommonState state = moduleData->moduleState;
+	state->sharedMemory = ring;
+	state->sharedMemoryReader = readerSlot;
+	state->sharedMemoryPosition = atomic_load(&ring->writePosition);
+
+	atomic_store(&ring->readers[readerSlot].readPosition, state->sharedMemoryPosition);
+
+	if (!caerInputCommonInit(moduleData, -1, true, false)) {
+		atomic_store(&ring->readers[readerSlot].processID, 0);
+		munmap(ring, shmSize);
+		state->sharedMemory = NULL;
+		free(shmName);
+
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Attached to shared-memory ring '%s' as reader %zu.", shmName,
+		readerSlot);
+
+	free(shmName);
+
+	return (true);
+}
+
+static void caerInputSharedMemoryExit(caerModuleData moduleData) {
+	inputCommonState state = moduleData->moduleState;
+	struct aedat3_shm_ring *ring = state->sharedMemory;
+
+	// Stop input threads first, nothing parses from the ring after this.
+	caerInputCommonExit(moduleData);
+
+	// Release reader slot, so the writer doesn't wait on us anymore.
+	atomic_store(&ring->readers[state->sharedMemoryReader].processID, 0);
+
+	munmap(ring, sizeof(struct aedat3_shm_ring) + ring->dataSize);
+	state->sharedMemory = NULL;
+}
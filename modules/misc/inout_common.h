@@ -3,10 +3,71 @@
 
 #include "main.h"
 #include <libcaer/network.h>
+#include <stdatomic.h>
 
 static inline void caerGenericEventSetTimestamp(void *eventPtr, caerEventPacketHeaderConst headerPtr, int32_t timestamp) {
 	*((int32_t *) (((uint8_t *) eventPtr) + U64T(caerEventPacketHeaderGetEventTSOffset(headerPtr)))) = htole32(
 		timestamp);
 }
 
+/// Suffix of the packet index file, written next to AEDAT 3.1 files to support seeking.
+#define AEDAT3_INDEX_FILE_SUFFIX ".index"
+
+/**
+ * Packet index entry. The index file is a plain sequence of these,
+ * one per event packet, in the same order as in the data file.
+ * All fields are little-endian.
+ */
+PACKED_STRUCT(struct aedat3_index_entry {
+	/// Order-relevant (first) timestamp of the packet, including overflow.
+	int64_t firstTimestamp;
+	/// Position of the packet, in bytes from the end of the file header.
+	uint64_t packetOffset;
+	/// Number of events in the packet.
+	int32_t eventNumber;
+	/// Event type of the packet.
+	int16_t eventType;
+});
+
+/// Magic number identifying an AEDAT 3.1 shared-memory ring.
+#define AEDAT3_SHM_MAGIC_NUMBER 0x4D48532E54414541LL
+/// Maximum number of processes reading from the same shared-memory ring.
+#define AEDAT3_SHM_MAX_READERS 16
+
+struct aedat3_shm_reader {
+	/// Process ID of the reader owning this slot, 0 if the slot is free.
+	atomic_int_fast32_t processID;
+	/// Total number of bytes consumed by this reader. The writer never
+	/// overwrites data that an active reader hasn't consumed yet.
+	atomic_uint_fast64_t readPosition;
+};
+
+/**
+ * Shared-memory ring, used to pass an AEDAT 3.1 network-like stream between
+ * processes on the same host. There is exactly one writer and up to
+ * AEDAT3_SHM_MAX_READERS readers, each with its own position. Positions are
+ * totals in bytes, the actual offset into the data is position % dataSize.
+ * The writer only ever publishes whole packets, and drops packets if the
+ * slowest reader doesn't leave enough space for them, so readers can parse
+ * the data directly in place.
+ */
+struct aedat3_shm_ring {
+	/// Must be AEDAT3_SHM_MAGIC_NUMBER, set last by the writer on creation.
+	atomic_int_fast64_t magicNumber;
+	/// Size of the data area following this header, in bytes.
+	uint64_t dataSize;
+	/// Writer is present. Cleared on exit, so readers can detect the end of the stream.
+	atomic_bool writerActive;
+	/// Network header is valid, it is written once the source is known.
+	atomic_bool headerValid;
+	/// Standard AEDAT 3.1 network header (little-endian), for readers to parse first.
+	uint8_t networkHeader[AEDAT3_NETWORK_HEADER_LENGTH];
+	/// Total number of bytes published by the writer.
+	atomic_uint_fast64_t writePosition;
+	/// Reader slots.
+	struct aedat3_shm_reader readers[AEDAT3_SHM_MAX_READERS];
+	/// Data area (dataSize bytes).
+	uint8_t data[];
+};
+
 #endif /* INPUT_OUTPUT_COMMON_H_ */
@@ -113,6 +113,8 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 
 	sshsNodeCreateString(moduleData->moduleNode, "prefix", DEFAULT_PREFIX, 1, MAX_PREFIX_LENGTH, SSHS_FLAGS_NORMAL,
 		"Output data files name prefix.");
+	sshsNodeCreateBool(moduleData->moduleNode, "writeIndex", false, SSHS_FLAGS_NORMAL,
+		"Write a packet index file next to the output file, to support seeking on input.");
 
 	// Generate current file name and open it.
 	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
@@ -137,11 +139,33 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 	}
 
 	caerModuleLog(moduleData, CAER_LOG_INFO, "Opened output file '%s' successfully for writing.", filePath);
+
+	// Open the packet index file, if requested: same path, with index suffix.
+	outputCommonState state = moduleData->moduleState;
+	state->indexFileIO = -1;
+
+	if (sshsNodeGetBool(moduleData->moduleNode, "writeIndex")) {
+		size_t indexPathLength = strlen(filePath) + strlen(AEDAT3_INDEX_FILE_SUFFIX) + 1; // +1 for NUL.
+		char indexPath[indexPathLength];
+		snprintf(indexPath, indexPathLength, "%s%s", filePath, AEDAT3_INDEX_FILE_SUFFIX);
+
+		state->indexFileIO = open(indexPath, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
+		if (state->indexFileIO < 0) {
+			// The data file is still usable without index, so just continue.
+			caerModuleLog(moduleData, CAER_LOG_ERROR,
+				"Could not create or open index file '%s' for writing. Error: %d.", indexPath, errno);
+		}
+	}
+
 	free(filePath);
 
 	if (!caerOutputCommonInit(moduleData, fileFd, NULL)) {
 		close(fileFd);
 
+		if (state->indexFileIO >= 0) {
+			close(state->indexFileIO);
+		}
+
 		return (false);
 	}
 
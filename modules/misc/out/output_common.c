@@ -68,7 +68,9 @@
 
 #include "output_common.h"
 #include "base/mainloop.h"
+#include "base/trace.h"
 #include "ext/portable_misc.h"
+#include "ext/portable_time.h"
 #include "ext/buffers.h"
 #include "ext/nets.h"
 
@@ -76,6 +78,15 @@
 #include <png.h>
 #endif
 
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
+#if defined(OS_UNIX) && OS_UNIX == 1
+#include <signal.h>
+#endif
+
 #include <stdatomic.h>
 #include <libcaer/events/common.h>
 #include <libcaer/events/packetContainer.h>
@@ -94,6 +105,12 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
  * ============================================================================
  */
 static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer);
+static void putPacketContainer(outputCommonState state, caerEventPacketContainer eventPackets);
+static void dropPacketContainer(outputCommonState state, caerEventPacketContainer eventPackets);
+static void putSavedPackets(outputCommonState state);
+static bool putPendingContainers(outputCommonState state);
+static bool compressorRingPut(outputCommonState state, caerEventPacketContainer eventPackets);
+static enum output_common_drop_policy parseDropPolicy(const char *dropPolicy);
 
 void caerOutputCommonRun(caerModuleData moduleData, caerEventPacketContainer in, caerEventPacketContainer *out) {
 	UNUSED_ARGUMENT(out);
@@ -152,12 +169,12 @@ void caerOutputCommonReset(caerModuleData moduleData, int16_t resetCallSourceID)
  * @param packetsContainer a container with all the event packets to send out.
  */
 static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketContainer packetsContainer) {
-	caerEventPacketHeaderConst packets[caerEventPacketContainerGetEventPacketsNumber(packetsContainer)];
+	caerEventPacketHeader packets[caerEventPacketContainerGetEventPacketsNumber(packetsContainer)];
 	size_t packetsSize = 0;
 
 	// Count how many packets are really there, skipping empty event packets.
 	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(packetsContainer); i++) {
-		caerEventPacketHeaderConst packetHeader = caerEventPacketContainerGetEventPacketConst(packetsContainer, i);
+		caerEventPacketHeader packetHeader = caerEventPacketContainerGetEventPacket(packetsContainer, i);
 
 		// Found non-empty event packet.
 		if (packetHeader != NULL) {
@@ -216,12 +233,14 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 		return;
 	}
 
-	// Handle the valid only flag here, that way we don't have to do another copy and
-	// process it in the output handling thread. We get the value once here, so we do
-	// the same for all packets from the same mainloop run, avoiding mid-way changes.
+	// Skip packets that would be empty with the valid only flag already here, so we
+	// don't share them at all. We get the value once here, so we do the same for all
+	// packets from the same mainloop run, avoiding mid-way changes.
 	bool validOnly = atomic_load_explicit(&state->validOnly, memory_order_relaxed);
 
-	// Now copy each event packet and send the array out. Track how many packets there are.
+	// Now share each event packet and send the array out. Track how many packets there are.
+	// The actual copy is done by the compressor thread, off the mainloop's critical path:
+	// the mainloop guarantees shared packets are not modified while we hold them.
 	size_t idx = 0;
 	int64_t highestTimestamp = 0;
 
@@ -258,26 +277,10 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 			}
 		}
 
-		if (validOnly) {
-			caerEventPacketContainerSetEventPacket(eventPackets, (int32_t) idx,
-				caerEventPacketCopyOnlyValidEvents(packets[i]));
-		}
-		else {
-			caerEventPacketContainerSetEventPacket(eventPackets, (int32_t) idx,
-				caerEventPacketCopyOnlyEvents(packets[i]));
-		}
-
-		if (caerEventPacketContainerGetEventPacket(eventPackets, (int32_t) idx) == NULL) {
-			// Failed to copy packet. Signal but try to continue anyway.
-			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to copy event packet to output.");
-		}
-		else {
-			idx++;
-		}
+		caerEventPacketContainerSetEventPacket(eventPackets, (int32_t) idx++, caerMainloopPacketRetain(packets[i]));
 	}
 
-	// We might have failed to copy all packets (unlikely), or skipped all of them
-	// due to timestamp check failures.
+	// We might have skipped all packets due to timestamp check failures.
 	if (idx == 0) {
 		caerEventPacketContainerFree(eventPackets);
 
@@ -288,24 +291,198 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
 	// if we actually got any packets through.
 	state->lastTimestamp = highestTimestamp;
 
-	// Reset packet container size so we only consider the packets we managed
-	// to successfully copy.
+	// Reset packet container size so we only consider the packets we actually shared.
 	caerEventPacketContainerSetEventPacketsNumber(eventPackets, (int32_t) idx);
 
-	retry: if (!caerRingBufferPut(state->compressorRing, eventPackets)) {
-		if (atomic_load_explicit(&state->keepPackets, memory_order_relaxed)) {
+	putPacketContainer(state, eventPackets);
+}
+
+/**
+ * Put a packet container on the compressor ring-buffer, applying the
+ * configured drop policy if it's full. Older data always goes in first:
+ * special and IMU packets saved from previously dropped containers, then
+ * any container still waiting for space.
+ *
+ * @param state output module state.
+ * @param eventPackets container with the shared event packets to send out.
+ */
+static void putPacketContainer(outputCommonState state, caerEventPacketContainer eventPackets) {
+	enum output_common_drop_policy dropPolicy = (enum output_common_drop_policy) atomic_load_explicit(
+		&state->dropPolicy, memory_order_relaxed);
+
+	putSavedPackets(state);
+
+	if (dropPolicy == DROP_POLICY_BLOCK) {
+		// Send anything still waiting from a previous policy first.
+		size_t pendingContainersSize = state->drops.pendingContainersSize;
+		state->drops.pendingContainersSize = 0;
+
+		for (size_t i = 0; i < pendingContainersSize; i++) {
+			putPacketContainer(state, state->drops.pendingContainers[i]);
+		}
+
+		struct timespec blockStart;
+		portable_clock_gettime_monotonic(&blockStart);
+
+		bool blocked = false;
+
+		while (!compressorRingPut(state, eventPackets)) {
 			// Delay by 500 µs if no change, to avoid a wasteful busy loop.
 			struct timespec retrySleep = { .tv_sec = 0, .tv_nsec = 500000 };
 			thrd_sleep(&retrySleep, NULL);
 
-			// Retry forever if requested.
-			goto retry;
+			// Retry forever, unless the output is gone for good.
+			if (atomic_load_explicit(&state->outputThreadFailure, memory_order_relaxed)) {
+				caerMainloopPacketContainerRelease(eventPackets);
+				break;
+			}
+
+			blocked = true;
 		}
 
-		caerEventPacketContainerFree(eventPackets);
+		if (blocked) {
+			struct timespec blockEnd;
+			portable_clock_gettime_monotonic(&blockEnd);
 
-		caerModuleLog(state->parentModule, CAER_LOG_NOTICE,
-			"Failed to put packet's array copy on transfer ring-buffer: full.");
+			uint64_t blockedTime = U64T(
+				I64T(blockEnd.tv_sec - blockStart.tv_sec) * 1000000LL
+					+ I64T(blockEnd.tv_nsec - blockStart.tv_nsec) / 1000);
+
+			atomic_fetch_add_explicit(&state->drops.blockedTime, blockedTime, memory_order_relaxed);
+		}
+
+		return;
+	}
+
+	if (dropPolicy == DROP_POLICY_DROP_OLDEST) {
+		// Containers still waiting must go in before this one.
+		if (putPendingContainers(state) && compressorRingPut(state, eventPackets)) {
+			return;
+		}
+
+		if (state->drops.pendingContainersSize < MAX_OUTPUT_PENDING_CONTAINERS) {
+			// Ask the compressor thread to drop the oldest queued container,
+			// and keep this one until there is space for it.
+			atomic_fetch_add_explicit(&state->drops.dropOldestRequests, 1, memory_order_relaxed);
+
+			state->drops.pendingContainers[state->drops.pendingContainersSize++] = eventPackets;
+		}
+		else {
+			// The compressor thread is not keeping up with drop requests either:
+			// nothing older can be made room for, so this new container is dropped.
+			atomic_fetch_add_explicit(&state->drops.droppedNewest, 1, memory_order_relaxed);
+			dropPacketContainer(state, eventPackets);
+		}
+
+		return;
+	}
+
+	// Drop newest and decimate: new containers that don't fit are dropped.
+	// Decimation reacts to this by reducing the data rate.
+	if (!putPendingContainers(state) || !compressorRingPut(state, eventPackets)) {
+		atomic_fetch_add_explicit(&state->drops.droppedNewest, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&state->drops.overflows, 1, memory_order_relaxed);
+		dropPacketContainer(state, eventPackets);
+	}
+}
+
+/**
+ * Drop a packet container of shared event packets. If configured, special
+ * and IMU packets are saved, to be sent as soon as there is space again.
+ *
+ * @param state output module state.
+ * @param eventPackets container with the shared event packets to drop.
+ */
+static void dropPacketContainer(outputCommonState state, caerEventPacketContainer eventPackets) {
+	bool keepSpecialEvents = atomic_load_explicit(&state->keepSpecialEvents, memory_order_relaxed);
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(eventPackets); i++) {
+		caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(eventPackets, i);
+		int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+
+		if (keepSpecialEvents && state->drops.savedPacketsSize < MAX_OUTPUT_SAVED_PACKETS
+			&& (eventType == SPECIAL_EVENT || eventType == IMU6_EVENT || eventType == IMU9_EVENT)) {
+			state->drops.savedPackets[state->drops.savedPacketsSize++] = packet;
+			atomic_fetch_add_explicit(&state->drops.keptPackets, 1, memory_order_relaxed);
+		}
+		else {
+			caerMainloopPacketRelease(packet);
+		}
+	}
+
+	free(eventPackets);
+}
+
+/**
+ * Put the packet containers waiting for space on the compressor ring-buffer,
+ * oldest first, until it is full again.
+ *
+ * @param state output module state.
+ *
+ * @return true if no container is left waiting, false otherwise.
+ */
+static bool putPendingContainers(outputCommonState state) {
+	size_t putContainers = 0;
+
+	while (putContainers < state->drops.pendingContainersSize
+		&& compressorRingPut(state, state->drops.pendingContainers[putContainers])) {
+		putContainers++;
+	}
+
+	if (putContainers > 0) {
+		state->drops.pendingContainersSize -= putContainers;
+
+		memmove(state->drops.pendingContainers, state->drops.pendingContainers + putContainers,
+			state->drops.pendingContainersSize * sizeof(caerEventPacketContainer));
+	}
+
+	return (state->drops.pendingContainersSize == 0);
+}
+
+static void putSavedPackets(outputCommonState state) {
+	if (state->drops.savedPacketsSize == 0) {
+		return;
+	}
+
+	caerEventPacketContainer savedPackets = caerEventPacketContainerAllocate((int32_t) state->drops.savedPacketsSize);
+	if (savedPackets == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < state->drops.savedPacketsSize; i++) {
+		caerEventPacketContainerSetEventPacket(savedPackets, (int32_t) i, state->drops.savedPackets[i]);
+	}
+
+	if (compressorRingPut(state, savedPackets)) {
+		state->drops.savedPacketsSize = 0;
+	}
+	else {
+		// Keep them for the next try, free the container only.
+		free(savedPackets);
+	}
+}
+
+static bool compressorRingPut(outputCommonState state, caerEventPacketContainer eventPackets) {
+	bool put = caerRingBufferPut(state->compressorRing, eventPackets);
+
+	caerTraceEvent((put) ? (CAER_TRACE_RINGBUFFER_PUT) : (CAER_TRACE_RINGBUFFER_FULL), CAER_TRACE_INSTANT,
+		state->parentModule->moduleID, CAER_TRACE_RING_OUTPUT_CONTAINERS);
+
+	return (put);
+}
+
+static enum output_common_drop_policy parseDropPolicy(const char *dropPolicy) {
+	if (caerStrEquals(dropPolicy, "block")) {
+		return (DROP_POLICY_BLOCK);
+	}
+	else if (caerStrEquals(dropPolicy, "dropOldest")) {
+		return (DROP_POLICY_DROP_OLDEST);
+	}
+	else if (caerStrEquals(dropPolicy, "decimate")) {
+		return (DROP_POLICY_DECIMATE);
+	}
+	else {
+		return (DROP_POLICY_DROP_NEWEST);
 	}
 }
 
@@ -319,9 +496,24 @@ static void copyPacketsToTransferRing(outputCommonState state, caerEventPacketCo
  */
 static int compressorThread(void *stateArg);
 
+static bool copySharedEventPackets(outputCommonState state, caerEventPacketContainer packetContainer);
+static void dropOldestPacketContainers(outputCommonState state);
+static void updateDecimation(outputCommonState state);
+static void decimatePolarityPackets(outputCommonState state, caerEventPacketContainer packetContainer);
+static void updateDropStatistics(outputCommonState state);
 static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer);
 static int packetsFirstTimestampThenTypeCmp(const void *a, const void *b);
 static void sendEventPacket(outputCommonState state, caerEventPacketHeader packet);
+static void commitEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize,
+	const struct aedat3_index_entry *indexEntry);
+static void writeIndexEntry(outputCommonState state, const struct aedat3_index_entry *indexEntry);
+static void flushIndexBuffer(outputCommonState state);
+static void compressorPoolStart(outputCommonState state);
+static void compressorPoolStop(outputCommonState state);
+static void compressorPoolSubmit(outputCommonState state, caerEventPacketHeader packet, size_t packetSize,
+	const struct aedat3_index_entry *indexEntry);
+static void compressorPoolCommit(outputCommonState state, size_t maxPendingJobs);
+static int compressorWorkerThread(void *stateArg);
 static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
 static size_t compressTimestampSerialize(outputCommonState state, caerEventPacketHeader packet);
 
@@ -330,6 +522,10 @@ static void caerLibPNGWriteBuffer(png_structp png_ptr, png_bytep data, png_size_
 static size_t compressFramePNG(outputCommonState state, caerEventPacketHeader packet);
 #endif
 
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+static size_t compressPacketLZ4(outputCommonState state, caerEventPacketHeader packet, size_t packetSize);
+#endif
+
 static int compressorThread(void *stateArg) {
 	outputCommonState state = stateArg;
 
@@ -344,16 +540,30 @@ static int compressorThread(void *stateArg) {
 	// to avoid wasting resources in a busy loop.
 	struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
 
+	// Start compression workers, if compression is enabled at all.
+	compressorPoolStart(state);
+
 	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		// Apply the drop policy first: make space if asked to, and adapt to the load.
+		dropOldestPacketContainers(state);
+		updateDecimation(state);
+		updateDropStatistics(state);
+
 		// Get the newest event packet container from the transfer ring-buffer.
 		caerEventPacketContainer currPacketContainer = caerRingBufferGet(state->compressorRing);
 		if (currPacketContainer == NULL) {
-			// There is none, so we can't work on and commit this.
-			// We just sleep here a little and then try again, as we need the data!
+			// There is none, so we can't work on and commit this. Pass on any packets
+			// the workers finished compressing in the meantime, then sleep a little
+			// and try again, as we need the data!
+			compressorPoolCommit(state, SIZE_MAX);
+
 			thrd_sleep(&noDataSleep, NULL);
 			continue;
 		}
 
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_GET, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_OUTPUT_CONTAINERS);
+
 		// Respect time order as specified in AEDAT 3.X format: first event's main
 		// timestamp decides its ordering with regards to other packets. Smaller
 		// comes first. If equal, order by increasing type ID as a convenience,
@@ -367,10 +577,515 @@ static int compressorThread(void *stateArg) {
 		orderAndSendEventPackets(state, packetContainer);
 	}
 
+	// Wait for all outstanding compression jobs and commit them, then stop the workers.
+	compressorPoolCommit(state, 0);
+	compressorPoolStop(state);
+
+	// Write out any remaining packet index entries.
+	flushIndexBuffer(state);
+
+	// Publish final drop counts.
+	state->drops.statisticsTime = (struct timespec) { 0 };
+	updateDropStatistics(state);
+
+	return (thrd_success);
+}
+
+/**
+ * Start the compression worker threads. Compression of event packets is independent
+ * from packet to packet, so it can be spread across multiple threads, while the
+ * compressor thread keeps ordering the packets and committing them to the output
+ * thread in the same order they were submitted. If compression is disabled, or no
+ * worker can be started, packets are compressed inline by the compressor thread.
+ *
+ * @param state common output state.
+ */
+static void compressorPoolStart(outputCommonState state) {
+	outputCommonCompressorPool pool = &state->compressorPool;
+
+	pool->workersNumber = 0;
+
+	if (state->formatID == 0x00 || state->compressorThreadsNumber == 0) {
+		return;
+	}
+
+	// Allow for a few jobs per worker to be in flight, so that workers don't
+	// idle while the compressor thread is busy committing.
+	pool->jobsSize = 4 * state->compressorThreadsNumber;
+
+	pool->jobs = calloc(pool->jobsSize, sizeof(struct output_common_compressor_job));
+	if (pool->jobs == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate compression job queue, compressing inline.");
+		return;
+	}
+
+	pool->workers = calloc(state->compressorThreadsNumber, sizeof(thrd_t));
+	if (pool->workers == NULL) {
+		free(pool->jobs);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate compression workers memory, compressing inline.");
+		return;
+	}
+
+	if (mtx_init(&pool->lock, mtx_plain) != thrd_success) {
+		free(pool->workers);
+		free(pool->jobs);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize compression job queue lock.");
+		return;
+	}
+
+	if (cnd_init(&pool->jobAvailable) != thrd_success) {
+		mtx_destroy(&pool->lock);
+		free(pool->workers);
+		free(pool->jobs);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize compression job condition.");
+		return;
+	}
+
+	if (cnd_init(&pool->jobDone) != thrd_success) {
+		cnd_destroy(&pool->jobAvailable);
+		mtx_destroy(&pool->lock);
+		free(pool->workers);
+		free(pool->jobs);
+
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to initialize compression job condition.");
+		return;
+	}
+
+	pool->shutdown = false;
+	pool->jobsHead = 0;
+	pool->jobsNext = 0;
+	pool->jobsTail = 0;
+
+	for (size_t i = 0; i < state->compressorThreadsNumber; i++) {
+		if (thrd_create(&pool->workers[i], &compressorWorkerThread, state) != thrd_success) {
+			caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+				"Failed to start compression worker thread %zu, continuing with %zu workers.", i, i);
+			break;
+		}
+
+		pool->workersNumber++;
+	}
+
+	if (pool->workersNumber == 0) {
+		// Nothing started, fall back to inline compression.
+		cnd_destroy(&pool->jobDone);
+		cnd_destroy(&pool->jobAvailable);
+		mtx_destroy(&pool->lock);
+		free(pool->workers);
+		free(pool->jobs);
+	}
+}
+
+/**
+ * Stop all compression worker threads and free the pool's resources.
+ * All submitted jobs must have been committed before calling this.
+ *
+ * @param state common output state.
+ */
+static void compressorPoolStop(outputCommonState state) {
+	outputCommonCompressorPool pool = &state->compressorPool;
+
+	if (pool->workersNumber == 0) {
+		return;
+	}
+
+	mtx_lock(&pool->lock);
+	pool->shutdown = true;
+	cnd_broadcast(&pool->jobAvailable);
+	mtx_unlock(&pool->lock);
+
+	for (size_t i = 0; i < pool->workersNumber; i++) {
+		if ((errno = thrd_join(pool->workers[i], NULL)) != thrd_success) {
+			// This should never happen!
+			caerModuleLog(state->parentModule, CAER_LOG_CRITICAL,
+				"Failed to join compression worker thread. Error: %d.", errno);
+		}
+	}
+
+	pool->workersNumber = 0;
+
+	cnd_destroy(&pool->jobDone);
+	cnd_destroy(&pool->jobAvailable);
+	mtx_destroy(&pool->lock);
+	free(pool->workers);
+	free(pool->jobs);
+}
+
+/**
+ * Queue an event packet for compression by a worker thread. If the job
+ * queue is full, this first waits for the oldest job to complete and
+ * commits it, so memory use and latency stay bounded.
+ *
+ * @param state common output state.
+ * @param packet the event packet to compress.
+ * @param packetSize the current event packet size (header + data).
+ * @param indexEntry packet index information, taken before compression.
+ */
+static void compressorPoolSubmit(outputCommonState state, caerEventPacketHeader packet, size_t packetSize,
+	const struct aedat3_index_entry *indexEntry) {
+	outputCommonCompressorPool pool = &state->compressorPool;
+
+	// Ensure at least one free slot. Only this thread ever adds jobs,
+	// so the slot cannot be taken away afterwards.
+	compressorPoolCommit(state, pool->jobsSize - 1);
+
+	mtx_lock(&pool->lock);
+
+	struct output_common_compressor_job *job = &pool->jobs[pool->jobsTail % pool->jobsSize];
+	job->packet = packet;
+	job->packetSize = packetSize;
+	job->indexEntry = *indexEntry;
+	job->done = false;
+
+	pool->jobsTail++;
+
+	cnd_signal(&pool->jobAvailable);
+
+	mtx_unlock(&pool->lock);
+}
+
+/**
+ * Commit completed compression jobs to the output thread, in the order they
+ * were submitted. Waits for in-progress jobs until no more than maxPendingJobs
+ * are left outstanding, then commits any further already completed ones.
+ * Pass SIZE_MAX to never wait, zero to wait for all jobs.
+ *
+ * @param state common output state.
+ * @param maxPendingJobs maximum number of outstanding jobs on return.
+ */
+static void compressorPoolCommit(outputCommonState state, size_t maxPendingJobs) {
+	outputCommonCompressorPool pool = &state->compressorPool;
+
+	if (pool->workersNumber == 0) {
+		return;
+	}
+
+	while (true) {
+		mtx_lock(&pool->lock);
+
+		if (pool->jobsHead == pool->jobsTail) {
+			// No jobs left at all.
+			mtx_unlock(&pool->lock);
+			break;
+		}
+
+		struct output_common_compressor_job *job = &pool->jobs[pool->jobsHead % pool->jobsSize];
+
+		if ((pool->jobsTail - pool->jobsHead) > maxPendingJobs) {
+			while (!job->done) {
+				cnd_wait(&pool->jobDone, &pool->lock);
+			}
+		}
+		else if (!job->done) {
+			// Oldest job still in progress, and we don't have to wait for it.
+			mtx_unlock(&pool->lock);
+			break;
+		}
+
+		caerEventPacketHeader packet = job->packet;
+		size_t packetSize = job->packetSize;
+		struct aedat3_index_entry indexEntry = job->indexEntry;
+
+		pool->jobsHead++;
+
+		mtx_unlock(&pool->lock);
+
+		// Committing may block on a full output ring-buffer, so do it without holding the lock.
+		commitEventPacket(state, packet, packetSize, &indexEntry);
+	}
+}
+
+static int compressorWorkerThread(void *stateArg) {
+	outputCommonState state = stateArg;
+	outputCommonCompressorPool pool = &state->compressorPool;
+
+	// Set thread name.
+	size_t threadNameLength = strlen(state->parentModule->moduleSubSystemString);
+	char threadName[threadNameLength + 1 + 19]; // +1 for NUL character.
+	strcpy(threadName, state->parentModule->moduleSubSystemString);
+	strcat(threadName, "[Compressor Worker]");
+	thrd_set_name(threadName);
+
+	mtx_lock(&pool->lock);
+
+	while (true) {
+		// Wait for a job to claim. Remaining jobs are always processed before shutting down.
+		while (pool->jobsNext == pool->jobsTail && !pool->shutdown) {
+			cnd_wait(&pool->jobAvailable, &pool->lock);
+		}
+
+		if (pool->jobsNext == pool->jobsTail) {
+			break;
+		}
+
+		struct output_common_compressor_job *job = &pool->jobs[pool->jobsNext % pool->jobsSize];
+		pool->jobsNext++;
+
+		caerEventPacketHeader packet = job->packet;
+		size_t packetSize = job->packetSize;
+
+		mtx_unlock(&pool->lock);
+
+		// The slot can't be reused before it's marked done and committed, so it's safe
+		// to compress without holding the lock.
+		packetSize = compressEventPacket(state, packet, packetSize);
+
+		mtx_lock(&pool->lock);
+
+		job->packetSize = packetSize;
+		job->done = true;
+
+		cnd_signal(&pool->jobDone);
+	}
+
+	mtx_unlock(&pool->lock);
+
 	return (thrd_success);
 }
 
-static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer) {
+/**
+ * Replace the packets shared by the mainloop with private copies, that we can freely
+ * modify (compression) and hand over to the output thread. Only valid events are
+ * copied, if so requested. The shared packets go back to the mainloop's packet pool
+ * on release. The copies don't come from it, as the write path frees them with free().
+ *
+ * @param state output module state.
+ * @param packetContainer container with shared event packets. Packets that fail to
+ *                        copy are removed from it.
+ *
+ * @return true if any packets are left in the container, false otherwise.
+ */
+static bool copySharedEventPackets(outputCommonState state, caerEventPacketContainer packetContainer) {
+	// Get the value once here, so we do the same for all packets from the same container.
+	bool validOnly = atomic_load_explicit(&state->validOnly, memory_order_relaxed);
+
+	int32_t idx = 0;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(packetContainer); i++) {
+		caerEventPacketHeader sharedPacket = caerEventPacketContainerGetEventPacket(packetContainer, i);
+
+		caerEventPacketHeader packetCopy;
+		if (validOnly) {
+			packetCopy = caerEventPacketCopyOnlyValidEvents(sharedPacket);
+		}
+		else {
+			packetCopy = caerEventPacketCopyOnlyEvents(sharedPacket);
+		}
+
+		caerMainloopPacketRelease(sharedPacket);
+
+		if (packetCopy == NULL) {
+			// Failed to copy packet. Signal but try to continue anyway. With validOnly,
+			// this also happens if the flag changed after the empty packet check.
+			if (!validOnly) {
+				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to copy event packet to output.");
+			}
+
+			continue;
+		}
+
+		caerEventPacketContainerSetEventPacket(packetContainer, idx++, packetCopy);
+	}
+
+	// Reset packet container size so we only consider the packets we managed
+	// to successfully copy.
+	caerEventPacketContainerSetEventPacketsNumber(packetContainer, idx);
+
+	if (idx == 0) {
+		free(packetContainer);
+		return (false);
+	}
+
+	return (true);
+}
+
+/**
+ * Drop the oldest packet containers from the compressor ring-buffer, as requested
+ * by the mainloop for the drop oldest policy. Only the compressor thread may take
+ * containers out of the ring-buffer, so the mainloop can't do this itself.
+ * If configured, special and IMU packets of dropped containers are still sent.
+ *
+ * @param state output module state.
+ */
+static void dropOldestPacketContainers(outputCommonState state) {
+	uint_fast32_t dropRequests = atomic_exchange_explicit(&state->drops.dropOldestRequests, 0, memory_order_relaxed);
+
+	bool keepSpecialEvents = atomic_load_explicit(&state->keepSpecialEvents, memory_order_relaxed);
+
+	while (dropRequests-- > 0) {
+		caerEventPacketContainer oldestContainer = caerRingBufferGet(state->compressorRing);
+		if (oldestContainer == NULL) {
+			// Ring-buffer already drained, nothing left to drop.
+			break;
+		}
+
+		atomic_fetch_add_explicit(&state->drops.droppedOldest, 1, memory_order_relaxed);
+
+		if (!keepSpecialEvents) {
+			caerMainloopPacketContainerRelease(oldestContainer);
+			continue;
+		}
+
+		int32_t idx = 0;
+
+		for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(oldestContainer); i++) {
+			caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(oldestContainer, i);
+			int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+
+			if (eventType == SPECIAL_EVENT || eventType == IMU6_EVENT || eventType == IMU9_EVENT) {
+				caerEventPacketContainerSetEventPacket(oldestContainer, idx++, packet);
+			}
+			else {
+				caerMainloopPacketRelease(packet);
+			}
+		}
+
+		caerEventPacketContainerSetEventPacketsNumber(oldestContainer, idx);
+
+		if (idx == 0) {
+			free(oldestContainer);
+			continue;
+		}
+
+		atomic_fetch_add_explicit(&state->drops.keptPackets, (uint64_t) idx, memory_order_relaxed);
+
+		orderAndSendEventPackets(state, oldestContainer);
+	}
+}
+
+/**
+ * Adapt the decimation factor to the load: double it every 100 ms while the
+ * compressor ring-buffer keeps overflowing, halve it again after one second
+ * without overflows.
+ *
+ * @param state output module state.
+ */
+static void updateDecimation(outputCommonState state) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - state->drops.decimationTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - state->drops.decimationTime.tv_nsec) / 1000;
+
+	if (elapsedTime < 100000) {
+		return;
+	}
+
+	uint_fast32_t overflows = atomic_exchange_explicit(&state->drops.overflows, 0, memory_order_relaxed);
+
+	if (atomic_load_explicit(&state->dropPolicy, memory_order_relaxed) != DROP_POLICY_DECIMATE) {
+		state->drops.decimationFactor = 1;
+		state->drops.decimationTime = currentTime;
+	}
+	else if (overflows > 0) {
+		if (state->drops.decimationFactor < MAX_OUTPUT_DECIMATION) {
+			state->drops.decimationFactor *= 2;
+		}
+
+		state->drops.decimationTime = currentTime;
+	}
+	else if (elapsedTime >= 1000000 && state->drops.decimationFactor > 1) {
+		state->drops.decimationFactor /= 2;
+		state->drops.decimationTime = currentTime;
+	}
+}
+
+/**
+ * Keep only one polarity event out of decimationFactor in each polarity packet.
+ * The packets must be private copies, they are compacted in place.
+ *
+ * @param state output module state.
+ * @param packetContainer container with private copies of event packets.
+ */
+static void decimatePolarityPackets(outputCommonState state, caerEventPacketContainer packetContainer) {
+	int32_t decimationFactor = state->drops.decimationFactor;
+	if (decimationFactor <= 1) {
+		return;
+	}
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(packetContainer); i++) {
+		caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(packetContainer, i);
+
+		if (caerEventPacketHeaderGetEventType(packet) != POLARITY_EVENT) {
+			continue;
+		}
+
+		int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+		size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packet);
+		uint8_t *events = ((uint8_t *) packet) + CAER_EVENT_PACKET_HEADER_SIZE;
+
+		// Always keep the first event, so the packet keeps its first timestamp for ordering.
+		int32_t eventsKept = 0;
+		int32_t eventsValid = 0;
+
+		for (int32_t evt = 0; evt < eventNumber; evt += decimationFactor) {
+			const uint8_t *event = events + ((size_t) evt * eventSize);
+
+			if (caerGenericEventIsValid(event)) {
+				eventsValid++;
+			}
+
+			if (evt != eventsKept) {
+				memcpy(events + ((size_t) eventsKept * eventSize), event, eventSize);
+			}
+
+			eventsKept++;
+		}
+
+		caerEventPacketHeaderSetEventNumber(packet, eventsKept);
+		caerEventPacketHeaderSetEventValid(packet, eventsValid);
+
+		atomic_fetch_add_explicit(&state->drops.decimatedEvents, (uint64_t) (eventNumber - eventsKept),
+			memory_order_relaxed);
+	}
+}
+
+static void updateDropStatistics(outputCommonState state) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - state->drops.statisticsTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - state->drops.statisticsTime.tv_nsec) / 1000;
+
+	// Update once per second.
+	if (elapsedTime < 1000000) {
+		return;
+	}
+
+	sshsNode moduleNode = state->parentModule->moduleNode;
+
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "droppedNewest", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.droppedNewest, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "droppedOldest", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.droppedOldest, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "decimatedEvents", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.decimatedEvents, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "droppedOutput", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.droppedOutput, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "keptPackets", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.keptPackets, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "blockedTime", SSHS_LONG, (union sshs_node_attr_value ) { .ilong =
+		I64T(atomic_load_explicit(&state->drops.blockedTime, memory_order_relaxed)) });
+	sshsNodeUpdateReadOnlyAttribute(moduleNode, "decimationFactor", SSHS_INT, (union sshs_node_attr_value ) { .iint =
+		state->drops.decimationFactor });
+
+	state->drops.statisticsTime = currentTime;
+}
+
+static void orderAndSendEventPackets(outputCommonState state, caerEventPacketContainer currPacketContainer) {
+	// Get private copies of the packets shared with the mainloop.
+	if (!copySharedEventPackets(state, currPacketContainer)) {
+		return;
+	}
+
+	// Thin out polarity events while decimating.
+	decimatePolarityPackets(state, currPacketContainer);
+
 	// Sort container by first timestamp (required) and by type ID (convenience).
 	size_t currPacketContainerSize = (size_t) caerEventPacketContainerGetEventPacketsNumber(currPacketContainer);
 
@@ -430,13 +1145,37 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 	state->statistics.packetsDataSize += (size_t) (caerEventPacketHeaderGetEventNumber(packet)
 		* caerEventPacketHeaderGetEventSize(packet));
 
+	// Packet index support: get the information while the packet is still uncompressed.
+	// The position in the file is only known once the packet is committed.
+	struct aedat3_index_entry indexEntry = { .firstTimestamp = caerGenericEventGetTimestamp64(
+		caerGenericEventGetEvent(packet, 0), packet), .packetOffset = 0, .eventNumber =
+		caerEventPacketHeaderGetEventNumber(packet), .eventType = caerEventPacketHeaderGetEventType(packet) };
+
 	if (state->formatID != 0) {
+		if (state->compressorPool.workersNumber > 0) {
+			// Compress in parallel, the packet is committed later on, in order.
+			compressorPoolSubmit(state, packet, packetSize, &indexEntry);
+			return;
+		}
+
 		packetSize = compressEventPacket(state, packet, packetSize);
 	}
 
-	// Statistics support (after compression).
-	state->statistics.dataWritten += packetSize;
+	commitEventPacket(state, packet, packetSize, &indexEntry);
+}
 
+/**
+ * Hand over a (possibly compressed) event packet to the output thread.
+ * Must only be called from the compressor thread, as the output ring-buffer
+ * only supports a single producer.
+ *
+ * @param state common output state.
+ * @param packet the event packet to send out. Ownership is transferred.
+ * @param packetSize the event packet size (header + data) after compression.
+ * @param indexEntry packet index information, taken before compression.
+ */
+static void commitEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize,
+	const struct aedat3_index_entry *indexEntry) {
 	// Send compressed packet out to output handling thread.
 	// Already format it as a libuv buffer.
 	libuvWriteBuf packetBuffer = malloc(sizeof(*packetBuffer));
@@ -447,6 +1186,18 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 		return;
 	}
 
+	// Packets are written out in exactly this order, so the data written so far
+	// is this packet's position in the file (after the header).
+	if (state->indexFileIO >= 0) {
+		struct aedat3_index_entry positionedEntry = *indexEntry;
+		positionedEntry.packetOffset = state->statistics.dataWritten;
+
+		writeIndexEntry(state, &positionedEntry);
+	}
+
+	// Statistics support (after compression).
+	state->statistics.dataWritten += packetSize;
+
 	libuvWriteBufInitWithAnyBuffer(packetBuffer, packet, packetSize);
 
 	// Put packet buffer onto output ring-buffer. Retry until successful.
@@ -454,13 +1205,50 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
 		// If the output thread failed, we'd forever block here, if it can't accept
 		// any more data. So we detect that condition and discard remaining packets.
 		if (atomic_load_explicit(&state->outputThreadFailure, memory_order_relaxed)) {
-			break;
+			return;
 		}
 
 		// Delay by 500 µs if no change, to avoid a wasteful busy loop.
 		struct timespec retrySleep = { .tv_sec = 0, .tv_nsec = 500000 };
 		thrd_sleep(&retrySleep, NULL);
 	}
+
+	caerTraceEvent(CAER_TRACE_RINGBUFFER_PUT, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+		CAER_TRACE_RING_OUTPUT_BUFFERS);
+}
+
+static void writeIndexEntry(outputCommonState state, const struct aedat3_index_entry *indexEntry) {
+	simpleBuffer buf = state->indexBuffer;
+
+	if ((buf->bufferUsedSize + sizeof(struct aedat3_index_entry)) > buf->bufferSize) {
+		flushIndexBuffer(state);
+	}
+
+	struct aedat3_index_entry *entry = (struct aedat3_index_entry *) (buf->buffer + buf->bufferUsedSize);
+
+	entry->firstTimestamp = htole64(indexEntry->firstTimestamp);
+	entry->packetOffset = htole64(indexEntry->packetOffset);
+	entry->eventNumber = htole32(indexEntry->eventNumber);
+	entry->eventType = htole16(indexEntry->eventType);
+
+	buf->bufferUsedSize += sizeof(struct aedat3_index_entry);
+}
+
+static void flushIndexBuffer(outputCommonState state) {
+	if (state->indexFileIO < 0 || state->indexBuffer->bufferUsedSize == 0) {
+		return;
+	}
+
+	if (!writeUntilDone(state->indexFileIO, state->indexBuffer->buffer, state->indexBuffer->bufferUsedSize)) {
+		// Index is optional, the data file is still fine: just stop writing it.
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to write packet index, disabling it. Error: %d.", errno);
+
+		close(state->indexFileIO);
+		state->indexFileIO = -1;
+	}
+
+	state->indexBuffer->bufferUsedSize = 0;
 }
 
 /**
@@ -480,16 +1268,27 @@ static void sendEventPacket(outputCommonState state, caerEventPacketHeader packe
  */
 static size_t compressEventPacket(outputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
 	size_t compressedSize = packetSize;
+	int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+	bool fastCompression = false;
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	// Data compression technique 3: fast LZ4 compression of the whole data portion of
+	// polarity and frame packets. Takes precedence over the other techniques for these.
+	if ((state->formatID & 0x04) && (eventType == POLARITY_EVENT || eventType == FRAME_EVENT)) {
+		compressedSize = compressPacketLZ4(state, packet, packetSize);
+		fastCompression = true;
+	}
+#endif
 
 	// Data compression technique 1: serialize timestamps for event types that tend to repeat them a lot.
 	// Currently, this means polarity events.
-	if ((state->formatID & 0x01) && caerEventPacketHeaderGetEventType(packet) == POLARITY_EVENT) {
+	if (!fastCompression && (state->formatID & 0x01) && eventType == POLARITY_EVENT) {
 		compressedSize = compressTimestampSerialize(state, packet);
 	}
 
 #ifdef ENABLE_INOUT_PNG_COMPRESSION
 	// Data compression technique 2: do PNG compression on frames, Grayscale and RGB(A).
-	if ((state->formatID & 0x02) && caerEventPacketHeaderGetEventType(packet) == FRAME_EVENT) {
+	if (!fastCompression && (state->formatID & 0x02) && eventType == FRAME_EVENT) {
 		compressedSize = compressFramePNG(state, packet);
 	}
 #endif
@@ -791,6 +1590,62 @@ static size_t compressFramePNG(outputCommonState state, caerEventPacketHeader pa
 
 #endif
 
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+
+/**
+ * Compress the whole data portion of an event packet with LZ4, either in its
+ * fast mode (level 0), or with its high-compression variant (levels 1-12).
+ * The event packet header stays uncompressed, and the number of events and
+ * their size give the decompressed length on input.
+ *
+ * @param state common output state.
+ * @param packet the event packet to compress.
+ * @param packetSize the current event packet size (header + data).
+ *
+ * @return the event packet size (header + data) after compression.
+ *         Equal to packetSize if the data couldn't be made any smaller.
+ */
+static size_t compressPacketLZ4(outputCommonState state, caerEventPacketHeader packet, size_t packetSize) {
+	size_t dataSize = packetSize - CAER_EVENT_PACKET_HEADER_SIZE;
+
+	if (dataSize == 0 || dataSize > LZ4_MAX_INPUT_SIZE) {
+		return (packetSize);
+	}
+
+	int outBufferSize = LZ4_compressBound((int) dataSize);
+
+	char *outBuffer = malloc((size_t) outBufferSize);
+	if (outBuffer == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Failed to allocate memory for LZ4 compression. Keeping uncompressed packet.");
+		return (packetSize);
+	}
+
+	char *data = ((char *) packet) + CAER_EVENT_PACKET_HEADER_SIZE;
+	int outSize;
+
+	if (state->fastCompressionLevel == 0) {
+		outSize = LZ4_compress_default(data, outBuffer, (int) dataSize, outBufferSize);
+	}
+	else {
+		outSize = LZ4_compress_HC(data, outBuffer, (int) dataSize, outBufferSize, state->fastCompressionLevel);
+	}
+
+	// If we don't gain any size advantages, just keep it uncompressed.
+	// Unlike PNG frames, this is expected for noisy data, so no need to log it.
+	if (outSize <= 0 || (size_t) outSize >= dataSize) {
+		free(outBuffer);
+		return (packetSize);
+	}
+
+	memcpy(data, outBuffer, (size_t) outSize);
+	free(outBuffer);
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + (size_t) outSize);
+}
+
+#endif
+
 /**
  * ============================================================================
  * OUTPUT THREAD
@@ -804,10 +1659,18 @@ static void libuvRingBufferGet(uv_idle_t *handle);
 static void libuvAsyncShutdown(uv_async_t *handle);
 static void libuvClientShutdown(uv_shutdown_t *clientShutdown, int status);
 static void libuvWriteStatusCheck(uv_handle_t *handle, int status);
-static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer);
+static void batchPacket(outputCommonState state, libuvWriteBuf packetBuffer);
+static void writeBatch(outputCommonState state);
+static void writeBatchStream(outputCommonState state);
+static void writeBatchUDP(outputCommonState state);
+static bool outputQueuesFull(outputCommonState state);
+static void updateBatchStatistics(outputCommonState state);
 static void initializeNetworkHeader(outputCommonState state);
 static bool writeNetworkHeader(outputCommonNetIO streams, libuvWriteBuf buf, bool startOfUDPPacket);
 static void writeFileHeader(outputCommonState state);
+static void writeSharedMemoryHeader(outputCommonState state);
+static bool writeSharedMemory(outputCommonState state, const uint8_t *data, size_t dataSize);
+static bool writeBuffer(outputCommonState state, libuvWriteBuf packetBuffer);
 
 static inline _Noreturn void errorExit(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Free currently held memory.
@@ -853,6 +1716,9 @@ static int outputThread(void *stateArg) {
 		if (state->isNetworkStream) {
 			initializeNetworkHeader(state);
 		}
+		else if (state->sharedMemory != NULL) {
+			writeSharedMemoryHeader(state);
+		}
 		else {
 			writeFileHeader(state);
 		}
@@ -876,7 +1742,7 @@ static int outputThread(void *stateArg) {
 		return (thrd_success);
 	}
 
-	// If destination is a file, just loop and write to it. Else start a libuv event loop.
+	// If destination is a file or shared memory, just loop and write to it. Else start a libuv event loop.
 	if (state->isNetworkStream) {
 		// libuv network IO (state->networkIO != NULL).
 		// Start libuv event loop.
@@ -903,8 +1769,11 @@ static int outputThread(void *stateArg) {
 				continue;
 			}
 
-			// Write buffer to file descriptor.
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
+			caerTraceEvent(CAER_TRACE_RINGBUFFER_GET, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+				CAER_TRACE_RING_OUTPUT_BUFFERS);
+
+			// Write buffer to file descriptor or shared memory.
+			if (!writeBuffer(state, packetBuffer)) {
 				errorExit(state, packetBuffer);
 			}
 
@@ -915,7 +1784,7 @@ static int outputThread(void *stateArg) {
 		// Write all remaining buffers to file.
 		libuvWriteBuf packetBuffer;
 		while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-			if (!writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len)) {
+			if (!writeBuffer(state, packetBuffer)) {
 				errorExit(state, packetBuffer);
 			}
 
@@ -930,19 +1799,47 @@ static int outputThread(void *stateArg) {
 static void libuvRingBufferGet(uv_idle_t *handle) {
 	outputCommonState state = handle->data;
 
-	// Write all packets that are currently available out in order,
-	// but never more than 10 at a time.
+	// Gather all packets that are currently available in order, writing them
+	// out as batches fill up, but never take more than 10 (or one full batch)
+	// at a time, to keep the event loop responsive.
+	size_t maxCount = (state->batch.maxPackets > MAX_OUTPUT_RINGBUFFER_GET) ?
+		(state->batch.maxPackets) : (MAX_OUTPUT_RINGBUFFER_GET);
 	size_t count = 0;
+
+	// When blocking, leave packets in the ring-buffer while clients are busy, so that
+	// backpressure reaches the mainloop instead of data being skipped here.
+	bool blocked = (atomic_load_explicit(&state->dropPolicy, memory_order_relaxed) == DROP_POLICY_BLOCK)
+		&& outputQueuesFull(state);
+
 	libuvWriteBuf packetBuffer;
-	while (count < MAX_OUTPUT_RINGBUFFER_GET && (packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-		writePacket(state, packetBuffer);
+	while (!blocked && count < maxCount && (packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
+		caerTraceEvent(CAER_TRACE_RINGBUFFER_GET, CAER_TRACE_INSTANT, state->parentModule->moduleID,
+			CAER_TRACE_RING_OUTPUT_BUFFERS);
+
+		batchPacket(state, packetBuffer);
 		count++;
 	}
 
+	// Write out a partial batch, once its first packet has waited long enough.
+	if (state->batch.packetsSize > 0) {
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		int64_t waitTime = I64T(currentTime.tv_sec - state->batch.firstPacketTime.tv_sec) * 1000000LL
+			+ I64T(currentTime.tv_nsec - state->batch.firstPacketTime.tv_nsec) / 1000;
+
+		if (waitTime >= state->batch.maxLatency) {
+			writeBatch(state);
+		}
+	}
+
+	updateBatchStatistics(state);
+
 	// If nothing, avoid busy loop within libuv event loop by sleeping a little.
+	// Less so if a partial batch is waiting, to not add too much latency.
 	if (count == 0) {
-		// Sleep for 1 ms.
-		struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = 1000000 };
+		// Sleep for 1 ms, or 100 µs.
+		struct timespec noDataSleep = { .tv_sec = 0, .tv_nsec = (state->batch.packetsSize > 0) ? (100000) : (1000000) };
 		thrd_sleep(&noDataSleep, NULL);
 	}
 }
@@ -962,9 +1859,11 @@ static void libuvAsyncShutdown(uv_async_t *handle) {
 	// Then we empty the ring-buffer and write out all data.
 	libuvWriteBuf packetBuffer;
 	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
-		writePacket(state, packetBuffer);
+		batchPacket(state, packetBuffer);
 	}
 
+	writeBatch(state);
+
 	// Shutdown server (if it exists).
 	if (state->networkIO->server != NULL) {
 		uv_close((uv_handle_t *) state->networkIO->server, &libuvCloseFree);
@@ -1033,15 +1932,39 @@ static void libuvWriteStatusCheck(uv_handle_t *handle, int status) {
 	}
 }
 
-static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
-	// If no active clients exist, don't write anything.
-	if (state->networkIO->activeClients == 0) {
-		free(packetBuffer->freeBuf);
-		free(packetBuffer);
+/**
+ * Add a packet to the current batch, taking ownership of its memory,
+ * and write the batch out if it's full.
+ *
+ * @param state common output state.
+ * @param packetBuffer packet to write out.
+ */
+static void batchPacket(outputCommonState state, libuvWriteBuf packetBuffer) {
+	if (state->batch.packetsSize == 0) {
+		portable_clock_gettime_monotonic(&state->batch.firstPacketTime);
+	}
+
+	state->batch.packets[state->batch.packetsSize++] = *packetBuffer;
+	state->batch.bytesSize += packetBuffer->buf.len;
+
+	free(packetBuffer);
+
+	if (state->batch.packetsSize >= state->batch.maxPackets) {
+		writeBatch(state);
+	}
+}
 
+static void writeBatch(outputCommonState state) {
+	if (state->batch.packetsSize == 0) {
 		return;
 	}
 
+	// If no active clients exist, don't write anything.
+	if (state->networkIO->activeClients == 0) {
+		for (size_t i = 0; i < state->batch.packetsSize; i++) {
+			free(state->batch.packets[i].freeBuf);
+		}
+	}
 	// Write packets to network. TCP/Pipe have their header already written in the
 	// Connection callbacks. Also, the size of the written data doesn't matter, as
 	// they are stream transports, and the network stack will take care of things
@@ -1049,106 +1972,295 @@ static void writePacket(outputCommonState state, libuvWriteBuf packetBuffer) {
 	// Only UDP needs special treatment here to write the proper header and split
 	// the packets up into manageable sizes (<=64K), together with keeping track
 	// of the sequence number.
+	else if (state->networkIO->isUDP) {
+		writeBatchUDP(state);
+	}
+	else {
+		writeBatchStream(state);
+	}
+
+	state->batch.packetsSize = 0;
+	state->batch.bytesSize = 0;
+}
+
+static bool outputQueuesFull(outputCommonState state) {
 	if (state->networkIO->isUDP) {
-		// UDP output.
-		// If too much data waiting to be sent, just skip current packet.
-		if (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
-			goto freePacketBufferUDP;
+		return (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE);
+	}
+
+	for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+		uv_stream_t *client = state->networkIO->clients[i];
+
+		if (client != NULL && client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
+			return (true);
 		}
+	}
 
-		size_t packetSize = packetBuffer->buf.len;
-		size_t packetIndex = 0;
-		bool firstChunk = true;
+	return (false);
+}
 
-		// Split packets up into chunks for UDP. Send each chunk with its own
-		// header and increasing sequence number. The very first packet of a chunk is
-		// identifiable by having a negative sequence number (highest bit set to one).
-		while (packetSize > 0) {
-			libuvWriteMultiBuf buffers = libuvWriteBufAlloc(2); // One for network header, one for data.
-			if (buffers == NULL) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
+static void writeBatchStream(outputCommonState state) {
+	// TCP/Pipe outputs.
+	// Prepare buffers, one per packet, so they go out in one vectored write.
+	libuvWriteMultiBuf buffers = libuvWriteBufAlloc(state->batch.packetsSize);
+	if (buffers == NULL) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
 
-				goto freePacketBufferUDP;
-			}
+		for (size_t i = 0; i < state->batch.packetsSize; i++) {
+			free(state->batch.packets[i].freeBuf);
+		}
+		return;
+	}
 
-			buffers->statusCheck = &libuvWriteStatusCheck;
+	buffers->statusCheck = &libuvWriteStatusCheck;
 
-			// Write header into first buffer.
-			if (!writeNetworkHeader(state->networkIO, &buffers->buffers[0], firstChunk)) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to write network header.");
+	memcpy(buffers->buffers, state->batch.packets, state->batch.packetsSize * sizeof(struct libuvWriteBufStruct));
 
-				libuvWriteBufFree(buffers);
-				goto freePacketBufferUDP;
-			}
+	// Increase reference count, one per client.
+	buffers->refCount = state->networkIO->activeClients;
 
-			firstChunk = false;
+	// Write to each client, but use common reference-counted buffer.
+	for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
+		uv_stream_t *client = state->networkIO->clients[i];
 
-			// Write data into second buffer.
-			size_t sendSize = (packetSize > AEDAT3_MAX_UDP_SIZE) ? (AEDAT3_MAX_UDP_SIZE) : (packetSize);
+		if (client == NULL) {
+			continue;
+		}
 
-			libuvWriteBufInit(&buffers->buffers[1], sendSize);
-			if (buffers->buffers[1].buf.base == NULL) {
-				caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for data buffer.");
+		// If too much data waiting to be sent, skip current batch for this client.
+		if (client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
+			atomic_fetch_add_explicit(&state->drops.droppedOutput, state->batch.packetsSize, memory_order_relaxed);
 
-				libuvWriteBufFree(buffers);
-				goto freePacketBufferUDP;
-			}
+			libuvWriteBufFree(buffers);
+			continue;
+		}
 
-			memcpy(buffers->buffers[1].buf.base, packetBuffer->buf.base + packetIndex, sendSize);
+		int retVal = libuvWrite(client, buffers);
+		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers);
+			continue);
 
-			// For UDP we only support client mode to ONE outside address.
-			int retVal = libuvWriteUDP((uv_udp_t *) state->networkIO->clients[0], state->networkIO->address, buffers);
-			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDP",
-				libuvWriteBufFree(buffers); goto freePacketBufferUDP);
+		state->batch.writes++;
+		state->batch.writesBytes += state->batch.bytesSize;
+	}
+}
 
-			// Update loop indexes.
-			packetSize -= sendSize;
-			packetIndex += sendSize;
-		}
+static void writeBatchUDP(outputCommonState state) {
+	// UDP output.
+	// If too much data waiting to be sent, just skip current batch.
+	if (((uv_udp_t *) state->networkIO->clients[0])->send_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
+		atomic_fetch_add_explicit(&state->drops.droppedOutput, state->batch.packetsSize, memory_order_relaxed);
 
-		// Free all packet memory.
-		freePacketBufferUDP: {
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
-		}
+		goto freePacketBuffersUDP;
 	}
-	else {
-		// TCP/Pipe outputs.
-		// Prepare buffers, increase reference count.
-		libuvWriteMultiBuf buffers = libuvWriteBufAlloc(1);
+
+	size_t packetIndex = 0;
+	size_t packetOffset = 0;
+	size_t remainingSize = state->batch.bytesSize;
+
+	// Split packets up into chunks for UDP, filling each one with data from
+	// consecutive packets up to the maximum size. Send each chunk with its own
+	// header and increasing sequence number. Chunks starting with a new packet
+	// are identifiable by having a negative sequence number (highest bit set to one).
+	while (remainingSize > 0) {
+		libuvWriteMultiBuf buffers = libuvWriteBufAlloc(2); // One for network header, one for data.
 		if (buffers == NULL) {
 			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for network buffers.");
 
-			free(packetBuffer->freeBuf);
-			free(packetBuffer);
-			return;
+			goto freePacketBuffersUDP;
 		}
 
 		buffers->statusCheck = &libuvWriteStatusCheck;
 
-		buffers->refCount = state->networkIO->activeClients;
+		// Write header into first buffer.
+		if (!writeNetworkHeader(state->networkIO, &buffers->buffers[0], (packetOffset == 0))) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to write network header.");
 
-		buffers->buffers[0] = *packetBuffer;
-		free(packetBuffer);
+			libuvWriteBufFree(buffers);
+			goto freePacketBuffersUDP;
+		}
+
+		// Write data into second buffer.
+		size_t sendSize = (remainingSize > AEDAT3_MAX_UDP_SIZE) ? (AEDAT3_MAX_UDP_SIZE) : (remainingSize);
+
+		libuvWriteBufInit(&buffers->buffers[1], sendSize);
+		if (buffers->buffers[1].buf.base == NULL) {
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate memory for data buffer.");
+
+			libuvWriteBufFree(buffers);
+			goto freePacketBuffersUDP;
+		}
+
+		for (size_t chunkOffset = 0; chunkOffset < sendSize;) {
+			libuvWriteBuf packet = &state->batch.packets[packetIndex];
+
+			size_t copySize = packet->buf.len - packetOffset;
+			if (copySize > (sendSize - chunkOffset)) {
+				copySize = sendSize - chunkOffset;
+			}
+
+			memcpy(buffers->buffers[1].buf.base + chunkOffset, packet->buf.base + packetOffset, copySize);
+
+			chunkOffset += copySize;
+			packetOffset += copySize;
+
+			// Packet fully sent, continue with next one.
+			if (packetOffset == packet->buf.len) {
+				packetIndex++;
+				packetOffset = 0;
+			}
+		}
+
+		// For UDP we only support client mode to ONE outside address.
+		int retVal = libuvWriteUDP((uv_udp_t *) state->networkIO->clients[0], state->networkIO->address, buffers);
+		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWriteUDP",
+			libuvWriteBufFree(buffers); goto freePacketBuffersUDP);
+
+		state->batch.writes++;
+		state->batch.writesBytes += buffers->buffers[0].buf.len + sendSize;
+
+		// Update loop indexes.
+		remainingSize -= sendSize;
+	}
 
-		// Write to each client, but use common reference-counted buffer.
-		for (size_t i = 0; i < state->networkIO->clientsSize; i++) {
-			uv_stream_t *client = state->networkIO->clients[i];
+	// Free all packet memory.
+	freePacketBuffersUDP: {
+		for (size_t i = 0; i < state->batch.packetsSize; i++) {
+			free(state->batch.packets[i].freeBuf);
+		}
+	}
+}
+
+static void updateBatchStatistics(outputCommonState state) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	int64_t elapsedTime = I64T(currentTime.tv_sec - state->batch.statisticsTime.tv_sec) * 1000000LL
+		+ I64T(currentTime.tv_nsec - state->batch.statisticsTime.tv_nsec) / 1000;
+
+	// Update once per second.
+	if (elapsedTime < 1000000) {
+		return;
+	}
+
+	int64_t writesPerSecond = I64T(state->batch.writes * 1000000 / (uint64_t) elapsedTime);
+	int64_t bytesPerWrite = (state->batch.writes == 0) ? (0) : I64T(state->batch.writesBytes / state->batch.writes);
+
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "writesPerSecond", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = writesPerSecond });
+	sshsNodeUpdateReadOnlyAttribute(state->parentModule->moduleNode, "bytesPerWrite", SSHS_LONG,
+		(union sshs_node_attr_value ) { .ilong = bytesPerWrite });
+
+	state->batch.writes = 0;
+	state->batch.writesBytes = 0;
+	state->batch.statisticsTime = currentTime;
+}
+
+static void writeSharedMemoryHeader(outputCommonState state) {
+	// Same AEDAT 3.1 header as for network streams, readers parse it first.
+	struct aedat3_network_header networkHeader;
+	networkHeader.magicNumber = htole64(AEDAT3_NETWORK_MAGIC_NUMBER);
+	networkHeader.sequenceNumber = htole64(0);
+	networkHeader.versionNumber = AEDAT3_NETWORK_VERSION;
+	networkHeader.formatNumber = state->formatID; // Send numeric format ID.
+	networkHeader.sourceID = htole16(I16T(atomic_load(&state->sourceID))); // Always one source per output module.
+
+	memcpy(state->sharedMemory->networkHeader, &networkHeader, AEDAT3_NETWORK_HEADER_LENGTH);
+
+	atomic_store(&state->sharedMemory->headerValid, true);
+}
 
-			if (client == NULL) {
+/**
+ * Publish one packet to the shared-memory ring. The packet is only written if
+ * all active readers have consumed enough data to make space for it, else
+ * it is dropped (or, with the block drop policy, we wait for the readers).
+ * Readers that died without releasing their slot are detected and removed
+ * here, so they can't block the ring forever.
+ *
+ * @param state common output state.
+ * @param data packet memory.
+ * @param dataSize packet size in bytes.
+ *
+ * @return true on success or drop, false on unrecoverable failure.
+ */
+static bool writeSharedMemory(outputCommonState state, const uint8_t *data, size_t dataSize) {
+	struct aedat3_shm_ring *ring = state->sharedMemory;
+
+	if (dataSize > ring->dataSize) {
+		caerModuleLog(state->parentModule, CAER_LOG_ERROR,
+			"Packet of %zu bytes can never fit into shared-memory ring of %" PRIu64 " bytes, dropping it.", dataSize,
+			ring->dataSize);
+		return (true);
+	}
+
+	// Only we ever change the write position.
+	uint64_t writePosition = atomic_load_explicit(&ring->writePosition, memory_order_relaxed);
+
+	while (true) {
+		// Find the slowest active reader.
+		uint64_t minReadPosition = writePosition;
+
+		for (size_t i = 0; i < AEDAT3_SHM_MAX_READERS; i++) {
+			int32_t processID = I32T(atomic_load_explicit(&ring->readers[i].processID, memory_order_acquire));
+			if (processID == 0) {
 				continue;
 			}
 
-			// If too much data waiting to be sent, just skip current packet.
-			if (client->write_queue_size > MAX_OUTPUT_QUEUED_SIZE) {
-				libuvWriteBufFree(buffers);
-				return;
+			uint64_t readPosition = atomic_load_explicit(&ring->readers[i].readPosition, memory_order_acquire);
+
+			// Check if readers blocking us are still alive, free their slot if not.
+			if ((writePosition + dataSize - readPosition) > ring->dataSize) {
+#if defined(OS_UNIX) && OS_UNIX == 1
+				if (kill(processID, 0) != 0 && errno == ESRCH) {
+					atomic_store(&ring->readers[i].processID, 0);
+
+					caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+						"Shared-memory reader with PID %" PRIi32 " went away, releasing its slot.", processID);
+					continue;
+				}
+#endif
+			}
+
+			if ((writePosition - readPosition) > (writePosition - minReadPosition)) {
+				minReadPosition = readPosition;
 			}
+		}
+
+		if ((writePosition + dataSize - minReadPosition) <= ring->dataSize) {
+			break;
+		}
+
+		// Not enough space: drop packet, unless we must keep them all.
+		if (atomic_load_explicit(&state->dropPolicy, memory_order_relaxed) != DROP_POLICY_BLOCK
+			|| !atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			atomic_fetch_add_explicit(&state->drops.droppedOutput, 1, memory_order_relaxed);
 
-			int retVal = libuvWrite(client, buffers);
-			UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "libuvWrite", libuvWriteBufFree(buffers));
+			return (true);
 		}
+
+		// Delay by 100 µs, give readers time to catch up.
+		struct timespec waitSleep = { .tv_sec = 0, .tv_nsec = 100000 };
+		thrd_sleep(&waitSleep, NULL);
+	}
+
+	// Copy packet into ring, wrapping around at the end.
+	size_t dataOffset = (size_t) (writePosition % ring->dataSize);
+	size_t firstSize = (dataSize < (ring->dataSize - dataOffset)) ? (dataSize) : (size_t) (ring->dataSize - dataOffset);
+
+	memcpy(ring->data + dataOffset, data, firstSize);
+	memcpy(ring->data, data + firstSize, dataSize - firstSize);
+
+	// Publish whole packet to readers.
+	atomic_store_explicit(&ring->writePosition, writePosition + dataSize, memory_order_release);
+
+	return (true);
+}
+
+static bool writeBuffer(outputCommonState state, libuvWriteBuf packetBuffer) {
+	if (state->sharedMemory != NULL) {
+		return (writeSharedMemory(state, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len));
 	}
+
+	return (writeUntilDone(state->fileIO, (uint8_t *) packetBuffer->buf.base, packetBuffer->buf.len));
 }
 
 static void initializeNetworkHeader(outputCommonState state) {
@@ -1205,18 +2317,29 @@ static void writeFileHeader(outputCommonState state) {
 		writeUntilDone(state->fileIO, (const uint8_t *) "RAW", 3);
 	}
 	else {
-		// Support the various formats and their mixing.
-		if (state->formatID == 0x01) {
+		// Support the various formats and their mixing, separated by commas.
+		bool firstFormat = true;
+
+		if (state->formatID & 0x01) {
 			writeUntilDone(state->fileIO, (const uint8_t *) "SerializedTS", 12);
+			firstFormat = false;
 		}
 
-		if (state->formatID == 0x02) {
+		if (state->formatID & 0x02) {
+			if (!firstFormat) {
+				writeUntilDone(state->fileIO, (const uint8_t *) ",", 1);
+			}
+
 			writeUntilDone(state->fileIO, (const uint8_t *) "PNGFrames", 9);
+			firstFormat = false;
 		}
 
-		if (state->formatID == 0x03) {
-			// Serial and PNG together.
-			writeUntilDone(state->fileIO, (const uint8_t *) "SerializedTS,PNGFrames", 12 + 1 + 9);
+		if (state->formatID & 0x04) {
+			if (!firstFormat) {
+				writeUntilDone(state->fileIO, (const uint8_t *) ",", 1);
+			}
+
+			writeUntilDone(state->fileIO, (const uint8_t *) "LZ4", 3);
 		}
 	}
 
@@ -1319,7 +2442,7 @@ void caerOutputCommonOnServerConnection(uv_stream_t *server, int status) {
 			retVal = libuvWrite(client, buffers);
 			UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto killConnection);
 
-			// Ready now for more data, so set client field for writePacket().
+			// Ready now for more data, so set client field for writeBatch().
 			streams->clients[i] = client;
 			streams->activeClients++;
 
@@ -1360,7 +2483,7 @@ void caerOutputCommonOnClientConnection(uv_connect_t *connectionRequest, int sta
 	int retVal = libuvWrite(connectionRequest->handle, buffers);
 	UV_RET_CHECK(retVal, __func__, "libuvWrite", libuvWriteBufFree(buffers); goto cleanupRequest);
 
-	// Ready now for more data, so set client field for writePacket().
+	// Ready now for more data, so set client field for writeBatch().
 	streams->clients[0] = connectionRequest->handle;
 	streams->activeClients++;
 
@@ -1375,7 +2498,8 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	state->parentModule = moduleData;
 
 	// Check for invalid input combinations.
-	if ((fileDescriptor < 0 && streams == NULL) || (fileDescriptor != -1 && streams != NULL)) {
+	if ((fileDescriptor < 0 && streams == NULL && state->sharedMemory == NULL)
+		|| (fileDescriptor != -1 && (streams != NULL || state->sharedMemory != NULL))) {
 		return (false);
 	}
 
@@ -1384,6 +2508,17 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 	state->fileIO = fileDescriptor;
 	state->networkIO = streams;
 
+	// The packet index only makes sense for files, where packets have a fixed position.
+	// For files, indexFileIO was already set by the file output module.
+	if (state->isNetworkStream) {
+		state->indexFileIO = -1;
+	}
+
+	// Shared memory has no file position either.
+	if (state->sharedMemory != NULL) {
+		state->indexFileIO = -1;
+	}
+
 	// If in server mode, add SSHS attribute to track connected client IPs.
 	if (state->isNetworkStream && state->networkIO->server != NULL) {
 		sshsNodeCreateString(state->parentModule->moduleNode, "connectedClients", "", 0, INT32_MAX,
@@ -1395,18 +2530,81 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 
 	// Handle configuration.
 	sshsNodeCreateBool(moduleData->moduleNode, "validOnly", false, SSHS_FLAGS_NORMAL, "Only send valid events.");
-	sshsNodeCreateBool(moduleData->moduleNode, "keepPackets", false, SSHS_FLAGS_NORMAL,
-		"Ensure all packets are kept (stall output if transfer-buffer full).");
+	sshsNodeCreateString(moduleData->moduleNode, "dropPolicy", "dropNewest", 5, 10, SSHS_FLAGS_NORMAL,
+		"What to do if data comes in faster than it can be sent out: 'block' (stall mainloop, keep all packets), "
+			"'dropNewest', 'dropOldest' or 'decimate' (thin out polarity events under load).");
+	sshsNodeCreateBool(moduleData->moduleNode, "keepSpecialEvents", true, SSHS_FLAGS_NORMAL,
+		"Never drop special and IMU events, independent of the drop policy.");
 	sshsNodeCreateInt(moduleData->moduleNode, "ringBufferSize", 512, 8, 4096, SSHS_FLAGS_NORMAL,
 		"Size of EventPacketContainer and EventPacket queues, used for transfers between mainloop and output threads.");
 
 	atomic_store(&state->validOnly, sshsNodeGetBool(moduleData->moduleNode, "validOnly"));
-	atomic_store(&state->keepPackets, sshsNodeGetBool(moduleData->moduleNode, "keepPackets"));
+	atomic_store(&state->keepSpecialEvents, sshsNodeGetBool(moduleData->moduleNode, "keepSpecialEvents"));
 	int ringSize = sshsNodeGetInt(moduleData->moduleNode, "ringBufferSize");
 
+	char *dropPolicy = sshsNodeGetString(moduleData->moduleNode, "dropPolicy");
+	atomic_store(&state->dropPolicy, parseDropPolicy(dropPolicy));
+	free(dropPolicy);
+
+	// Drop accounting, read-only.
+	sshsNodeCreateLong(moduleData->moduleNode, "droppedNewest", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Packet containers dropped on arrival, as output was full.");
+	sshsNodeCreateLong(moduleData->moduleNode, "droppedOldest", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Queued packet containers dropped to make space for new ones.");
+	sshsNodeCreateLong(moduleData->moduleNode, "decimatedEvents", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Polarity events removed by decimation.");
+	sshsNodeCreateLong(moduleData->moduleNode, "droppedOutput", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Packets not sent, as network clients or readers were too slow.");
+	sshsNodeCreateLong(moduleData->moduleNode, "keptPackets", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Special and IMU packets saved from dropped packet containers.");
+	sshsNodeCreateLong(moduleData->moduleNode, "blockedTime", 0, 0, INT64_MAX,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Time the mainloop waited for output space, in µs.");
+	sshsNodeCreateInt(moduleData->moduleNode, "decimationFactor", 1, 1, MAX_OUTPUT_DECIMATION,
+		SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Current decimation, one polarity event kept out of this many.");
+
+	state->drops.decimationFactor = 1;
+	portable_clock_gettime_monotonic(&state->drops.decimationTime);
+	state->drops.statisticsTime = state->drops.decimationTime;
+
 	// Format configuration (compression modes).
+	sshsNodeCreateBool(moduleData->moduleNode, "compressTimestamps", false, SSHS_FLAGS_NORMAL,
+		"Compress polarity events by serializing repeated timestamps (takes effect on restart).");
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	sshsNodeCreateBool(moduleData->moduleNode, "compressFramesPNG", false, SSHS_FLAGS_NORMAL,
+		"Compress frame events using PNG (takes effect on restart).");
+#endif
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	sshsNodeCreateBool(moduleData->moduleNode, "compressFast", false, SSHS_FLAGS_NORMAL,
+		"Compress frame and polarity events using LZ4, in place of the above (takes effect on restart).");
+	sshsNodeCreateInt(moduleData->moduleNode, "compressFastLevel", 0, 0, 12, SSHS_FLAGS_NORMAL,
+		"LZ4 compression level: 0 is fastest, 1-12 use LZ4HC for smaller output (takes effect on restart).");
+#endif
+	sshsNodeCreateInt(moduleData->moduleNode, "compressorThreads", 2, 0, 16, SSHS_FLAGS_NORMAL,
+		"Number of threads compressing packets in parallel, 0 to compress in the compressor thread itself.");
+
 	state->formatID = 0x00; // RAW format by default.
 
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressTimestamps")) {
+		state->formatID |= 0x01;
+	}
+
+#ifdef ENABLE_INOUT_PNG_COMPRESSION
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressFramesPNG")) {
+		state->formatID |= 0x02;
+	}
+#endif
+
+#ifdef ENABLE_INOUT_LZ4_COMPRESSION
+	if (sshsNodeGetBool(moduleData->moduleNode, "compressFast")) {
+		state->formatID |= 0x04;
+	}
+
+	state->fastCompressionLevel = sshsNodeGetInt(moduleData->moduleNode, "compressFastLevel");
+#endif
+
+	// compressorThreads only changes here at init time!
+	state->compressorThreadsNumber = (size_t) sshsNodeGetInt(moduleData->moduleNode, "compressorThreads");
+
 	// Initialize compressor ring-buffer. ringBufferSize only changes here at init time!
 	state->compressorRing = caerRingBufferInit((size_t) ringSize);
 	if (state->compressorRing == NULL) {
@@ -1425,21 +2623,65 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 
 	// If network output, initialize common libuv components.
 	if (state->isNetworkStream) {
+		// Write batching configuration.
+		sshsNodeCreateInt(moduleData->moduleNode, "batchMaxPackets", 1, 1, 256, SSHS_FLAGS_NORMAL,
+			"Maximum number of packets to send together in one write, 1 disables batching (takes effect on restart).");
+		sshsNodeCreateInt(moduleData->moduleNode, "batchMaxLatency", 1000, 0, 100000, SSHS_FLAGS_NORMAL,
+			"Maximum time in µs a packet can wait for its batch to fill up (takes effect on restart).");
+
+		sshsNodeCreateLong(moduleData->moduleNode, "writesPerSecond", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Number of network writes per second.");
+		sshsNodeCreateLong(moduleData->moduleNode, "bytesPerWrite", 0, 0, INT64_MAX,
+			SSHS_FLAGS_READ_ONLY | SSHS_FLAGS_NO_EXPORT, "Average number of bytes per network write.");
+
+		// batchMaxPackets and batchMaxLatency only change here at init time!
+		state->batch.maxPackets = (size_t) sshsNodeGetInt(moduleData->moduleNode, "batchMaxPackets");
+		state->batch.maxLatency = sshsNodeGetInt(moduleData->moduleNode, "batchMaxLatency");
+
+		state->batch.packets = calloc(state->batch.maxPackets, sizeof(struct libuvWriteBufStruct));
+		if (state->batch.packets == NULL) {
+			caerRingBufferFree(state->compressorRing);
+			caerRingBufferFree(state->outputRing);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate write batch.");
+			return (false);
+		}
+
+		portable_clock_gettime_monotonic(&state->batch.statisticsTime);
+
 		// Add support for asynchronous shutdown (from caerOutputCommonExit()).
 		state->networkIO->shutdown.data = state;
 		int retVal = uv_async_init(&state->networkIO->loop, &state->networkIO->shutdown, &libuvAsyncShutdown);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_async_init",
-			caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+			free(state->batch.packets); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
 
 		// Use idle handles to check for new data on every loop run.
 		state->networkIO->ringBufferGet.data = state;
 		retVal = uv_idle_init(&state->networkIO->loop, &state->networkIO->ringBufferGet);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_init",
-			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); free(state->batch.packets); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
 
 		retVal = uv_idle_start(&state->networkIO->ringBufferGet, &libuvRingBufferGet);
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_idle_start",
-			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL); uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL); uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL); free(state->batch.packets); caerRingBufferFree(state->compressorRing); caerRingBufferFree(state->outputRing); return (false));
+	}
+
+	// Buffer packet index entries, if requested.
+	if (state->indexFileIO >= 0) {
+		state->indexBuffer = simpleBufferInit(1024 * sizeof(struct aedat3_index_entry));
+		if (state->indexBuffer == NULL) {
+			if (state->isNetworkStream) {
+				uv_idle_stop(&state->networkIO->ringBufferGet);
+				uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
+				uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
+			}
+			free(state->batch.packets);
+			caerRingBufferFree(state->compressorRing);
+			caerRingBufferFree(state->outputRing);
+
+			caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to allocate packet index buffer.");
+			return (false);
+		}
 	}
 
 	// Start output handling thread.
@@ -1451,8 +2693,10 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
 		}
+		free(state->batch.packets);
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
+		free(state->indexBuffer);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start compressor thread.");
 		return (false);
@@ -1473,8 +2717,10 @@ bool caerOutputCommonInit(caerModuleData moduleData, int fileDescriptor, outputC
 			uv_close((uv_handle_t *) &state->networkIO->ringBufferGet, NULL);
 			uv_close((uv_handle_t *) &state->networkIO->shutdown, NULL);
 		}
+		free(state->batch.packets);
 		caerRingBufferFree(state->compressorRing);
 		caerRingBufferFree(state->outputRing);
+		free(state->indexBuffer);
 
 		caerModuleLog(state->parentModule, CAER_LOG_ERROR, "Failed to start output thread.");
 		return (false);
@@ -1512,7 +2758,7 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 	caerEventPacketContainer packetContainer;
 
 	while ((packetContainer = caerRingBufferGet(state->compressorRing)) != NULL) {
-		caerEventPacketContainerFree(packetContainer);
+		caerMainloopPacketContainerRelease(packetContainer);
 
 		// This should never happen!
 		caerModuleLog(state->parentModule, CAER_LOG_CRITICAL, "Compressor ring-buffer was not empty!");
@@ -1520,6 +2766,19 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 
 	caerRingBufferFree(state->compressorRing);
 
+	// Release packets the drop policy still held back.
+	for (size_t i = 0; i < state->drops.pendingContainersSize; i++) {
+		caerMainloopPacketContainerRelease(state->drops.pendingContainers[i]);
+	}
+
+	state->drops.pendingContainersSize = 0;
+
+	for (size_t i = 0; i < state->drops.savedPacketsSize; i++) {
+		caerMainloopPacketRelease(state->drops.savedPackets[i]);
+	}
+
+	state->drops.savedPacketsSize = 0;
+
 	libuvWriteBuf packetBuffer;
 
 	while ((packetBuffer = caerRingBufferGet(state->outputRing)) != NULL) {
@@ -1546,15 +2805,28 @@ void caerOutputCommonExit(caerModuleData moduleData) {
 		UV_RET_CHECK(retVal, state->parentModule->moduleSubSystemString, "uv_loop_close",);
 
 		// Free allocated memory. libuv already frees all client/server related memory.
+		// The write batch was emptied on shutdown.
+		free(state->batch.packets);
 		free(state->networkIO->address);
 		free(state->networkIO);
 	}
+	else if (state->sharedMemory != NULL) {
+		// Shared memory is owned by the shared-memory output module, which cleans it up.
+	}
 	else {
 		// Ensure all data written to disk.
 		portable_fsync(state->fileIO);
 
 		// Close file descriptor.
 		close(state->fileIO);
+
+		// Same for the packet index, if any. All entries were flushed by the compressor thread.
+		if (state->indexFileIO >= 0) {
+			portable_fsync(state->indexFileIO);
+			close(state->indexFileIO);
+		}
+
+		free(state->indexBuffer);
 	}
 
 	free(state->sourceInfoString);
@@ -1580,9 +2852,20 @@ static void caerOutputCommonConfigListener(sshsNode node, void *userData, enum s
 			// Set valid only flag to given value.
 			atomic_store(&state->validOnly, changeValue.boolean);
 		}
-		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "keepPackets")) {
-			// Set keep packets flag to given value.
-			atomic_store(&state->keepPackets, changeValue.boolean);
+		else if (changeType == SSHS_STRING && caerStrEquals(changeKey, "dropPolicy")) {
+			// Switch drop policy, unknown values fall back to dropping new packets.
+			enum output_common_drop_policy dropPolicy = parseDropPolicy(changeValue.string);
+
+			if (dropPolicy == DROP_POLICY_DROP_NEWEST && !caerStrEquals(changeValue.string, "dropNewest")) {
+				caerModuleLog(state->parentModule, CAER_LOG_WARNING,
+					"Unknown drop policy '%s', using 'dropNewest'.", changeValue.string);
+			}
+
+			atomic_store(&state->dropPolicy, dropPolicy);
+		}
+		else if (changeType == SSHS_BOOL && caerStrEquals(changeKey, "keepSpecialEvents")) {
+			// Set keep special events flag to given value.
+			atomic_store(&state->keepSpecialEvents, changeValue.boolean);
 		}
 	}
 }
@@ -4,6 +4,7 @@
 #include "base/module.h"
 #include "modules/misc/inout_common.h"
 #include "ext/libuv.h"
+#include "ext/buffers.h"
 #include <libcaer/ringbuffer.h>
 
 #ifdef HAVE_PTHREADS
@@ -12,6 +13,9 @@
 
 #define MAX_OUTPUT_RINGBUFFER_GET 10
 #define MAX_OUTPUT_QUEUED_SIZE (1 * 1024 * 1024) // 1MB outstanding writes
+#define MAX_OUTPUT_SAVED_PACKETS 64 // Special/IMU packets kept aside from dropped containers.
+#define MAX_OUTPUT_PENDING_CONTAINERS 8 // Containers waiting for the compressor to drop the oldest ones.
+#define MAX_OUTPUT_DECIMATION 64
 
 struct output_common_netio {
 	/// Keep the full network header around, so we can easily update and write it.
@@ -31,6 +35,71 @@ struct output_common_netio {
 
 typedef struct output_common_netio *outputCommonNetIO;
 
+enum output_common_drop_policy {
+	/// Wait for space, stalling the mainloop if needed. Nothing is lost.
+	DROP_POLICY_BLOCK = 0,
+	/// Drop new packet containers that don't fit.
+	DROP_POLICY_DROP_NEWEST = 1,
+	/// Drop the oldest queued packet containers, to make space for new ones.
+	DROP_POLICY_DROP_OLDEST = 2,
+	/// Reduce the number of polarity events while under pressure, drop new containers if still needed.
+	DROP_POLICY_DECIMATE = 3,
+};
+
+struct output_common_drops {
+	/// Packet containers dropped on arrival, because the compressor ring-buffer was full.
+	atomic_uint_fast64_t droppedNewest;
+	/// Packet containers dropped from the head of the compressor ring-buffer, to make space.
+	atomic_uint_fast64_t droppedOldest;
+	/// Polarity events removed by decimation.
+	atomic_uint_fast64_t decimatedEvents;
+	/// Packets not sent, because network clients or shared-memory readers were too slow.
+	atomic_uint_fast64_t droppedOutput;
+	/// Special and IMU packets saved from dropped packet containers.
+	atomic_uint_fast64_t keptPackets;
+	/// Time the mainloop spent waiting for space in the compressor ring-buffer, in µs.
+	atomic_uint_fast64_t blockedTime;
+	/// Requests from the mainloop to drop the oldest packet containers.
+	atomic_uint_fast32_t dropOldestRequests;
+	/// Full compressor ring-buffer events, since the decimation factor was last adjusted.
+	atomic_uint_fast32_t overflows;
+	/// Keep one polarity event out of this many. Compressor thread only.
+	int32_t decimationFactor;
+	/// Last time the decimation factor was adjusted. Compressor thread only.
+	struct timespec decimationTime;
+	/// Last time the statistics were published. Compressor thread only.
+	struct timespec statisticsTime;
+	/// Packet containers waiting for space, for the drop oldest policy, oldest first. Mainloop only.
+	/// Each one has a matching request to the compressor thread to drop the oldest queued container.
+	caerEventPacketContainer pendingContainers[MAX_OUTPUT_PENDING_CONTAINERS];
+	/// Number of pending packet containers.
+	size_t pendingContainersSize;
+	/// Special and IMU packets saved from dropped containers, waiting for space. Mainloop only.
+	caerEventPacketHeader savedPackets[MAX_OUTPUT_SAVED_PACKETS];
+	/// Number of saved packets.
+	size_t savedPacketsSize;
+};
+
+struct output_common_batch {
+	/// Maximum number of packets to coalesce into one network write.
+	size_t maxPackets;
+	/// Maximum time the first packet may wait for the batch to fill up, in µs.
+	int64_t maxLatency;
+	/// Packets gathered for the next network write.
+	struct libuvWriteBufStruct *packets;
+	/// Number of packets currently gathered.
+	size_t packetsSize;
+	/// Total size of the packets currently gathered, in bytes.
+	size_t bytesSize;
+	/// Time the first packet of the current batch was gathered.
+	struct timespec firstPacketTime;
+	/// Write calls and bytes written since last statistics update.
+	uint64_t writes;
+	uint64_t writesBytes;
+	/// Time of last statistics update.
+	struct timespec statisticsTime;
+};
+
 struct output_common_statistics {
 	uint64_t packetsNumber;
 	uint64_t packetsTotalSize;
@@ -39,6 +108,42 @@ struct output_common_statistics {
 	uint64_t dataWritten;
 };
 
+struct output_common_compressor_job {
+	/// Event packet to compress, owned by the job until committed.
+	caerEventPacketHeader packet;
+	/// Packet size (header + data), updated after compression.
+	size_t packetSize;
+	/// Packet index information, taken before compression.
+	struct aedat3_index_entry indexEntry;
+	/// Compression finished, packet can be committed to the output thread.
+	bool done;
+};
+
+struct output_common_compressor_pool {
+	/// Number of running compression worker threads. Zero means compress inline.
+	size_t workersNumber;
+	/// Compression worker threads.
+	thrd_t *workers;
+	/// Protects all the job queue fields below.
+	mtx_t lock;
+	/// Signal workers that there are new jobs, or that they have to shut down.
+	cnd_t jobAvailable;
+	/// Signal the compressor thread that a job has been completed.
+	cnd_t jobDone;
+	/// Workers exit once the queue is empty and this is set.
+	bool shutdown;
+	/// Monotonic job counters: next to commit (in order), next to be claimed
+	/// by a worker, and next free slot. Always head <= next <= tail.
+	size_t jobsHead;
+	size_t jobsNext;
+	size_t jobsTail;
+	/// Circular job queue, preserving the order in which packets were submitted.
+	size_t jobsSize;
+	struct output_common_compressor_job *jobs;
+};
+
+typedef struct output_common_compressor_pool *outputCommonCompressorPool;
+
 struct output_common_state {
 	/// Control flag for output handling thread.
 	atomic_bool running;
@@ -57,16 +162,30 @@ struct output_common_state {
 	char *sourceInfoString;
 	/// The file descriptor for file writing.
 	int fileIO;
+	/// The file descriptor for writing the packet index, -1 if disabled.
+	/// Set by the file output module before initialization, files only.
+	int indexFileIO;
+	/// Buffer packet index entries, to write them out in larger blocks.
+	simpleBuffer indexBuffer;
 	/// Network-like stream or file-like stream. Matters for header format.
 	bool isNetworkStream;
 	/// The libuv stream descriptors for network writing and server mode.
 	outputCommonNetIO networkIO;
+	/// Coalesce packets into fewer, larger network writes.
+	struct output_common_batch batch;
+	/// Shared-memory ring for output to local processes, NULL if not used.
+	/// Set by the shared-memory output module before initialization.
+	struct aedat3_shm_ring *sharedMemory;
 	/// Filter out invalidated events or not.
 	atomic_bool validOnly;
-	/// Force all incoming packets to be committed to the transfer ring-buffer.
-	/// This results in no loss of data, but may slow down processing considerably.
+	/// What to do when data comes in faster than it can go out (enum output_common_drop_policy).
+	/// Blocking results in no loss of data, but may slow down processing considerably.
 	/// It may also block it altogether, if the output goes away for any reason.
-	atomic_bool keepPackets;
+	atomic_int_fast32_t dropPolicy;
+	/// Never drop special and IMU events, independent of the drop policy.
+	atomic_bool keepSpecialEvents;
+	/// Drop policy state and accounting.
+	struct output_common_drops drops;
 	/// Transfer packets coming from a mainloop run to the compression handling thread.
 	/// We use EventPacketContainers as data structure for convenience, they do exactly
 	/// keep track of the data we do want to transfer and are part of libcaer.
@@ -77,6 +196,12 @@ struct output_common_state {
 	int64_t lastTimestamp;
 	/// Support different formats, providing data compression.
 	int8_t formatID;
+	/// Fast compression level: 0 is the fastest mode, higher values trade speed for size.
+	int fastCompressionLevel;
+	/// Requested number of compression worker threads (init-time only).
+	size_t compressorThreadsNumber;
+	/// Parallel compression of packets, committed in order by the compressor thread.
+	struct output_common_compressor_pool compressorPool;
 	/// Output module statistics collection.
 	struct output_common_statistics statistics;
 	/// Reference to parent module's original data.
@@ -0,0 +1,122 @@
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "output_common.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_SHM_NAME_LENGTH 250
+
+static bool caerOutputSharedMemoryInit(caerModuleData moduleData);
+static void caerOutputSharedMemoryExit(caerModuleData moduleData);
+
+static const struct caer_module_functions OutputSharedMemoryFunctions = { .moduleInit = &caerOutputSharedMemoryInit,
+	.moduleRun = &caerOutputCommonRun, .moduleConfig = NULL, .moduleExit = &caerOutputSharedMemoryExit, .moduleReset =
+		&caerOutputCommonReset };
+
+static const struct caer_event_stream_in OutputSharedMemoryInputs[] = {
+	{ .type = -1, .number = -1, .readOnly = true } };
+
+static const struct caer_module_info OutputSharedMemoryInfo = { .version = 1, .name = "SharedMemoryOutput",
+	.description = "Send AEDAT 3 data out to local processes via a shared-memory ring.", .type = CAER_MODULE_OUTPUT,
+	.memSize = sizeof(struct output_common_state), .functions = &OutputSharedMemoryFunctions, .inputStreams =
+		OutputSharedMemoryInputs, .inputStreamsSize = CAER_EVENT_STREAM_IN_SIZE(OutputSharedMemoryInputs),
+	.outputStreams = NULL, .outputStreamsSize = 0, };
+
+caerModuleInfo caerModuleGetInfo(void) {
+	return (&OutputSharedMemoryInfo);
+}
+
+static bool caerOutputSharedMemoryInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodeCreateString(moduleData->moduleNode, "shmName", "/caer-shm", 2, MAX_SHM_NAME_LENGTH, SSHS_FLAGS_NORMAL,
+		"Name of the shared-memory object to create for writing output data.");
+	sshsNodeCreateInt(moduleData->moduleNode, "shmSize", 32, 1, 1024, SSHS_FLAGS_NORMAL,
+		"Size of the shared-memory ring in MB, must hold at least the largest packet.");
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+	size_t dataSize = (size_t) sshsNodeGetInt(moduleData->moduleNode, "shmSize") * 1024 * 1024;
+	size_t shmSize = sizeof(struct aedat3_shm_ring) + dataSize;
+
+	// Always start with a fresh ring: readers still attached to an old one
+	// see it as ended, as its writer isn't active anymore.
+	shm_unlink(shmName);
+
+	int shmFd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, S_IWUSR | S_IRUSR | S_IRGRP | S_IWGRP);
+	if (shmFd < 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not create shared-memory object '%s'. Error: %d.", shmName,
+		errno);
+		free(shmName);
+
+		return (false);
+	}
+
+	if (ftruncate(shmFd, (off_t) shmSize) != 0) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not resize shared-memory object '%s'. Error: %d.", shmName,
+		errno);
+		close(shmFd);
+		shm_unlink(shmName);
+		free(shmName);
+
+		return (false);
+	}
+
+	struct aedat3_shm_ring *ring = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, shmFd, 0);
+
+	// The mapping stays valid without the file descriptor.
+	close(shmFd);
+
+	if (ring == MAP_FAILED) {
+		caerModuleLog(moduleData, CAER_LOG_CRITICAL, "Could not map shared-memory object '%s'. Error: %d.", shmName,
+		errno);
+		shm_unlink(shmName);
+		free(shmName);
+
+		return (false);
+	}
+
+	// New shared memory is zero-filled: no readers, no data, no header.
+	// Set the magic number last, so readers only attach to a fully initialized ring.
+	ring->dataSize = dataSize;
+	atomic_store(&ring->writerActive, true);
+	atomic_store(&ring->magicNumber, AEDAT3_SHM_MAGIC_NUMBER);
+
+	outputCommonState state = moduleData->moduleState;
+	state->sharedMemory = ring;
+
+	if (!caerOutputCommonInit(moduleData, -1, NULL)) {
+		munmap(ring, shmSize);
+		state->sharedMemory = NULL;
+		shm_unlink(shmName);
+		free(shmName);
+
+		return (false);
+	}
+
+	caerModuleLog(moduleData, CAER_LOG_INFO, "Shared-memory ring ready at '%s'.", shmName);
+
+	free(shmName);
+
+	return (true);
+}
+
+static void caerOutputSharedMemoryExit(caerModuleData moduleData) {
+	// Stop output threads first, nothing touches the ring after this.
+	caerOutputCommonExit(moduleData);
+
+	outputCommonState state = moduleData->moduleState;
+	struct aedat3_shm_ring *ring = state->sharedMemory;
+
+	// Let readers drain what is left and then stop. They keep their own mapping
+	// alive, so we can remove the name and unmap right away.
+	atomic_store(&ring->writerActive, false);
+
+	char *shmName = sshsNodeGetString(moduleData->moduleNode, "shmName");
+	shm_unlink(shmName);
+	free(shmName);
+
+	munmap(ring, sizeof(struct aedat3_shm_ring) + ring->dataSize);
+	state->sharedMemory = NULL;
+}
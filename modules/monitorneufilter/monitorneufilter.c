@@ -12,22 +12,8 @@
 struct MNFilter_state {
 	caerInputDynapseState eventSourceModuleState;
 	sshsNode eventSourceConfigNode;
-	int dynapse_u0_c0;
-	int dynapse_u0_c1;
-	int dynapse_u0_c2;
-	int dynapse_u0_c3;	//chip id core id
-	int dynapse_u1_c0;
-	int dynapse_u1_c1;
-	int dynapse_u1_c2;
-	int dynapse_u1_c3;
-	int dynapse_u2_c0;
-	int dynapse_u2_c1;
-	int dynapse_u2_c2;
-	int dynapse_u2_c3;
-	int dynapse_u3_c0;
-	int dynapse_u3_c1;
-	int dynapse_u3_c2;
-	int dynapse_u3_c3;
+	int neuronIds[4][4]; // Monitored neuron per chip and core.
+	sshsNodeAttr neuronIdAttrs[4][4]; // Handles to check the above for changes on each run.
 	int16_t sourceID;
 };
 
@@ -100,26 +86,16 @@ static bool caerMonitorNeuFilterInit(caerModuleData moduleData) {
 	sshsNodeCreateInt(moduleData->moduleNode, "dynapse_u3_c2", 0, 0, 255, SSHS_FLAGS_NORMAL, "Neuron id");
 	sshsNodeCreateInt(moduleData->moduleNode, "dynapse_u3_c3", 0, 0, 255, SSHS_FLAGS_NORMAL, "Neuron id");
 
-	// variables
-	state->dynapse_u0_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0");
-	state->dynapse_u0_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1");
-	state->dynapse_u0_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2");
-	state->dynapse_u0_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3");
+	// Handles for the checks done on every run, so they don't need to lock the node.
+	for (size_t chip = 0; chip < 4; chip++) {
+		for (size_t core = 0; core < 4; core++) {
+			char key[16];
+			snprintf(key, 16, "dynapse_u%zu_c%zu", chip, core);
 
-	state->dynapse_u1_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0");
-	state->dynapse_u1_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1");
-	state->dynapse_u1_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2");
-	state->dynapse_u1_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3");
-
-	state->dynapse_u2_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0");
-	state->dynapse_u2_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1");
-	state->dynapse_u2_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2");
-	state->dynapse_u2_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3");
-
-	state->dynapse_u3_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0");
-	state->dynapse_u3_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1");
-	state->dynapse_u3_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2");
-	state->dynapse_u3_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3");
+			state->neuronIdAttrs[chip][core] = sshsNodeGetAttributeHandle(moduleData->moduleNode, key, SSHS_INT);
+			state->neuronIds[chip][core] = sshsNodeAttributeHandleGetInt(state->neuronIdAttrs[chip][core]);
+		}
+	}
 
 	// Nothing that can fail here.
 	return (true);
@@ -135,188 +111,34 @@ static void caerMonitorNeuFilterRun(caerModuleData moduleData, caerEventPacketCo
 
 	caerInputDynapseState stateSource = state->eventSourceModuleState;
 
-	// if changed we set it
-	if(state->dynapse_u0_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0"));
-			state->dynapse_u0_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c0");
-		}
-	}
-	if(state->dynapse_u0_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1"));
-			state->dynapse_u0_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c1");
-		}
-	}
-	if(state->dynapse_u0_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2"));
-			state->dynapse_u0_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c2");
-		}
-	}
-	if(state->dynapse_u0_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U0);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u0_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3"));
-			state->dynapse_u0_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u0_c3");
-		}
-	}
-
-	if(state->dynapse_u1_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0"));
-			state->dynapse_u1_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c0");
-		}
-
-	}
-	if(state->dynapse_u1_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t)  sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1"));
-			state->dynapse_u1_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c1");
-		}
-	}
-	if(state->dynapse_u1_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2"));
-			state->dynapse_u1_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c2");
-		}
-	}
-	if(state->dynapse_u1_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U1);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u1_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3"));
-			state->dynapse_u1_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u1_c3");
-		}
-	}
-
-	if(state->dynapse_u2_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0"));
-			state->dynapse_u2_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c0");
-		}
-	}
-	if(state->dynapse_u2_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1"));
-			state->dynapse_u2_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c1");
-		}
-	}
-	if(state->dynapse_u2_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2"));
-			state->dynapse_u2_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c2");
-		}
-	}
-	if(state->dynapse_u2_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U2);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u2_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3"));
-			state->dynapse_u2_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u2_c3");
-		}
-	}
+	static const uint32_t chipIds[4] = { DYNAPSE_CONFIG_DYNAPSE_U0, DYNAPSE_CONFIG_DYNAPSE_U1,
+		DYNAPSE_CONFIG_DYNAPSE_U2, DYNAPSE_CONFIG_DYNAPSE_U3 };
 
-	if(state->dynapse_u3_c0 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 0, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c0 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0"));
-			state->dynapse_u3_c0 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c0");
-		}
-	}
-	if(state->dynapse_u3_c1 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 1, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c1 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1"));
-			state->dynapse_u3_c1 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c1");
-		}
-	}
-	if(state->dynapse_u3_c2 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 2, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c2 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2"));
-			state->dynapse_u3_c2 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c2");
-		}
-	}
-	if(state->dynapse_u3_c3 != sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3")){
-		if(sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3") < 0 || sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3") > 255){
-			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Wrong neuron ID %d, please choose a value from [0,255]", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-		}else{
-			caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID, DYNAPSE_CONFIG_DYNAPSE_U3);
-			caerDeviceConfigSet(stateSource->deviceState,
-					DYNAPSE_CONFIG_MONITOR_NEU, 3, (uint32_t) sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-			caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString, "Monitoring neuron dynapse_u3_c3 num: %d", sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3"));
-			state->dynapse_u3_c3 = sshsNodeGetInt(moduleData->moduleNode, "dynapse_u3_c3");
+	// if changed we set it
+	for (size_t chip = 0; chip < 4; chip++) {
+		for (size_t core = 0; core < 4; core++) {
+			// Read only once, the value can change at any time.
+			int neuronId = sshsNodeAttributeHandleGetInt(state->neuronIdAttrs[chip][core]);
+
+			if (state->neuronIds[chip][core] == neuronId) {
+				continue;
+			}
+
+			if (neuronId < 0 || neuronId > 255) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+					"Wrong neuron ID %d, please choose a value from [0,255]", neuronId);
+			}
+			else {
+				caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_CHIP, DYNAPSE_CONFIG_CHIP_ID,
+					chipIds[chip]);
+				caerDeviceConfigSet(stateSource->deviceState, DYNAPSE_CONFIG_MONITOR_NEU, (uint8_t) core,
+					(uint32_t) neuronId);
+				caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString,
+					"Monitoring neuron dynapse_u%zu_c%zu num: %d", chip, core, neuronId);
+				state->neuronIds[chip][core] = neuronId;
+			}
 		}
 	}
-
 }
 
 static void caerMonitorNeuFilterExit(caerModuleData moduleData) {
@@ -2,6 +2,7 @@
 #include "base/mainloop.h"
 #include "base/module.h"
 #include "ext/colorjet/colorjet.h"
+#include "ext/clustergrid.h"
 
 #include <math.h>
 #ifndef M_PI
@@ -65,10 +66,14 @@ typedef struct cluster {
 	float mass;
 	int64_t vFilterTime;
 	bool isEmpty;
+	bool inBotZone;
+	bool inTopZone;
+	struct cluster_grid_registration gridRegistration;
 } Cluster;
 
 struct RTFilter_state {
-	Cluster clusterList[10];
+	Cluster *clusterList;
+	struct cluster_grid clusterGrid;
 	int currentClusterNum;
 	bool dynamicSizeEnabled;
 	bool dynamicAspectRatioEnabled;
@@ -150,8 +155,9 @@ static float averageVelocityPPT_y = 0.0f;
 
 static int nIn = 0;
 static int nOut = 0;
-static bool inBotZone[10];
-static bool inTopZone[10];
+
+// Side of the cluster grid cells in pixels.
+#define CLUSTER_GRID_CELL_SIZE 32
 
 typedef struct RTFilter_state *RTFilterState;
 
@@ -162,10 +168,17 @@ static void caerRectangulartrackerConfig(caerModuleData moduleData);
 static void caerRectangulartrackerExit(caerModuleData moduleData);
 static int getNearestCluster(caerModuleData moduleData, uint16_t x, uint16_t y, int64_t ts);
 static int getFirstContainingCluster(caerModuleData moduleData, uint16_t x, uint16_t y, int64_t ts);
+static void rebuildClusterGrid(caerModuleData moduleData, int64_t ts);
+static void updateClusterGrid(caerModuleData moduleData, int i, int64_t ts);
+static bool resizeClusterList(caerModuleData moduleData, int newSize);
+static void initEmptyCluster(caerModuleData moduleData, Cluster *c);
 static void updateClusterList(caerModuleData moduleData, int64_t ts, int16_t sizeX, int16_t sizeY);
 static void pruneClusters(caerModuleData moduleData, int64_t ts, int16_t sizeX, int16_t sizeY);
 static void mergeClusters(caerModuleData moduleData);
-static void mergeC1C2(caerModuleData moduleData, int i, int j);
+static void updateMergeGrid(caerModuleData moduleData, int i);
+static int findMergeCandidate(caerModuleData moduleData, int i, int minIndex);
+static bool canMerge(Cluster *c1, Cluster *c2);
+static int mergeC1C2(caerModuleData moduleData, int i, int j);
 static int64_t getLifetime(Cluster *c);
 static float getMassNow(Cluster *c, int64_t ts);
 static float distanceToX(Cluster *c, uint16_t x, uint16_t y, int64_t ts);
@@ -240,7 +253,7 @@ static bool caerRectangulartrackerInit(caerModuleData moduleData) {
 	sshsNodeCreateBool(moduleData->moduleNode, "dynamicAngleEnabled", false, SSHS_FLAGS_NORMAL, "TODO.");
 	sshsNodeCreateBool(moduleData->moduleNode, "pathsEnabled", false, SSHS_FLAGS_NORMAL, "TODO.");
 	sshsNodeCreateBool(moduleData->moduleNode, "showPaths", false, SSHS_FLAGS_NORMAL, "TODO.");
-	sshsNodeCreateInt(moduleData->moduleNode, "maxClusterNum", 10, 1, 100, SSHS_FLAGS_NORMAL, "TODO.");
+	sshsNodeCreateInt(moduleData->moduleNode, "maxClusterNum", 10, 1, 1024, SSHS_FLAGS_NORMAL, "TODO.");
 	sshsNodeCreateFloat(moduleData->moduleNode, "thresholdMassForVisibleCluster", 30.0f, 1.0f, 100.0f,
 		SSHS_FLAGS_NORMAL, "TODO.");
 	sshsNodeCreateFloat(moduleData->moduleNode, "defaultClusterRadius", 25.0f, 1.0f, 100.0f, SSHS_FLAGS_NORMAL,
@@ -279,7 +292,6 @@ static bool caerRectangulartrackerInit(caerModuleData moduleData) {
 	state->dynamicAngleEnabled = sshsNodeGetBool(moduleData->moduleNode, "dynamicAngleEnabled");
 	state->pathsEnabled = sshsNodeGetBool(moduleData->moduleNode, "pathsEnabled");
 	state->showPaths = sshsNodeGetBool(moduleData->moduleNode, "showPaths");
-	state->maxClusterNum = sshsNodeGetInt(moduleData->moduleNode, "maxClusterNum");
 	state->thresholdMassForVisibleCluster = sshsNodeGetFloat(moduleData->moduleNode, "thresholdMassForVisibleCluster");
 	state->defaultClusterRadius = sshsNodeGetFloat(moduleData->moduleNode, "defaultClusterRadius");
 	state->forceBoundary = sshsNodeGetBool(moduleData->moduleNode, "forceBoundary");
@@ -304,51 +316,15 @@ static bool caerRectangulartrackerInit(caerModuleData moduleData) {
 	state->currentClusterNum = 0;
 
 	// initialize all cluster as empty
-	for (int i = 0; i < 10; i++) {
-		state->clusterList[i].location_x = 0.0f;
-		state->clusterList[i].location_y = 0.0f;
-		state->clusterList[i].velocity_x = 0.0f;
-		state->clusterList[i].velocity_y = 0.0f;
-		state->clusterList[i].birthLocation_x = 0.0f;
-		state->clusterList[i].birthLocation_y = 0.0f;
-		state->clusterList[i].lastPacketLocation_x = 0.0f;
-		state->clusterList[i].lastPacketLocation_y = 0.0f;
-		state->clusterList[i].velocityPPT_x = 0.0f;
-		state->clusterList[i].velocityPPT_y = 0.0f;
-		state->clusterList[i].velocityPPS_x = 0.0f;
-		state->clusterList[i].velocityPPS_y = 0.0f;
-		state->clusterList[i].angle = 0.0f;
-		state->clusterList[i].cosAngle = 1.0f;
-		state->clusterList[i].sinAngle = 0.0f;
-		state->clusterList[i].numEvents = 0;
-		state->clusterList[i].previousNumEvents = 0;
-		state->clusterList[i].firstEventTimestamp = 0;
-		state->clusterList[i].lastEventTimestamp = 0;
-		state->clusterList[i].lastUpdateTime = 0;
-		state->clusterList[i].instantaneousEventRate = 0.0f;
-		state->clusterList[i].hasObtainedSupport = false;
-		state->clusterList[i].averageEventDistance = 0.0f;
-		state->clusterList[i].averageEventXDistance = 0.0f;
-		state->clusterList[i].averageEventYDistance = 0.0f;
-		state->clusterList[i].clusterNumber = 0;
-		state->clusterList[i].avgEventRate = 0.0f;
-		state->clusterList[i].radius = state->defaultClusterRadius;
-		state->clusterList[i].aspectRatio = state->aspectRatio;
-		state->clusterList[i].radius_x = state->defaultClusterRadius / state->aspectRatio;
-		state->clusterList[i].radius_y = state->defaultClusterRadius * state->aspectRatio;
-		state->clusterList[i].avgISI = 0.0f;
-		state->clusterList[i].velocityValid = false;
-		state->clusterList[i].visibilityFlag = false;
-		state->clusterList[i].instantaneousISI = 0.0f;
-		state->clusterList[i].distanceToLastEvent = 1000000.0f;
-		state->clusterList[i].distanceToLastEvent_x = 1000000.0f;
-		state->clusterList[i].distanceToLastEvent_y = 1000000.0f;
-		state->clusterList[i].mass = 0.0f;
-		state->clusterList[i].vFilterTime = 0.0f;
-		state->clusterList[i].isEmpty = true;
-		state->clusterList[i].path = NULL;
-		inBotZone[i] = false;
-		inTopZone[i] = false;
+	if (!resizeClusterList(moduleData, sshsNodeGetInt(moduleData->moduleNode, "maxClusterNum"))) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for clusterList.");
+		return (false);
+	}
+
+	if (!clusterGridInit(&state->clusterGrid, state->sizeX, state->sizeY, CLUSTER_GRID_CELL_SIZE)) {
+		free(state->clusterList);
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for clusterGrid.");
+		return (false);
 	}
 
 	// Create own sourceInfo node.
@@ -362,7 +338,6 @@ static bool caerRectangulartrackerInit(caerModuleData moduleData) {
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
 
-	// Nothing that can fail here.
 	return (true);
 }
 static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacketContainer in,
@@ -384,6 +359,10 @@ static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacket
 		state->clusterList[i].lastPacketLocation_y = state->clusterList[i].location_y;
 	}
 
+	// Clusters may have been changed by configuration, or moved in memory.
+	clusterGridInvalidate(&state->clusterGrid);
+	updateCurrentClusterNum(moduleData);
+
 	//Iterate over events
 	CAER_POLARITY_CONST_ITERATOR_VALID_START(polarity)
 
@@ -416,7 +395,10 @@ static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacket
 			}
 		}
 
-		updateCurrentClusterNum(moduleData);
+		// Rebuild the grid if a cluster may have moved out of its cells since.
+		if (!clusterGridIsValid(&state->clusterGrid, ts)) {
+			rebuildClusterGrid(moduleData, ts);
+		}
 
 		// check nearestCluster exist?
 		int chosenClusterIndex;
@@ -430,6 +412,7 @@ static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacket
 		// if exist, update it
 		if (chosenClusterIndex != -1) {
 			addEvent(moduleData, &(state->clusterList[chosenClusterIndex]), x, y, ts);
+			updateClusterGrid(moduleData, chosenClusterIndex, ts);
 		}
 
 		// if not, create new cluster
@@ -439,6 +422,9 @@ static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacket
 			for (i = 0; i < state->maxClusterNum; i++) {
 				if (state->clusterList[i].isEmpty == true) {
 					state->clusterList[i] = clusterNew;
+					state->currentClusterNum++;
+					updateClusterGrid(moduleData, i, ts);
+					break;
 				}
 			}
 		}
@@ -450,6 +436,8 @@ static void caerRectangulartrackerRun(caerModuleData moduleData, caerEventPacket
 		if (ts > nextUpdateTimeUs) {
 			nextUpdateTimeUs = ts + updateIntervalUs;
 			updateClusterList(moduleData, ts, state->sizeX, state->sizeY);
+			updateCurrentClusterNum(moduleData);
+			clusterGridInvalidate(&state->clusterGrid);
 		}
 
 	CAER_POLARITY_ITERATOR_VALID_END
@@ -514,8 +502,17 @@ static int getNearestCluster(caerModuleData moduleData, uint16_t x, uint16_t y,
 	int closest = -1;
 	float minDistance = 10000000.0f;
 	float currentDistance = 0.0f;
-	int i;
-	for (i = 0; i < state->maxClusterNum; i++) {
+
+	// Only the clusters in the event's grid cell can capture it. They are sorted
+	// by index, so they're visited in the same order as in the full list.
+	struct cluster_grid_cell *cell = NULL;
+	if (clusterGridIsValid(&state->clusterGrid, ts)) {
+		cell = clusterGridGetCell(&state->clusterGrid, x, y);
+	}
+	int candidates = (cell != NULL) ? ((int) cell->size) : (state->maxClusterNum);
+
+	for (int n = 0; n < candidates; n++) {
+		int i = (cell != NULL) ? ((int) cell->entries[n].order) : (n);
 		if (!state->clusterList[i].isEmpty) {
 			float rX = state->clusterList[i].radius_x;
 			float rY = state->clusterList[i].radius_y;
@@ -546,7 +543,15 @@ static int getFirstContainingCluster(caerModuleData moduleData, uint16_t x, uint
 	int closest = -1;
 	float minDistance = 10000000.0f;
 	float currentDistance = 0.0f;
-	for (int i = 0; i < state->maxClusterNum; i++) {
+
+	struct cluster_grid_cell *cell = NULL;
+	if (clusterGridIsValid(&state->clusterGrid, ts)) {
+		cell = clusterGridGetCell(&state->clusterGrid, x, y);
+	}
+	int candidates = (cell != NULL) ? ((int) cell->size) : (state->maxClusterNum);
+
+	for (int n = 0; n < candidates; n++) {
+		int i = (cell != NULL) ? ((int) cell->entries[n].order) : (n);
 		if (!state->clusterList[i].isEmpty) {
 			float rX = state->clusterList[i].radius_x;
 			float rY = state->clusterList[i].radius_y; // this is surround region for purposes of dynamicSize scaling of cluster size or
@@ -571,6 +576,117 @@ static int getFirstContainingCluster(caerModuleData moduleData, uint16_t x, uint
 	return (closest);
 }
 
+static void rebuildClusterGrid(caerModuleData moduleData, int64_t ts) {
+	RTFilterState state = moduleData->moduleState;
+
+	clusterGridClear(&state->clusterGrid);
+
+	for (int i = 0; i < state->maxClusterNum; i++) {
+		if (!state->clusterList[i].isEmpty) {
+			updateClusterGrid(moduleData, i, ts);
+		}
+	}
+}
+
+static void updateClusterGrid(caerModuleData moduleData, int i, int64_t ts) {
+	RTFilterState state = moduleData->moduleState;
+	Cluster *c = &state->clusterList[i];
+
+	float rX = c->radius_x;
+	float rY = c->radius_y;
+	if (state->dynamicSizeEnabled) {
+		rX *= surround;
+		rY *= surround;
+	}
+
+	// Events are captured in a rectangle rotated by the cluster angle, which fits
+	// in a square of half-side equal to its half-diagonal. Its center moves against
+	// velocityPPT since the last update, see distanceToX() and distanceToY().
+	clusterGridUpdate(&state->clusterGrid, &c->gridRegistration, i, c, c->location_x, c->location_y,
+		-c->velocityPPT_x, -c->velocityPPT_y, c->lastUpdateTime, sqrtf((rX * rX) + (rY * rY)), ts);
+}
+
+static bool resizeClusterList(caerModuleData moduleData, int newSize) {
+	RTFilterState state = moduleData->moduleState;
+
+	// Drop the clusters that don't fit anymore.
+	for (int i = newSize; i < state->maxClusterNum; i++) {
+		if (!state->clusterList[i].isEmpty) {
+			state->clusterList[i].isEmpty = true;
+			removeAllPath(state->clusterList[i].path);
+		}
+	}
+
+	Cluster *newClusterList = realloc(state->clusterList, (size_t) newSize * sizeof(Cluster));
+	if (newClusterList == NULL) {
+		if (newSize > state->maxClusterNum) {
+			return (false);
+		}
+
+		// Shrinking can just keep using the old memory.
+		newClusterList = state->clusterList;
+	}
+
+	for (int i = state->maxClusterNum; i < newSize; i++) {
+		initEmptyCluster(moduleData, &newClusterList[i]);
+	}
+
+	state->clusterList = newClusterList;
+	state->maxClusterNum = newSize;
+
+	return (true);
+}
+
+static void initEmptyCluster(caerModuleData moduleData, Cluster *c) {
+	RTFilterState state = moduleData->moduleState;
+
+	c->location_x = 0.0f;
+	c->location_y = 0.0f;
+	c->velocity_x = 0.0f;
+	c->velocity_y = 0.0f;
+	c->birthLocation_x = 0.0f;
+	c->birthLocation_y = 0.0f;
+	c->lastPacketLocation_x = 0.0f;
+	c->lastPacketLocation_y = 0.0f;
+	c->velocityPPT_x = 0.0f;
+	c->velocityPPT_y = 0.0f;
+	c->velocityPPS_x = 0.0f;
+	c->velocityPPS_y = 0.0f;
+	c->angle = 0.0f;
+	c->cosAngle = 1.0f;
+	c->sinAngle = 0.0f;
+	c->numEvents = 0;
+	c->previousNumEvents = 0;
+	c->firstEventTimestamp = 0;
+	c->lastEventTimestamp = 0;
+	c->lastUpdateTime = 0;
+	c->instantaneousEventRate = 0.0f;
+	c->hasObtainedSupport = false;
+	c->averageEventDistance = 0.0f;
+	c->averageEventXDistance = 0.0f;
+	c->averageEventYDistance = 0.0f;
+	c->clusterNumber = 0;
+	c->avgEventRate = 0.0f;
+	c->radius = state->defaultClusterRadius;
+	c->aspectRatio = state->aspectRatio;
+	c->radius_x = state->defaultClusterRadius / state->aspectRatio;
+	c->radius_y = state->defaultClusterRadius * state->aspectRatio;
+	c->avgISI = 0.0f;
+	c->velocityValid = false;
+	c->visibilityFlag = false;
+	c->instantaneousISI = 0.0f;
+	c->distanceToLastEvent = 1000000.0f;
+	c->distanceToLastEvent_x = 1000000.0f;
+	c->distanceToLastEvent_y = 1000000.0f;
+	c->mass = 0.0f;
+	c->vFilterTime = 0.0f;
+	c->isEmpty = true;
+	c->path = NULL;
+	c->inBotZone = false;
+	c->inTopZone = false;
+	c->gridRegistration.epoch = 0;
+}
+
 static void updateClusterList(caerModuleData moduleData, int64_t ts, int16_t sizeX, int16_t sizeY) {
 	pruneClusters(moduleData, ts, sizeX, sizeY);
 	mergeClusters(moduleData);
@@ -632,6 +748,9 @@ static Cluster newCluster(caerModuleData moduleData, uint16_t x, uint16_t y, int
 	clusterNew.vFilterTime = 0.0f;
 	clusterNew.isEmpty = false;
 	clusterNew.path = NULL;
+	clusterNew.inBotZone = false;
+	clusterNew.inTopZone = false;
+	clusterNew.gridRegistration.epoch = 0;
 	return (clusterNew);
 }
 
@@ -671,39 +790,120 @@ static void mergeClusters(caerModuleData moduleData) {
 		return;
 	}
 
-	bool mergePending;
-	int i = 0, j = 0;
-	do {
-		mergePending = false;
-		for (i = 0; i < state->maxClusterNum; i++) {
-			if (!state->clusterList[i].isEmpty) {
-				for (j = i + 1; j < state->maxClusterNum; j++) {
-					if (!state->clusterList[i].isEmpty && !state->clusterList[j].isEmpty) {
-						bool overlapping = isOverlapping(&state->clusterList[i], &state->clusterList[j]);
-						bool velSimilar = true;
-						if (overlapping && (velAngDiffDegToNotMerge > 0) && state->clusterList[i].visibilityFlag
-							&& state->clusterList[j].visibilityFlag && state->clusterList[i].velocityValid
-							&& state->clusterList[j].velocityValid
-							&& velocityAngleToRad(&state->clusterList[i], &state->clusterList[j])
-								> ((velAngDiffDegToNotMerge * (float) M_PI) / 180)) {
-							velSimilar = false;
-						}
-						if (overlapping && velSimilar) {
-							mergePending = true;
-							goto stopLoop;
-						}
-					}
-				}
+	// Overlapping clusters are closer than the sum of their radii, so they always share
+	// a cell if each is registered with its radius around its current location.
+	// This reuses the event lookup grid, which is rebuilt on the next lookup.
+	clusterGridClear(&state->clusterGrid);
+
+	for (int i = 0; i < state->maxClusterNum; i++) {
+		if (!state->clusterList[i].isEmpty) {
+			updateMergeGrid(moduleData, i);
+		}
+	}
+
+	// Merges happen in the same order as when restarting from the first cluster after
+	// each one: pairs not involving the merged cluster still don't merge, so only its
+	// partners before the current position can come first. Else the pass goes on.
+	for (int i = 0; i < state->maxClusterNum; i++) {
+		if (state->clusterList[i].isEmpty) {
+			continue;
+		}
+
+		int j = findMergeCandidate(moduleData, i, i + 1);
+
+		while (j != -1) {
+			int merged = mergeC1C2(moduleData, i, j);
+			updateMergeGrid(moduleData, merged);
+
+			int k = findMergeCandidate(moduleData, merged, 0);
+			if (k != -1 && k < i) {
+				i = k;
+				j = merged;
+				continue;
 			}
+
+			j = (state->clusterList[i].isEmpty) ? (-1) : (findMergeCandidate(moduleData, i, i + 1));
 		}
-		stopLoop: if (mergePending && (!state->clusterList[i].isEmpty) && (!state->clusterList[j].isEmpty)) {
-			mergeC1C2(moduleData, i, j);
+	}
+
+	clusterGridInvalidate(&state->clusterGrid);
+}
+
+static void updateMergeGrid(caerModuleData moduleData, int i) {
+	RTFilterState state = moduleData->moduleState;
+	Cluster *c = &state->clusterList[i];
+
+	clusterGridUpdate(&state->clusterGrid, &c->gridRegistration, i, c, c->location_x, c->location_y, 0.0f, 0.0f, 0,
+		c->radius, 0);
+}
+
+/**
+ * Find the first cluster that should be merged with the given one, only
+ * looking at the clusters sharing a merge grid cell with it.
+ *
+ * @param moduleData the module.
+ * @param i index of the cluster to find a merge partner for.
+ * @param minIndex lowest index to consider as partner.
+ *
+ * @return index of the partner, -1 if there is none.
+ */
+static int findMergeCandidate(caerModuleData moduleData, int i, int minIndex) {
+	RTFilterState state = moduleData->moduleState;
+	clusterGrid grid = &state->clusterGrid;
+	Cluster *c = &state->clusterList[i];
+
+	int candidate = -1;
+
+	// Without a complete grid (out of memory), fall back to all clusters.
+	if (!grid->complete) {
+		for (int j = minIndex; j < state->maxClusterNum; j++) {
+			if (j != i && !state->clusterList[j].isEmpty && canMerge(c, &state->clusterList[j])) {
+				return (j);
+			}
+		}
+
+		return (-1);
+	}
+
+	for (int cy = c->gridRegistration.cellY0; cy <= c->gridRegistration.cellY1; cy++) {
+		for (int cx = c->gridRegistration.cellX0; cx <= c->gridRegistration.cellX1; cx++) {
+			struct cluster_grid_cell *cell = &grid->cells[(cy * grid->cellsX) + cx];
+
+			// Entries are sorted by index, so the first match is this cell's lowest.
+			for (size_t n = 0; n < cell->size; n++) {
+				int j = (int) cell->entries[n].order;
+
+				if (candidate != -1 && j >= candidate) {
+					break;
+				}
+
+				if (j >= minIndex && j != i && !state->clusterList[j].isEmpty
+					&& canMerge(c, &state->clusterList[j])) {
+					candidate = j;
+					break;
+				}
+			}
 		}
 	}
-	while (mergePending);
+
+	return (candidate);
 }
 
-static void mergeC1C2(caerModuleData moduleData, int i, int j) {
+static bool canMerge(Cluster *c1, Cluster *c2) {
+	if (!isOverlapping(c1, c2)) {
+		return (false);
+	}
+
+	// Visible clusters moving in different directions are kept apart.
+	if ((velAngDiffDegToNotMerge > 0) && c1->visibilityFlag && c2->visibilityFlag && c1->velocityValid
+		&& c2->velocityValid && velocityAngleToRad(c1, c2) > ((velAngDiffDegToNotMerge * (float) M_PI) / 180)) {
+		return (false);
+	}
+
+	return (true);
+}
+
+static int mergeC1C2(caerModuleData moduleData, int i, int j) {
 	RTFilterState state = moduleData->moduleState;
 
 	int weaker = state->clusterList[i].mass > state->clusterList[j].mass ? j : i;
@@ -737,6 +937,8 @@ static void mergeC1C2(caerModuleData moduleData, int i, int j) {
 
 	state->clusterList[weaker].isEmpty = true;
 	removeAllPath(state->clusterList[weaker].path);
+
+	return (stronger);
 }
 
 int64_t getLifetime(Cluster *c) {
@@ -1427,27 +1629,27 @@ static void countPeople(caerFrameEvent singleplot, caerModuleData moduleData, in
 
 	//TODO make algorithm for x dimension.
 	for (int i = 0; i < state->maxClusterNum; i++) {
-		if (state->clusterList[i].isEmpty && inBotZone[i]) {
-			inBotZone[i] = false;
+		if (state->clusterList[i].isEmpty && state->clusterList[i].inBotZone) {
+			state->clusterList[i].inBotZone = false;
 		}
-		if (state->clusterList[i].isEmpty && inTopZone[i]) {
-			inTopZone[i] = false;
+		if (state->clusterList[i].isEmpty && state->clusterList[i].inTopZone) {
+			state->clusterList[i].inTopZone = false;
 		}
 		if (state->clusterList[i].isEmpty || !state->clusterList[i].visibilityFlag) {
 			continue;
 		}
-		if ((state->clusterList[i].location_y < by) && !inBotZone[i]) {
-			inBotZone[i] = true;
+		if ((state->clusterList[i].location_y < by) && !state->clusterList[i].inBotZone) {
+			state->clusterList[i].inBotZone = true;
 		}
-		if ((state->clusterList[i].location_y > ty) && !inTopZone[i]) {
-			inTopZone[i] = true;
+		if ((state->clusterList[i].location_y > ty) && !state->clusterList[i].inTopZone) {
+			state->clusterList[i].inTopZone = true;
 		}
-		if ((state->clusterList[i].location_y < by) && inTopZone[i]) {
-			inTopZone[i] = false;
+		if ((state->clusterList[i].location_y < by) && state->clusterList[i].inTopZone) {
+			state->clusterList[i].inTopZone = false;
 			nIn++;
 		}
-		if ((state->clusterList[i].location_y > ty) && inBotZone[i]) {
-			inBotZone[i] = false;
+		if ((state->clusterList[i].location_y > ty) && state->clusterList[i].inBotZone) {
+			state->clusterList[i].inBotZone = false;
 			nOut++;
 		}
 	}
@@ -1464,7 +1666,6 @@ static void caerRectangulartrackerConfig(caerModuleData moduleData) {
 	state->dynamicAngleEnabled = sshsNodeGetBool(moduleData->moduleNode, "dynamicAngleEnabled");
 	state->pathsEnabled = sshsNodeGetBool(moduleData->moduleNode, "pathsEnabled");
 	state->showPaths = sshsNodeGetBool(moduleData->moduleNode, "showPaths");
-	state->maxClusterNum = sshsNodeGetInt(moduleData->moduleNode, "maxClusterNum");
 	state->thresholdMassForVisibleCluster = sshsNodeGetFloat(moduleData->moduleNode, "thresholdMassForVisibleCluster");
 	state->defaultClusterRadius = sshsNodeGetFloat(moduleData->moduleNode, "defaultClusterRadius");
 	state->forceBoundary = sshsNodeGetBool(moduleData->moduleNode, "forceBoundary");
@@ -1484,6 +1685,12 @@ static void caerRectangulartrackerConfig(caerModuleData moduleData) {
 	state->useOnePolarityOnlyEnabled = sshsNodeGetBool(moduleData->moduleNode, "useOnePolarityOnlyEnabled");
 	state->useOffPolarityOnlyEnabled = sshsNodeGetBool(moduleData->moduleNode, "useOffPolarityOnlyEnabled");
 	state->showAllClusters = sshsNodeGetBool(moduleData->moduleNode, "showAllClusters");
+
+	int maxClusterNum = sshsNodeGetInt(moduleData->moduleNode, "maxClusterNum");
+	if (!resizeClusterList(moduleData, maxClusterNum)) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for %d clusters, keeping %d.",
+			maxClusterNum, state->maxClusterNum);
+	}
 }
 
 static void caerRectangulartrackerExit(caerModuleData moduleData) {
@@ -1493,4 +1700,15 @@ static void caerRectangulartrackerExit(caerModuleData moduleData) {
 	// Clear sourceInfo node.
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 	sshsNodeRemoveAllAttributes(sourceInfoNode);
+
+	RTFilterState state = moduleData->moduleState;
+
+	for (int i = 0; i < state->maxClusterNum; i++) {
+		if (!state->clusterList[i].isEmpty) {
+			removeAllPath(state->clusterList[i].path);
+		}
+	}
+
+	free(state->clusterList);
+	clusterGridFree(&state->clusterGrid);
 }
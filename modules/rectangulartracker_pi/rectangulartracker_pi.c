@@ -12,6 +12,7 @@
 #include "base/module.h"
 #include "math.h"
 #include "ext/colorjet/colorjet.h"
+#include "ext/clustergrid.h"
 
 typedef struct path {
 	float location_x;
@@ -68,6 +69,7 @@ typedef struct cluster {
 	int64_t vFilterTime;
 	bool inBotZone;
 	bool inTopZone;
+	struct cluster_grid_registration gridRegistration;
 } Cluster;
 
 typedef struct clusterList {
@@ -77,6 +79,7 @@ typedef struct clusterList {
 
 struct RTFilter_state {
 	ClusterList ** clusterBegin;
+	struct cluster_grid clusterGrid;
 	int currentClusterNum;
 	bool dynamicSizeEnabled;
 	bool dynamicAspectRatioEnabled;
@@ -174,6 +177,9 @@ static float averageVelocityPPT_y = 0.0f;
 // cluster list always begine from this pointer
 ClusterList * clusterBeginPointer = NULL;
 
+// Side of the cluster grid cells in pixels.
+#define CLUSTER_GRID_CELL_SIZE 32
+
 
 typedef struct RTFilter_state *RTFilterState;
 
@@ -184,6 +190,10 @@ static void caerRectangulartrackerPiExit(caerModuleData moduleData);
 static void caerRectangulartrackerPiReset(caerModuleData moduleData, uint16_t resetCallSourceID);
 static Cluster * getNearestCluster(RTFilterState state, uint16_t x, uint16_t y, int64_t ts);
 static Cluster * getFirstContainingCluster(RTFilterState state, uint16_t x, uint16_t y, int64_t ts);
+static struct cluster_grid_cell * getClusterGridCell(RTFilterState state, uint16_t x, uint16_t y, int64_t ts);
+static Cluster * nextCandidateCluster(struct cluster_grid_cell *cell, size_t *n, ClusterList **current);
+static void rebuildClusterGrid(RTFilterState state, int64_t ts);
+static void updateClusterGrid(RTFilterState state, Cluster *c, int64_t ts);
 static void updateClusterList(RTFilterState state, int64_t ts, int16_t sizeX, int16_t sizeY);
 static void pruneClusters(RTFilterState state, int64_t ts, int16_t sizeX, int16_t sizeY);
 static void mergeClusters(RTFilterState state);
@@ -224,7 +234,6 @@ static void countPeople(caerModuleData moduleData, int16_t sizeX, int16_t sizeY)
 
 static void addCluster(ClusterList ** head, Cluster * newClusterPointer);
 static void removeCluster(ClusterList ** head, int64_t clusterID);
-static Cluster * findClusterByIndex(ClusterList ** head, int index);
 
 static struct caer_module_functions caerRectangulartrackerPiFunctions = { .moduleInit = &caerRectangulartrackerPiInit, .moduleRun = &caerRectangulartrackerPiRun, .moduleConfig = &caerRectangulartrackerPiConfig, .moduleExit = &caerRectangulartrackerPiExit, .moduleReset = &caerRectangulartrackerPiReset };
 
@@ -356,6 +365,13 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 	int16_t sizeX = sshsNodeGetShort(sourceInfoNode, "dataSizeX");
 	int16_t sizeY = sshsNodeGetShort(sourceInfoNode, "dataSizeY");
 
+	// The grid can only be allocated once the data size is known.
+	if ((state->clusterGrid.cells == NULL)
+		&& !clusterGridInit(&state->clusterGrid, sizeX, sizeY, CLUSTER_GRID_CELL_SIZE)) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to allocate memory for clusterGrid.");
+		return;
+	}
+
 	ClusterList * current = *(state->clusterBegin);
 	while (current != NULL) {
 		current->cluster->lastPacketLocation_x = current->cluster->location_x;
@@ -363,6 +379,10 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 		current = current->next;
 	}
 
+	// Clusters may have been changed by configuration.
+	clusterGridInvalidate(&state->clusterGrid);
+	updateCurrentClusterNum(state);
+
 	//Iterate over events
 	CAER_POLARITY_ITERATOR_VALID_START(polarity)
 
@@ -399,7 +419,11 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 			}
 		}
 	}
-	updateCurrentClusterNum(state);
+
+	// Rebuild the grid if a cluster may have moved out of its cells since.
+	if (!clusterGridIsValid(&state->clusterGrid, ts)) {
+		rebuildClusterGrid(state, ts);
+	}
 
 	// check nearestCluster exist?
 	Cluster * chosenCluster = NULL;
@@ -413,6 +437,7 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 	// if exist, update it
 	if (chosenCluster != NULL){
 		addEvent(state, chosenCluster, x, y, ts);
+		updateClusterGrid(state, chosenCluster, ts);
 	}
 
 	// if not, create new cluster
@@ -420,6 +445,8 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 		state->clusterCounter++;
 		Cluster * newClusterPointer = generateNewCluster(state, x, y, ts);
 		addCluster(state->clusterBegin, newClusterPointer);
+		state->currentClusterNum++;
+		updateClusterGrid(state, newClusterPointer, ts);
 	}
 
 	if (!updateTimeInitialized) {
@@ -432,6 +459,8 @@ static void caerRectangulartrackerPiRun(caerModuleData moduleData, size_t argsNu
 		nextUpdateTimeUs = ts + updateIntervalUs;
 		updateCurrentClusterNum(state);
 		updateClusterList(state, ts, sizeX, sizeY);
+		updateCurrentClusterNum(state);
+		clusterGridInvalidate(&state->clusterGrid);
 	}
 
 
@@ -454,64 +483,125 @@ static Cluster * getNearestCluster(RTFilterState state, uint16_t x, uint16_t y,
 	float minDistance = 10000000.0f;
 	float currentDistance = 0.0f;
 
+	struct cluster_grid_cell *cell = getClusterGridCell(state, x, y, ts);
 	ClusterList * current = *(state->clusterBegin);
-	while (current != NULL) {
-		float rX = current->cluster->radius_x;
-		float rY = current->cluster->radius_y;
+	size_t n = 0;
+
+	Cluster * c;
+	while ((c = nextCandidateCluster(cell, &n, &current)) != NULL) {
+		float rX = c->radius_x;
+		float rY = c->radius_y;
 		if (state->dynamicSizeEnabled) {
 			rX *= surround;
 			rY *= surround; // the event is captured even when it is in "invisible surround"
 		}
-		float dx = distanceToX(current->cluster, x, y, ts);
-		float dy = distanceToY(current->cluster, x, y, ts);
+		float dx = distanceToX(c, x, y, ts);
+		float dy = distanceToY(c, x, y, ts);
 		if ((dx < rX) && (dy < rY)) {
 			currentDistance = dx + dy;
 			if (currentDistance < minDistance) {
-				closest = current->cluster;
+				closest = c;
 				minDistance = currentDistance;
-				current->cluster->distanceToLastEvent = minDistance;
-				current->cluster->distanceToLastEvent_x = dx;
-				current->cluster->distanceToLastEvent_y = dy;
+				c->distanceToLastEvent = minDistance;
+				c->distanceToLastEvent_x = dx;
+				c->distanceToLastEvent_y = dy;
 			}
 		}
-		current = current->next;
 	}
 
 	return (closest);
 }
 
-
 static Cluster * getFirstContainingCluster(RTFilterState state, uint16_t x, uint16_t y, int64_t ts) {
 
 	Cluster * closest = NULL;
 	float minDistance = 10000000.0f;
 	float currentDistance = 0.0f;
 
+	struct cluster_grid_cell *cell = getClusterGridCell(state, x, y, ts);
 	ClusterList * current = *(state->clusterBegin);
-	while (current != NULL) {
-		float rX = current->cluster->radius_x;
-		float rY = current->cluster->radius_y; // this is surround region for purposes of dynamicSize scaling of cluster size or
+	size_t n = 0;
+
+	Cluster * c;
+	while ((c = nextCandidateCluster(cell, &n, &current)) != NULL) {
+		float rX = c->radius_x;
+		float rY = c->radius_y; // this is surround region for purposes of dynamicSize scaling of cluster size or
 		// aspect ratio
 		if (state->dynamicSizeEnabled) {
 			rX *= surround;
 			rY *= surround; // the event is captured even when it is in "invisible surround"
 		}
-		float dx = distanceToX(current->cluster, x, y, ts);
-		float dy = distanceToY(current->cluster, x, y, ts);
+		float dx = distanceToX(c, x, y, ts);
+		float dy = distanceToY(c, x, y, ts);
 		if ((dx < rX) && (dy < rY)) {
 			currentDistance = dx + dy;
-			closest = current->cluster;
+			closest = c;
 			minDistance = currentDistance;
-			current->cluster->distanceToLastEvent = minDistance;
-			current->cluster->distanceToLastEvent_x = dx;
-			current->cluster->distanceToLastEvent_y = dy;
+			c->distanceToLastEvent = minDistance;
+			c->distanceToLastEvent_x = dx;
+			c->distanceToLastEvent_y = dy;
 			break;
 		}
-		current = current->next;
 	}
 	return (closest);
 }
 
+/**
+ * Get the grid cell with the clusters that may capture an event at the
+ * given position, or NULL if the grid can't be used and all must be tested.
+ */
+static struct cluster_grid_cell * getClusterGridCell(RTFilterState state, uint16_t x, uint16_t y, int64_t ts) {
+	if (!clusterGridIsValid(&state->clusterGrid, ts)) {
+		return (NULL);
+	}
+
+	return (clusterGridGetCell(&state->clusterGrid, x, y));
+}
+
+/**
+ * Iterate over the clusters in a grid cell, or over the full list if there
+ * is no cell. The cell is sorted like the list, so both give the same order.
+ */
+static Cluster * nextCandidateCluster(struct cluster_grid_cell *cell, size_t *n, ClusterList **current) {
+	if (cell != NULL) {
+		return ((*n < cell->size) ? (cell->entries[(*n)++].cluster) : (NULL));
+	}
+
+	if (*current == NULL) {
+		return (NULL);
+	}
+
+	Cluster * c = (*current)->cluster;
+	*current = (*current)->next;
+	return (c);
+}
+
+static void rebuildClusterGrid(RTFilterState state, int64_t ts) {
+	clusterGridClear(&state->clusterGrid);
+
+	ClusterList * current = *(state->clusterBegin);
+	while (current != NULL) {
+		updateClusterGrid(state, current->cluster, ts);
+		current = current->next;
+	}
+}
+
+static void updateClusterGrid(RTFilterState state, Cluster *c, int64_t ts) {
+	float rX = c->radius_x;
+	float rY = c->radius_y;
+	if (state->dynamicSizeEnabled) {
+		rX *= surround;
+		rY *= surround;
+	}
+
+	// New clusters are added at the front of the list, so it is sorted by decreasing
+	// cluster number. Events are captured in a rectangle rotated by the cluster angle,
+	// which fits in a square of half-side equal to its half-diagonal. Its center moves
+	// against velocityPPT since the last update, see distanceToX() and distanceToY().
+	clusterGridUpdate(&state->clusterGrid, &c->gridRegistration, -c->clusterNumber, c, c->location_x,
+		c->location_y, -c->velocityPPT_x, -c->velocityPPT_y, c->lastUpdateTime, sqrtf((rX * rX) + (rY * rY)), ts);
+}
+
 static void updateClusterList(RTFilterState state, int64_t ts, int16_t sizeX, int16_t sizeY) {
 	pruneClusters(state, ts, sizeX, sizeY);
 	mergeClusters(state);
@@ -572,6 +662,7 @@ static Cluster * generateNewCluster(RTFilterState state, uint16_t x, uint16_t y,
 	clusterNew->path = NULL;
 	clusterNew->inBotZone = false;
 	clusterNew->inTopZone = false;
+	clusterNew->gridRegistration.epoch = 0;
 	return (clusterNew);
 }
 
@@ -615,17 +706,18 @@ static void mergeClusters(RTFilterState state) {
 		return;
 	}
 
+	// Walk the list directly instead of by index, so that each pass is
+	// quadratic and not cubic in the number of clusters.
 	bool mergePending;
-	int i, j;
 	Cluster * C1 = NULL;
 	Cluster * C2 = NULL;
 	do {
 		mergePending = false;
-		for (i = 0; i < state->currentClusterNum; i++) {
-			C1 = findClusterByIndex(state->clusterBegin, i);
+		for (ClusterList * first = *(state->clusterBegin); first != NULL; first = first->next) {
+			C1 = first->cluster;
 			if (C1 != NULL) {
-				for (j = i + 1; j < state->currentClusterNum; j++) {
-					C2 = findClusterByIndex(state->clusterBegin, j);
+				for (ClusterList * second = first->next; second != NULL; second = second->next) {
+					C2 = second->cluster;
 					if ((C1 != NULL) && (C2 != NULL)) {
 						bool overlapping = isOverlapping(C1, C2);
 						bool velSimilar = true;
@@ -1277,17 +1369,6 @@ static void removeCluster(ClusterList ** head, int64_t clusterID){
 	}
 }
 
-static Cluster * findClusterByIndex(ClusterList ** head, int index){
-	ClusterList * current = (*head);
-	for(int i = 0; i < index; i++){
-		if (current->next == NULL){
-			return(NULL);
-		}
-		current = current->next;
-	}
-	return(current->cluster);
-}
-
 //static void removeAllCluster(ClusterList ** head){
 //	ClusterList * current = head;
 //	ClusterList * delete = current;
@@ -1343,6 +1424,7 @@ static void caerRectangulartrackerPiExit(caerModuleData moduleData) {
 	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
 
 	RTFilterState state = moduleData->moduleState;
+	clusterGridFree(&state->clusterGrid);
 }
 
 static void caerRectangulartrackerPiReset(caerModuleData moduleData, uint16_t resetCallSourceID) {
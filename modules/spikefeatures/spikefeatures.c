@@ -9,15 +9,19 @@
 #include "base/module.h"
 #include "ext/buffers.h"
 
+#include <math.h>
 #include <libcaer/events/polarity.h>
 #include <libcaer/events/frame.h>
 
+// Beyond this many time constants, the surface value is below 1/UINT16_MAX and shows as zero.
+#define SF_DECAY_CUTOFF 12
+
 struct SFFilter_state {
-	simple2DBufferFloat surfaceMap;			// surface map
-	simple2DBufferLong surfaceMapLastTs;	// surface time
-	int32_t decayTime;						// time constant for the decay
-	float tau;
-	int64_t lastTimeStamp;
+	simple2DMapLong surfaceMapLastTs;		// last event time per pixel, zero if none yet
+	int64_t decayTime;						// time constant for the exponential decay, in µs
+	int64_t frameInterval;					// time between output frames, in µs
+	int64_t lastTimeStamp;					// time of the most recent event
+	int64_t lastFrameTimeStamp;				// time of the last output frame
 };
 
 typedef struct SFFilter_state *SFFilterState;
@@ -27,6 +31,7 @@ static void caerSpikeFeaturesRun(caerModuleData moduleData, caerEventPacketConta
 static void caerSpikeFeaturesConfig(caerModuleData moduleData);
 static void caerSpikeFeaturesExit(caerModuleData moduleData);
 static void caerSpikeFeaturesReset(caerModuleData moduleData, int16_t resetCallSourceID);
+static inline float timeSurfaceGet(SFFilterState state, int64_t lastTs, int64_t now);
 
 static struct caer_module_functions caerSpikeFeaturesFunctions = { .moduleInit = &caerSpikeFeaturesInit, .moduleRun =
 	&caerSpikeFeaturesRun, .moduleConfig = &caerSpikeFeaturesConfig, .moduleExit = &caerSpikeFeaturesExit,
@@ -57,8 +62,10 @@ static bool caerSpikeFeaturesInit(caerModuleData moduleData) {
 	int16_t sourceID = inputs[0];
 	free(inputs);
 
-	sshsNodeCreateInt(moduleData->moduleNode, "decayTime", 3, 0, 2000, SSHS_FLAGS_NORMAL, "TODO.");
-	sshsNodeCreateFloat(moduleData->moduleNode, "tau", 0.02f, 0.0f, 100.0f, SSHS_FLAGS_NORMAL, "TODO.");
+	sshsNodeCreateInt(moduleData->moduleNode, "decayTime", 30, 1, 2000, SSHS_FLAGS_NORMAL,
+		"Time constant in ms of the exponential decay of the time surface.");
+	sshsNodeCreateInt(moduleData->moduleNode, "frameInterval", 40, 1, 10000, SSHS_FLAGS_NORMAL,
+		"Time in ms between output frames, measured in event time.");
 
 	SFFilterState state = moduleData->moduleState;
 
@@ -71,15 +78,8 @@ static bool caerSpikeFeaturesInit(caerModuleData moduleData) {
 	int16_t sizeX = sshsNodeGetShort(sourceInfo, "polaritySizeX");
 	int16_t sizeY = sshsNodeGetShort(sourceInfo, "polaritySizeY");
 
-	state->surfaceMap = simple2DBufferInitFloat((size_t) sizeX, (size_t) sizeY);
-	if (state->surfaceMap == NULL) {
-		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for surfaceMap.");
-		return (false);
-	}
-
-	state->surfaceMapLastTs = simple2DBufferInitLong((size_t) sizeX, (size_t) sizeY);
+	state->surfaceMapLastTs = simple2DMapInitLong((size_t) sizeX, (size_t) sizeY, 0);
 	if (state->surfaceMapLastTs == NULL) {
-		simple2DBufferFreeFloat(state->surfaceMap);
 		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for surfaceMapLastTs.");
 		return (false);
 	}
@@ -116,40 +116,30 @@ static void caerSpikeFeaturesRun(caerModuleData moduleData, caerEventPacketConta
 
 	SFFilterState state = moduleData->moduleState;
 
-	// Iterate over events and filter out ones that are not supported by other
-	// events within a certain region in the specified time-frame.
-	int64_t ts = 0;
+	// Only remember the time of the latest event at each pixel, the surface value
+	// is computed from it when needed. This keeps the per-packet cost proportional
+	// to the number of events, not to the sensor area.
+	int64_t *lastTsMap = state->surfaceMapLastTs->map;
+	size_t stride = state->surfaceMapLastTs->stride;
 
 	CAER_POLARITY_CONST_ITERATOR_VALID_START(polarity)
-	// Get values on which to operate.
-		ts = caerPolarityEventGetTimestamp64(caerPolarityIteratorElement, polarity);
+		// Get values on which to operate.
+		int64_t ts = caerPolarityEventGetTimestamp64(caerPolarityIteratorElement, polarity);
 
 		uint16_t x = caerPolarityEventGetX(caerPolarityIteratorElement);
 		uint16_t y = caerPolarityEventGetY(caerPolarityIteratorElement);
 
-		state->surfaceMap->buffer2d[x][y] = 1;
+		lastTsMap[((size_t) y * stride) + x] = ts;
+
+		state->lastTimeStamp = ts;
 	CAER_POLARITY_ITERATOR_VALID_END
 
-	// Decay the map.
-	for (size_t x = 0; x < state->surfaceMap->sizeX; x++) {
-		for (size_t y = 0; y < state->surfaceMap->sizeY; y++) {
-			state->surfaceMapLastTs->buffer2d[x][y] = ts;
-
-			if (state->surfaceMap->buffer2d[x][y] == 0) {
-				continue;
-			}
-			else {
-
-				state->surfaceMap->buffer2d[x][y] -= state->tau; // Do decay.
-				if (state->surfaceMap->buffer2d[x][y] < 0) {
-					state->surfaceMap->buffer2d[x][y] = 0;
-				}
-			}
-		}
+	// Frames are only generated at the configured rate, in event time.
+	if ((state->lastTimeStamp - state->lastFrameTimeStamp) < state->frameInterval) {
+		return;
 	}
 
-	// last timestamp is used for timing the frame
-	state->lastTimeStamp = ts;
+	state->lastFrameTimeStamp = state->lastTimeStamp;
 
 	// Generate output frame.
 	// Allocate packet container for result packet.
@@ -160,8 +150,8 @@ static void caerSpikeFeaturesRun(caerModuleData moduleData, caerEventPacketConta
 
 	// Everything that is in the out packet container will be automatically freed after main loop.
 	caerFrameEventPacket frameOut = caerFrameEventPacketAllocate(1, moduleData->moduleID,
-		caerEventPacketHeaderGetEventTSOverflow(&polarity->packetHeader), I32T(state->surfaceMap->sizeX),
-		I32T(state->surfaceMap->sizeY), 3);
+		caerEventPacketHeaderGetEventTSOverflow(&polarity->packetHeader), I32T(state->surfaceMapLastTs->sizeX),
+		I32T(state->surfaceMapLastTs->sizeY), 3);
 	if (frameOut == NULL) {
 		return; // Error.
 	}
@@ -174,9 +164,11 @@ static void caerSpikeFeaturesRun(caerModuleData moduleData, caerEventPacketConta
 	caerFrameEvent singleplot = caerFrameEventPacketGetEvent(frameOut, 0);
 
 	size_t counter = 0;
-	for (size_t y = 0; y < state->surfaceMap->sizeY; y++) {
-		for (size_t x = 0; x < state->surfaceMap->sizeX; x++) {
-			uint16_t colorValue = U16T(state->surfaceMap->buffer2d[x][y] * UINT16_MAX);
+	for (size_t y = 0; y < state->surfaceMapLastTs->sizeY; y++) {
+		const int64_t *lastTsRow = simple2DMapRowLong(state->surfaceMapLastTs, y);
+
+		for (size_t x = 0; x < state->surfaceMapLastTs->sizeX; x++) {
+			uint16_t colorValue = U16T(timeSurfaceGet(state, lastTsRow[x], state->lastTimeStamp) * UINT16_MAX);
 			singleplot->pixels[counter] = colorValue; // red
 			singleplot->pixels[counter + 1] = colorValue; // green
 			singleplot->pixels[counter + 2] = colorValue; // blue
@@ -185,20 +177,43 @@ static void caerSpikeFeaturesRun(caerModuleData moduleData, caerEventPacketConta
 	}
 
 	// Add info to frame.
-	caerFrameEventSetLengthXLengthYChannelNumber(singleplot, I32T(state->surfaceMap->sizeX),
-		I32T(state->surfaceMap->sizeY), 3, frameOut);
+	caerFrameEventSetLengthXLengthYChannelNumber(singleplot, I32T(state->surfaceMapLastTs->sizeX),
+		I32T(state->surfaceMapLastTs->sizeY), 3, frameOut);
 	//caerFrameEventSetTSEndOfFrame(singleplot, state->lastTimeStamp);
 	// Validate frame.
 	caerFrameEventValidate(singleplot, frameOut);
 }
 
+/**
+ * Value of the time surface at a pixel: one right after an event, then decaying
+ * exponentially with time. Pixels without events, or whose last event is too
+ * old to be visible, are zero without computing the exponential.
+ */
+static inline float timeSurfaceGet(SFFilterState state, int64_t lastTs, int64_t now) {
+	if (lastTs == 0) {
+		return (0);
+	}
+
+	int64_t age = now - lastTs;
+
+	if (age <= 0) {
+		return (1);
+	}
+
+	if (age >= (SF_DECAY_CUTOFF * state->decayTime)) {
+		return (0);
+	}
+
+	return (expf(-(float) age / (float) state->decayTime));
+}
+
 static void caerSpikeFeaturesConfig(caerModuleData moduleData) {
 	caerModuleConfigUpdateReset(moduleData);
 
 	SFFilterState state = moduleData->moduleState;
 
-	state->decayTime = sshsNodeGetInt(moduleData->moduleNode, "decayTime");
-	state->tau = sshsNodeGetFloat(moduleData->moduleNode, "tau");
+	state->decayTime = I64T(sshsNodeGetInt(moduleData->moduleNode, "decayTime")) * 1000;
+	state->frameInterval = I64T(sshsNodeGetInt(moduleData->moduleNode, "frameInterval")) * 1000;
 }
 
 static void caerSpikeFeaturesExit(caerModuleData moduleData) {
@@ -208,8 +223,7 @@ static void caerSpikeFeaturesExit(caerModuleData moduleData) {
 	SFFilterState state = moduleData->moduleState;
 
 	// Free maps.
-	simple2DBufferFreeFloat(state->surfaceMap);
-	simple2DBufferFreeLong(state->surfaceMapLastTs);
+	simple2DMapFreeLong(state->surfaceMapLastTs);
 
 	// Clear sourceInfo node.
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
@@ -222,8 +236,8 @@ static void caerSpikeFeaturesReset(caerModuleData moduleData, int16_t resetCallS
 	SFFilterState state = moduleData->moduleState;
 
 	state->lastTimeStamp = 0;
+	state->lastFrameTimeStamp = 0;
 
 	// Reset maps to all zeros (startup state).
-	simple2DBufferResetFloat(state->surfaceMap);
-	simple2DBufferResetLong(state->surfaceMapLastTs);
+	simple2DMapResetLong(state->surfaceMapLastTs);
 }
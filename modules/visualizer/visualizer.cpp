@@ -242,7 +242,7 @@ static void caerVisualizerExit(caerModuleData moduleData) {
 	// Now clean up the ring-buffer and its contents.
 	caerEventPacketContainer container;
 	while ((container = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer)) != nullptr) {
-		caerEventPacketContainerFree(container);
+		caerMainloopPacketContainerRelease(container);
 	}
 
 	caerRingBufferFree(state->dataTransfer);
@@ -290,14 +290,16 @@ static void caerVisualizerRun(caerModuleData moduleData, caerEventPacketContaine
 		return;
 	}
 
-	caerEventPacketContainer containerCopy = caerEventPacketContainerCopyAllEvents(in);
-	if (containerCopy == nullptr) {
-		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to copy event packet container for rendering.");
+	// Share the packets with the rendering thread instead of copying them,
+	// rendering never modifies them.
+	caerEventPacketContainer containerShared = caerMainloopPacketContainerRetain(in);
+	if (containerShared == nullptr) {
+		caerModuleLog(moduleData, CAER_LOG_ERROR, "Failed to share event packet container for rendering.");
 		return;
 	}
 
 	// Will always succeed because of full check above.
-	caerRingBufferPut(state->dataTransfer, containerCopy);
+	caerRingBufferPut(state->dataTransfer, containerShared);
 }
 
 static void caerVisualizerReset(caerModuleData moduleData, int16_t resetCallSourceID) {
@@ -701,7 +703,7 @@ static void renderScreen(caerModuleData moduleData) {
 		caerEventPacketContainer container2 = (caerEventPacketContainer) caerRingBufferGet(state->dataTransfer);
 
 		if (container2 != nullptr) {
-			caerEventPacketContainerFree(container);
+			caerMainloopPacketContainerRelease(container);
 			container = container2;
 			goto repeat;
 		}
@@ -716,8 +718,8 @@ static void renderScreen(caerModuleData moduleData) {
 			drewSomething = (*state->renderer->renderer)((caerVisualizerPublicState) state, container);
 		}
 
-		// Free packet container copy.
-		caerEventPacketContainerFree(container);
+		// Release shared packet container.
+		caerMainloopPacketContainerRelease(container);
 	}
 
 	// Handle display resize (zoom and statistics).
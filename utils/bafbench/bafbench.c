@@ -0,0 +1,334 @@
+// Checks that the background activity filter's vectorized neighbourhood update
+// and its multi-threaded tiled mode give exactly the same results as the scalar
+// serial filter, and measures all of them.
+// The filter is built from the module's own source, with and without SIMD.
+#include "modules/backgroundactivityfilter/backgroundactivityfilter.c"
+#include "ext/portable_time.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <math.h>
+
+// DAVIS346 resolution.
+#define BENCH_SIZE_X 346
+#define BENCH_SIZE_Y 260
+#define BENCH_PACKETS 100
+#define BENCH_PACKET_EVENTS 16384
+#define BENCH_DELTA_T 30000
+#define BENCH_SUBSAMPLE_MAX 2
+#define BENCH_REPEATS 10
+// Events mostly come from a few moving objects, the rest is uniform noise.
+#define BENCH_OBJECTS 8
+#define BENCH_NOISE_PERCENT 25
+
+typedef void (*bafbenchFilter)(struct BAFilter_state *state, caerPolarityEventPacket polarity);
+
+struct bench_filter {
+	const char *name;
+	bafbenchFilter filter;
+	size_t tilesNumber;
+};
+
+struct bench_run {
+	struct caer_module_data moduleData;
+	struct BAFilter_state state;
+	caerPolarityEventPacket packets[BENCH_PACKETS];
+	double seconds;
+};
+
+void bafbenchFilterScalar(struct BAFilter_state *state, caerPolarityEventPacket polarity);
+
+// Compared against the scalar serial filter. Three tiles don't split the rows evenly.
+static const struct bench_filter benchFilters[] = { { "SIMD", &filterSerial, 1 }, { "tiled2", &filterTiled, 2 }, {
+	"tiled3", &filterTiled, 3 }, { "tiled4", &filterTiled, 4 } };
+
+static bool generatePackets(caerPolarityEventPacket *packets);
+static bool runFilter(struct bench_run *run, bafbenchFilter filter, size_t tilesNumber,
+	caerPolarityEventPacket *input, int8_t subSampleBy);
+static void freeRun(struct bench_run *run);
+static double passedPercent(struct bench_run *run);
+static bool compareRuns(const char *name, struct bench_run *reference, struct bench_run *run);
+
+// The module's lifecycle functions, which use these, are never called here.
+void caerModuleLog(caerModuleData moduleData, enum caer_log_level logLevel, const char *format, ...) {
+	UNUSED_ARGUMENT(moduleData);
+	UNUSED_ARGUMENT(logLevel);
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+
+	fputc('\n', stderr);
+}
+
+void caerModuleConfigUpdateReset(caerModuleData moduleData) {
+	UNUSED_ARGUMENT(moduleData);
+}
+
+void caerModuleConfigDefaultListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(userData);
+	UNUSED_ARGUMENT(event);
+	UNUSED_ARGUMENT(changeKey);
+	UNUSED_ARGUMENT(changeType);
+	UNUSED_ARGUMENT(changeValue);
+}
+
+int16_t *caerMainloopGetModuleInputIDs(int16_t id, size_t *inputsSize) {
+	UNUSED_ARGUMENT(id);
+	UNUSED_ARGUMENT(inputsSize);
+
+	return (NULL);
+}
+
+sshsNode caerMainloopGetSourceInfo(int16_t sourceID) {
+	UNUSED_ARGUMENT(sourceID);
+
+	return (NULL);
+}
+
+int main(void) {
+	caerPolarityEventPacket input[BENCH_PACKETS] = { NULL };
+
+	if (!generatePackets(input)) {
+		fprintf(stderr, "Failed to allocate input packets.\n");
+		return (EXIT_FAILURE);
+	}
+
+	bool identical = true;
+
+	printf("%d packets of %d events, %dx%d pixels, deltaT %d µs, best of %d runs.\n", BENCH_PACKETS,
+		BENCH_PACKET_EVENTS, BENCH_SIZE_X, BENCH_SIZE_Y, BENCH_DELTA_T, BENCH_REPEATS);
+	printf("filter,subSampleBy,seconds,megaEventsPerSecond,passedPercent\n");
+
+	double megaEvents = (double) (BENCH_PACKETS * BENCH_PACKET_EVENTS) / 1.0e6;
+
+	for (int8_t subSampleBy = 0; subSampleBy <= BENCH_SUBSAMPLE_MAX; subSampleBy++) {
+		struct bench_run scalar;
+
+		if (!runFilter(&scalar, &bafbenchFilterScalar, 1, input, subSampleBy)) {
+			fprintf(stderr, "Failed to set up scalar filter.\n");
+			return (EXIT_FAILURE);
+		}
+
+		printf("scalar,%d,%.4f,%.1f,%.1f\n", subSampleBy, scalar.seconds, megaEvents / scalar.seconds,
+			passedPercent(&scalar));
+
+		for (size_t f = 0; f < (sizeof(benchFilters) / sizeof(benchFilters[0])); f++) {
+			struct bench_run run;
+
+			if (!runFilter(&run, benchFilters[f].filter, benchFilters[f].tilesNumber, input, subSampleBy)) {
+				fprintf(stderr, "Failed to set up %s filter.\n", benchFilters[f].name);
+				return (EXIT_FAILURE);
+			}
+
+			identical = compareRuns(benchFilters[f].name, &scalar, &run) && identical;
+
+			printf("%s,%d,%.4f,%.1f,%.1f\n", benchFilters[f].name, subSampleBy, run.seconds,
+				megaEvents / run.seconds, passedPercent(&run));
+
+			freeRun(&run);
+		}
+
+		freeRun(&scalar);
+	}
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		free(input[i]);
+	}
+
+	if (!identical) {
+		return (EXIT_FAILURE);
+	}
+
+	printf("All results identical.\n");
+
+	return (EXIT_SUCCESS);
+}
+
+static bool generatePackets(caerPolarityEventPacket *packets) {
+	float objectX[BENCH_OBJECTS], objectY[BENCH_OBJECTS];
+
+	srand(42);
+
+	for (size_t o = 0; o < BENCH_OBJECTS; o++) {
+		objectX[o] = (float) (rand() % BENCH_SIZE_X);
+		objectY[o] = (float) (rand() % BENCH_SIZE_Y);
+	}
+
+	int32_t ts = 1;
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		packets[i] = caerPolarityEventPacketAllocate(BENCH_PACKET_EVENTS, 1, 0);
+		if (packets[i] == NULL) {
+			return (false);
+		}
+
+		for (int32_t n = 0; n < BENCH_PACKET_EVENTS; n++) {
+			caerPolarityEvent event = caerPolarityEventPacketGetEvent(packets[i], n);
+
+			ts += rand() % 2;
+
+			int x, y;
+
+			if ((rand() % 100) < BENCH_NOISE_PERCENT) {
+				x = rand() % BENCH_SIZE_X;
+				y = rand() % BENCH_SIZE_Y;
+			}
+			else {
+				// Objects slowly wander around, wrapping at the borders.
+				size_t o = (size_t) (rand() % BENCH_OBJECTS);
+
+				objectX[o] += (float) ((rand() % 3) - 1) * 0.05f;
+				objectY[o] += (float) ((rand() % 3) - 1) * 0.05f;
+
+				x = ((int) objectX[o] + (rand() % 7) - 3 + BENCH_SIZE_X) % BENCH_SIZE_X;
+				y = ((int) objectY[o] + (rand() % 7) - 3 + BENCH_SIZE_Y) % BENCH_SIZE_Y;
+			}
+
+			caerPolarityEventSetTimestamp(event, ts);
+			caerPolarityEventSetX(event, U16T(x));
+			caerPolarityEventSetY(event, U16T(y));
+			caerPolarityEventSetPolarity(event, (rand() % 2) != 0);
+
+			// Some events are already invalid, those must be left alone.
+			if ((rand() % 20) != 0) {
+				caerPolarityEventValidate(event, packets[i]);
+			}
+		}
+
+		caerEventPacketHeaderSetEventNumber(&packets[i]->packetHeader, BENCH_PACKET_EVENTS);
+	}
+
+	return (true);
+}
+
+/**
+ * Filter copies of all input packets in order, keeping the results.
+ * The filter is run several times on fresh copies, and the best time kept.
+ *
+ * @param run where to keep the filter state, output packets and time.
+ * @param filter the filter to run.
+ * @param tilesNumber number of tile threads to start for the filter, one for none.
+ * @param input the input packets, left unchanged.
+ * @param subSampleBy sub-sampling to configure the filter with.
+ *
+ * @return true on success, false if out of memory or the threads couldn't be started.
+ */
+static bool runFilter(struct bench_run *run, bafbenchFilter filter, size_t tilesNumber,
+	caerPolarityEventPacket *input, int8_t subSampleBy) {
+	memset(run, 0, sizeof(*run));
+
+	run->moduleData.moduleState = &run->state;
+
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + (BENCH_PACKET_EVENTS * sizeof(struct caer_polarity_event));
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		run->packets[i] = malloc(packetSize);
+		if (run->packets[i] == NULL) {
+			freeRun(run);
+			return (false);
+		}
+	}
+
+	run->state.deltaT = BENCH_DELTA_T;
+	run->state.subSampleBy = subSampleBy;
+	run->state.tiles.tilesNumber = 1;
+	run->seconds = INFINITY;
+
+	if (tilesNumber > 1 && !tilesStart(&run->moduleData, tilesNumber)) {
+		freeRun(run);
+		return (false);
+	}
+
+	for (size_t repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+		simple2DMapFreeLong(run->state.timestampMap);
+
+		run->state.timestampMap = simple2DMapInitLong(BENCH_SIZE_X, BENCH_SIZE_Y, 1);
+		if (run->state.timestampMap == NULL) {
+			freeRun(run);
+			return (false);
+		}
+
+		for (size_t i = 0; i < BENCH_PACKETS; i++) {
+			memcpy(run->packets[i], input[i], packetSize);
+		}
+
+		struct timespec start, end;
+		portable_clock_gettime_monotonic(&start);
+
+		for (size_t i = 0; i < BENCH_PACKETS; i++) {
+			(*filter)(&run->state, run->packets[i]);
+		}
+
+		portable_clock_gettime_monotonic(&end);
+
+		double seconds = (double) (end.tv_sec - start.tv_sec) + ((double) (end.tv_nsec - start.tv_nsec) / 1.0e9);
+		if (seconds < run->seconds) {
+			run->seconds = seconds;
+		}
+	}
+
+	return (true);
+}
+
+static void freeRun(struct bench_run *run) {
+	tilesStop(&run->moduleData);
+
+	free(run->state.tiles.invalidate);
+	run->state.tiles.invalidate = NULL;
+	run->state.tiles.invalidateSize = 0;
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		free(run->packets[i]);
+		run->packets[i] = NULL;
+	}
+
+	simple2DMapFreeLong(run->state.timestampMap);
+	run->state.timestampMap = NULL;
+}
+
+static double passedPercent(struct bench_run *run) {
+	int64_t valid = 0;
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		valid += caerEventPacketHeaderGetEventValid(&run->packets[i]->packetHeader);
+	}
+
+	return ((100.0 * (double) valid) / (double) (BENCH_PACKETS * BENCH_PACKET_EVENTS));
+}
+
+/**
+ * Compare the filtered packets and the final timestamp maps of two runs.
+ * Map borders are never read, so they don't have to match.
+ *
+ * @param name name of the compared filter, for reporting differences.
+ * @param reference run of the scalar serial filter.
+ * @param run run of the compared filter, on the same input.
+ *
+ * @return true if identical, false otherwise.
+ */
+static bool compareRuns(const char *name, struct bench_run *reference, struct bench_run *run) {
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + (BENCH_PACKET_EVENTS * sizeof(struct caer_polarity_event));
+
+	for (size_t i = 0; i < BENCH_PACKETS; i++) {
+		if (memcmp(reference->packets[i], run->packets[i], packetSize) != 0) {
+			fprintf(stderr, "%s (subSampleBy %d): packet %zu differs from scalar filter.\n", name,
+				run->state.subSampleBy, i);
+			return (false);
+		}
+	}
+
+	for (size_t y = 0; y < BENCH_SIZE_Y; y++) {
+		if (memcmp(simple2DMapRowLong(reference->state.timestampMap, y), simple2DMapRowLong(run->state.timestampMap, y),
+			BENCH_SIZE_X * sizeof(int64_t)) != 0) {
+			fprintf(stderr, "%s (subSampleBy %d): timestamp map row %zu differs from scalar filter.\n", name,
+				run->state.subSampleBy, y);
+			return (false);
+		}
+	}
+
+	return (true);
+}
@@ -0,0 +1,13 @@
+// The background activity filter compiled without SIMD, as reference for the
+// vectorized neighbourhood update. Only the serial filter is used from here.
+#undef __SSE2__
+#undef __ARM_NEON
+#define caerModuleGetInfo caerModuleGetInfoScalar
+
+#include "modules/backgroundactivityfilter/backgroundactivityfilter.c"
+
+void bafbenchFilterScalar(struct BAFilter_state *state, caerPolarityEventPacket polarity);
+
+void bafbenchFilterScalar(struct BAFilter_state *state, caerPolarityEventPacket polarity) {
+	filterSerial(state, polarity);
+}
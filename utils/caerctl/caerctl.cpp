@@ -1,8 +1,11 @@
 #include "main.h"
 #include "base/config_server.h"
 #include "ext/sshs/sshs.h"
+#include <libcaer/network.h>
 #include "utils/ext/linenoise-ng/linenoise.h"
 #include <iostream>
+#include <fstream>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include <boost/format.hpp>
 #include <boost/asio.hpp>
@@ -58,6 +61,10 @@ static inline boost::filesystem::path getHomeDirectory() {
 }
 
 static void handleInputLine(const char *buf, size_t bufLength);
+static bool handleBatchFile(const std::string &batchFile);
+static bool handleSubscription(const std::vector<std::string> &commandComponents);
+static bool handleTap(const std::vector<std::string> &commandComponents);
+static void printResult(uint8_t action, uint8_t type, uint16_t msgLength, const uint8_t *msg);
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete);
 
 static void actionCompletion(const char *buf, size_t bufLength, linenoiseCompletions *autoComplete,
@@ -105,7 +112,15 @@ int main(int argc, char *argv[]) {
 		"IP-address or hostname to connect to")("port,p", po::value<std::string>(), "port to connect to")("script,s",
 		po::value<std::vector<std::string>>()->multitoken(),
 		"script mode, sends the given command directly to the server as if typed in and exits.\n"
-			"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7");
+			"Format: <action> <node> [<attribute> <type> [<value>]]\nExample: set /caer/logger/ logLevel byte 7\n"
+			"The 'subscribe' action prints all changes to the attribute until interrupted, at most one "
+			"per given interval in ms.\nExample: subscribe /caer/logger/ logLevel byte 100\n"
+			"The 'tap' action writes an event stream as AEDAT 3.1 to standard output until interrupted.\n"
+			"Format: tap <sourceId> <typeId> [<rate in KB/s> [<sub-sampling>]]\nExample: tap 1 1 512 2 > tap.aedat")(
+		"batch,b", po::value<std::string>(),
+		"batch mode, sends all get/put commands from the given file to the server in one message and exits.\n"
+			"All puts are applied together, or none of them is if any fails.\n"
+			"Format: one command per line, empty lines and lines starting with '#' are ignored.");
 
 	po::variables_map cliVarMap;
 	try {
@@ -156,6 +171,16 @@ int main(int argc, char *argv[]) {
 		scriptMode = true;
 	}
 
+	bool batchMode = false;
+	if (cliVarMap.count("batch")) {
+		if (scriptMode) {
+			std::cout << "Script mode and batch mode cannot be used together!" << std::endl;
+			printHelpAndExit(cliDescription);
+		}
+
+		batchMode = true;
+	}
+
 	// Generate command history file path (in user home).
 	boost::filesystem::path commandHistoryFilePath;
 
@@ -184,7 +209,25 @@ int main(int argc, char *argv[]) {
 	// Load command history file.
 	linenoiseHistoryLoad(commandHistoryFilePath.string().c_str());
 
-	if (scriptMode) {
+	if (batchMode) {
+		// Batches are usually too big to be useful in the command history.
+		if (!handleBatchFile(cliVarMap["batch"].as<std::string>())) {
+			return (EXIT_FAILURE);
+		}
+	}
+	else if (scriptMode && cliVarMap["script"].as<std::vector<std::string>>()[0] == "subscribe") {
+		// Runs until the connection is closed, or caer-ctl is interrupted.
+		if (!handleSubscription(cliVarMap["script"].as<std::vector<std::string>>())) {
+			return (EXIT_FAILURE);
+		}
+	}
+	else if (scriptMode && cliVarMap["script"].as<std::vector<std::string>>()[0] == "tap") {
+		// Runs until the connection is closed, or caer-ctl is interrupted.
+		if (!handleTap(cliVarMap["script"].as<std::vector<std::string>>())) {
+			return (EXIT_FAILURE);
+		}
+	}
+	else if (scriptMode) {
 		std::vector<std::string> commandComponents = cliVarMap["script"].as<std::vector<std::string>>();
 
 		std::string inputString = boost::algorithm::join(commandComponents, " ");
@@ -549,6 +592,10 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 		return;
 	}
 
+	printResult(action, type, msgLength, dataBuffer + 4);
+}
+
+static void printResult(uint8_t action, uint8_t type, uint16_t msgLength, const uint8_t *msg) {
 	// Convert action back to a string.
 	const char *actionString = nullptr;
 
@@ -566,11 +613,188 @@ static void handleInputLine(const char *buf, size_t bufLength) {
 
 	// Display results.
 	boost::format resultMsg = boost::format("Result: action=%s, type=%s, msgLength=%" PRIu16 ", msg='%s'.")
-		% actionString % sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type) % msgLength
-		% (dataBuffer + 4);
+		% actionString % sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) type) % msgLength % msg;
 	std::cout << resultMsg.str() << std::endl;
 }
 
+static bool handleBatchFile(const std::string &batchFile) {
+	std::ifstream batchStream(batchFile);
+
+	if (!batchStream) {
+		boost::format errMsg = boost::format("Error: unable to open batch file '%s'.") % batchFile;
+		std::cerr << errMsg.str() << std::endl;
+		return (false);
+	}
+
+	// Build all requests first, nothing is sent if any command is invalid.
+	// See config_server.h for the batch message format.
+	std::vector<uint8_t> dataBuffer(CAER_CONFIG_SERVER_HEADER_SIZE);
+	std::vector<size_t> commandLines;
+
+	std::string line;
+	size_t lineNumber = 0;
+
+	while (std::getline(batchStream, line)) {
+		lineNumber++;
+
+		// Split line into its parts, skip empty lines and comments.
+		char *commandParts[MAX_CMD_PARTS + 1] = { nullptr };
+
+		size_t idx = 0;
+		char *tokenSavePtr = nullptr, *nextCmdPart = nullptr, *currCmdPart = &line[0];
+		while ((nextCmdPart = strtok_r(currCmdPart, " \t\r", &tokenSavePtr)) != nullptr) {
+			if (idx < MAX_CMD_PARTS) {
+				commandParts[idx] = nextCmdPart;
+			}
+
+			idx++;
+			currCmdPart = nullptr;
+		}
+
+		if (idx == 0 || commandParts[CMD_PART_ACTION][0] == '#') {
+			continue;
+		}
+
+		boost::format errPrefix = boost::format("Error: %s:%zu: ") % batchFile % lineNumber;
+
+		uint8_t actionCode = UINT8_MAX;
+		size_t expectedParts = 0;
+
+		if (strcmp(commandParts[CMD_PART_ACTION], "get") == 0) {
+			actionCode = CAER_CONFIG_GET;
+			expectedParts = CMD_PART_TYPE + 1;
+		}
+		else if (strcmp(commandParts[CMD_PART_ACTION], "put") == 0) {
+			actionCode = CAER_CONFIG_PUT;
+			expectedParts = CMD_PART_VALUE + 1;
+		}
+		else {
+			std::cerr << errPrefix.str() << "only get and put commands are supported in batches." << std::endl;
+			return (false);
+		}
+
+		if (idx != expectedParts) {
+			std::cerr << errPrefix.str() << "wrong number of parameters for command." << std::endl;
+			return (false);
+		}
+
+		enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandParts[CMD_PART_TYPE]);
+		if (type == SSHS_UNKNOWN) {
+			std::cerr << errPrefix.str() << "invalid type parameter." << std::endl;
+			return (false);
+		}
+
+		size_t nodeLength = strlen(commandParts[CMD_PART_NODE]) + 1; // +1 for terminating NUL byte.
+		size_t keyLength = strlen(commandParts[CMD_PART_KEY]) + 1; // +1 for terminating NUL byte.
+		size_t valueLength = (actionCode == CAER_CONFIG_PUT) ? (strlen(commandParts[CMD_PART_VALUE]) + 1) : (0);
+
+		if ((nodeLength + keyLength + valueLength) > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
+			std::cerr << errPrefix.str() << "command too long." << std::endl;
+			return (false);
+		}
+
+		// Each command is a complete control message.
+		uint8_t header[CAER_CONFIG_SERVER_HEADER_SIZE];
+
+		header[0] = actionCode;
+		header[1] = (uint8_t) type;
+		setExtraLen(header, 0); // UNUSED.
+		setNodeLen(header, (uint16_t) nodeLength);
+		setKeyLen(header, (uint16_t) keyLength);
+		setValueLen(header, (uint16_t) valueLength);
+
+		dataBuffer.insert(dataBuffer.end(), header, header + CAER_CONFIG_SERVER_HEADER_SIZE);
+		dataBuffer.insert(dataBuffer.end(), commandParts[CMD_PART_NODE], commandParts[CMD_PART_NODE] + nodeLength);
+		dataBuffer.insert(dataBuffer.end(), commandParts[CMD_PART_KEY], commandParts[CMD_PART_KEY] + keyLength);
+		if (valueLength != 0) {
+			dataBuffer.insert(dataBuffer.end(), commandParts[CMD_PART_VALUE],
+				commandParts[CMD_PART_VALUE] + valueLength);
+		}
+
+		commandLines.push_back(lineNumber);
+	}
+
+	size_t bodyLength = dataBuffer.size() - CAER_CONFIG_SERVER_HEADER_SIZE;
+
+	if (commandLines.size() > UINT16_MAX || bodyLength > CAER_CONFIG_SERVER_BATCH_MAX_SIZE) {
+		std::cerr << "Error: batch file too big, split it up into multiple ones." << std::endl;
+		return (false);
+	}
+
+	dataBuffer[0] = CAER_CONFIG_BATCH;
+	dataBuffer[1] = 0; // UNUSED.
+	*((uint16_t *) (dataBuffer.data() + 2)) = htole16((uint16_t) commandLines.size());
+	*((uint32_t *) (dataBuffer.data() + 4)) = htole32((uint32_t) bodyLength);
+	dataBuffer[8] = 0; // UNUSED.
+	dataBuffer[9] = 0; // UNUSED.
+
+	// Send all commands to configuration server and get back all the results.
+	// A malformed batch gets a normal error response, which has the same first
+	// four bytes as a batch response.
+	std::vector<uint8_t> response(CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE);
+
+	try {
+		asio::write(netSocket, asio::buffer(dataBuffer));
+
+		asio::read(netSocket, asio::buffer(response.data(), 4));
+
+		if (response[0] != CAER_CONFIG_BATCH) {
+			uint16_t msgLength = le16toh(*(uint16_t * )(response.data() + 2));
+
+			response.resize(4 + msgLength);
+			asio::read(netSocket, asio::buffer(response.data() + 4, msgLength));
+
+			printResult(response[0], response[1], msgLength, response.data() + 4);
+			return (false);
+		}
+
+		asio::read(netSocket, asio::buffer(response.data() + 4, 4));
+
+		uint32_t responseBodyLength = le32toh(*(uint32_t * )(response.data() + 4));
+
+		response.resize(CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE + responseBodyLength);
+		asio::read(netSocket,
+			asio::buffer(response.data() + CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE, responseBodyLength));
+	}
+	catch (const boost::system::system_error &ex) {
+		boost::format exMsg = boost::format("Unable to exchange data with config server, error message is:\n\t%s.")
+			% ex.what();
+		std::cerr << exMsg.str() << std::endl;
+		return (false);
+	}
+
+	// Display results, one for each command, in order.
+	bool allSucceeded = true;
+	size_t offset = CAER_CONFIG_SERVER_BATCH_RESPONSE_HEADER_SIZE;
+
+	for (size_t lineNum : commandLines) {
+		if ((response.size() - offset) < 4) {
+			std::cerr << "Error: incomplete batch response from config server." << std::endl;
+			return (false);
+		}
+
+		uint8_t action = response[offset];
+		uint8_t type = response[offset + 1];
+		uint16_t msgLength = le16toh(*(uint16_t * )(response.data() + offset + 2));
+
+		if ((response.size() - offset - 4) < msgLength) {
+			std::cerr << "Error: incomplete batch response from config server." << std::endl;
+			return (false);
+		}
+
+		std::cout << batchFile << ":" << lineNum << ": ";
+		printResult(action, type, msgLength, response.data() + offset + 4);
+
+		if (action == CAER_CONFIG_ERROR) {
+			allSucceeded = false;
+		}
+
+		offset += 4 + msgLength;
+	}
+
+	return (allSucceeded);
+}
+
 static void handleCommandCompletion(const char *buf, linenoiseCompletions *autoComplete) {
 	size_t bufLength = strlen(buf);
 
@@ -1069,3 +1293,196 @@ static void addCompletionSuffix(linenoiseCompletions *autoComplete, const char *
 
 	linenoiseAddCompletion(autoComplete, concat);
 }
+
+static bool handleSubscription(const std::vector<std::string> &commandComponents) {
+	// Format: subscribe <node> <attribute> <type> [<interval>]
+	if (commandComponents.size() < 4) {
+		std::cerr << "Error: missing parameters for subscribe." << std::endl;
+		return (false);
+	}
+
+	enum sshs_node_attr_value_type type = sshsHelperStringToTypeConverter(commandComponents[CMD_PART_TYPE].c_str());
+	if (type == SSHS_UNKNOWN) {
+		std::cerr << "Error: invalid type parameter." << std::endl;
+		return (false);
+	}
+
+	const std::string &nodeString = commandComponents[CMD_PART_NODE];
+	const std::string &keyString = commandComponents[CMD_PART_KEY];
+
+	size_t nodeLength = nodeString.length() + 1; // +1 for terminating NUL byte.
+	size_t keyLength = keyString.length() + 1; // +1 for terminating NUL byte.
+	size_t valueLength = (commandComponents.size() > CMD_PART_VALUE) ? (commandComponents[CMD_PART_VALUE].length() + 1)
+		: (0);
+
+	if ((nodeLength + keyLength + valueLength) > (CAER_CONFIG_SERVER_BUFFER_SIZE - CAER_CONFIG_SERVER_HEADER_SIZE)) {
+		std::cerr << "Error: command too long." << std::endl;
+		return (false);
+	}
+
+	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
+
+	dataBuffer[0] = CAER_CONFIG_SUBSCRIBE;
+	dataBuffer[1] = (uint8_t) type;
+	setExtraLen(dataBuffer, 0); // UNUSED.
+	setNodeLen(dataBuffer, (uint16_t) nodeLength);
+	setKeyLen(dataBuffer, (uint16_t) keyLength);
+	setValueLen(dataBuffer, (uint16_t) valueLength);
+
+	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, nodeString.c_str(), nodeLength);
+	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength, keyString.c_str(), keyLength);
+	if (valueLength != 0) {
+		memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength + keyLength,
+			commandComponents[CMD_PART_VALUE].c_str(), valueLength);
+	}
+
+	try {
+		asio::write(netSocket,
+			asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + nodeLength + keyLength + valueLength));
+	}
+	catch (const boost::system::system_error &ex) {
+		boost::format exMsg = boost::format("Unable to send data to config server, error message is:\n\t%s.")
+			% ex.what();
+		std::cerr << exMsg.str() << std::endl;
+		return (false);
+	}
+
+	// First comes the response, then notifications until the connection is closed.
+	while (true) {
+		uint16_t msgLength = 0;
+
+		try {
+			asio::read(netSocket, asio::buffer(dataBuffer, 4));
+
+			msgLength = le16toh(*(uint16_t * )(dataBuffer + 2));
+
+			if (msgLength > (sizeof(dataBuffer) - 4)) {
+				std::cerr << "Message from config server too long (" << msgLength << " bytes), closing."
+					<< std::endl;
+				return (false);
+			}
+
+			asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
+		}
+		catch (const boost::system::system_error &ex) {
+			if (ex.code() == asio::error::eof) {
+				return (true);
+			}
+
+			boost::format exMsg = boost::format(
+				"Unable to receive data from config server, error message is:\n\t%s.") % ex.what();
+			std::cerr << exMsg.str() << std::endl;
+			return (false);
+		}
+
+		uint8_t action = dataBuffer[0];
+
+		if (action != CAER_CONFIG_NOTIFY) {
+			printResult(action, dataBuffer[1], msgLength, dataBuffer + 4);
+
+			if (action == CAER_CONFIG_ERROR) {
+				return (false);
+			}
+
+			continue;
+		}
+
+		// MSG is NODE, KEY and VALUE, each NUL terminated. No VALUE if the attribute was removed.
+		const char *msg = (const char *) (dataBuffer + 4);
+		size_t nodeEnd = strnlen(msg, msgLength);
+		size_t keyEnd = (nodeEnd < msgLength) ? (nodeEnd + 1 + strnlen(msg + nodeEnd + 1, msgLength - nodeEnd - 1))
+			: (msgLength);
+
+		if (keyEnd >= msgLength) {
+			std::cerr << "Error: malformed notification from config server." << std::endl;
+			return (false);
+		}
+
+		const char *notifyType = sshsHelperTypeToStringConverter((enum sshs_node_attr_value_type) dataBuffer[1]);
+
+		if ((keyEnd + 1) == msgLength) {
+			boost::format notifyMsg = boost::format("Notify: node=%s, key=%s, type=%s, removed.") % msg
+				% (msg + nodeEnd + 1) % notifyType;
+			std::cout << notifyMsg.str() << std::endl;
+		}
+		else {
+			boost::format notifyMsg = boost::format("Notify: node=%s, key=%s, type=%s, value='%s'.") % msg
+				% (msg + nodeEnd + 1) % notifyType % (msg + keyEnd + 1);
+			std::cout << notifyMsg.str() << std::endl;
+		}
+	}
+}
+
+static bool handleTap(const std::vector<std::string> &commandComponents) {
+	// Format: tap <sourceId> <typeId> [<rate> [<subSampleBy>]]
+	if (commandComponents.size() < 3) {
+		std::cerr << "Error: missing parameters for tap." << std::endl;
+		return (false);
+	}
+
+	// The server parses and checks the tap definition.
+	std::string tapString = boost::algorithm::join(
+		std::vector<std::string>(commandComponents.begin() + 1, commandComponents.end()), ",");
+	size_t tapLength = tapString.length() + 1; // +1 for terminating NUL byte.
+
+	uint8_t dataBuffer[CAER_CONFIG_SERVER_BUFFER_SIZE];
+
+	dataBuffer[0] = CAER_CONFIG_TAP;
+	dataBuffer[1] = (uint8_t) SSHS_STRING;
+	setExtraLen(dataBuffer, 0); // UNUSED.
+	setNodeLen(dataBuffer, 0); // UNUSED.
+	setKeyLen(dataBuffer, 0); // UNUSED.
+	setValueLen(dataBuffer, (uint16_t) tapLength);
+
+	memcpy(dataBuffer + CAER_CONFIG_SERVER_HEADER_SIZE, tapString.c_str(), tapLength);
+
+	try {
+		asio::write(netSocket, asio::buffer(dataBuffer, CAER_CONFIG_SERVER_HEADER_SIZE + tapLength));
+
+		asio::read(netSocket, asio::buffer(dataBuffer, 4));
+
+		uint16_t msgLength = le16toh(*(uint16_t * )(dataBuffer + 2));
+
+		asio::read(netSocket, asio::buffer(dataBuffer + 4, msgLength));
+
+		if (dataBuffer[0] != CAER_CONFIG_TAP) {
+			// Standard output is for the stream, so errors go elsewhere.
+			boost::format errorMsg = boost::format("Error: %.*s.") % (int) msgLength % (const char *) (dataBuffer + 4);
+			std::cerr << errorMsg.str() << std::endl;
+			return (false);
+		}
+
+		// File header, with the source description from the response.
+		std::cout << "#!AER-DAT3.1\r\n";
+		std::cout << "#Format: RAW\r\n";
+		if (msgLength > 1) {
+			std::cout.write((const char *) (dataBuffer + 4), msgLength - 1);
+		}
+		std::cout << "#!END-HEADER\r\n";
+
+		// Skip the network header, the packets that follow are copied as-is.
+		asio::read(netSocket, asio::buffer(dataBuffer, AEDAT3_NETWORK_HEADER_LENGTH));
+
+		while (true) {
+			size_t length = netSocket.read_some(asio::buffer(dataBuffer, CAER_CONFIG_SERVER_BUFFER_SIZE));
+
+			std::cout.write((const char *) dataBuffer, (std::streamsize) length);
+
+			if (!std::cout) {
+				std::cerr << "Error: failed to write stream to standard output." << std::endl;
+				return (false);
+			}
+		}
+	}
+	catch (const boost::system::system_error &ex) {
+		if (ex.code() == asio::error::eof) {
+			std::cout.flush();
+			return (true);
+		}
+
+		boost::format exMsg = boost::format("Unable to communicate with config server, error message is:\n\t%s.")
+			% ex.what();
+		std::cerr << exMsg.str() << std::endl;
+		return (false);
+	}
+}
@@ -0,0 +1,146 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include "ext/sshs/sshs.h"
+#include "ext/portable_time.h"
+#include "ext/c11threads_posix.h"
+
+#include <stdatomic.h>
+
+// Compares reading SSHS attributes by name to reading them through attribute
+// handles, the way a module's run function reads its configuration for every
+// packet. Each thread reads all attributes of the node in a loop.
+
+#define BENCH_NODE "/sshsbench/"
+#define BENCH_ATTRIBUTES 16
+#define BENCH_ITERATIONS (1000 * 1000)
+#define BENCH_MAX_THREADS 4
+
+struct bench_thread {
+	sshsNode node;
+	sshsNodeAttr handles[BENCH_ATTRIBUTES];
+	char keys[BENCH_ATTRIBUTES][16];
+	bool useHandles;
+	atomic_bool *start;
+	int64_t sum;
+};
+
+static int benchThread(void *arg);
+static double runBench(struct bench_thread *threads, size_t threadsNumber, bool useHandles);
+
+int main(void) {
+	sshsNode node = sshsGetNode(sshsGetGlobal(), BENCH_NODE);
+
+	// A typical module node, with several integer attributes.
+	struct bench_thread threads[BENCH_MAX_THREADS];
+
+	for (size_t i = 0; i < BENCH_ATTRIBUTES; i++) {
+		char key[16];
+		snprintf(key, 16, "attribute%zu", i);
+
+		sshsNodeCreateInt(node, key, (int32_t) i, 0, INT32_MAX, SSHS_FLAGS_NORMAL, "Benchmark attribute.");
+
+		for (size_t t = 0; t < BENCH_MAX_THREADS; t++) {
+			threads[t].node = node;
+			memcpy(threads[t].keys[i], key, 16);
+			threads[t].handles[i] = sshsNodeGetAttributeHandle(node, key, SSHS_INT);
+		}
+	}
+
+	printf("%d attributes, %d iterations per thread.\n", BENCH_ATTRIBUTES, BENCH_ITERATIONS);
+	printf("threads,byNameNsPerRead,handleNsPerRead,speedup\n");
+
+	for (size_t threadsNumber = 1; threadsNumber <= BENCH_MAX_THREADS; threadsNumber *= 2) {
+		double byName = runBench(threads, threadsNumber, false);
+		int64_t byNameSum = threads[0].sum;
+
+		double handle = runBench(threads, threadsNumber, true);
+		int64_t handleSum = threads[0].sum;
+
+		// Both paths must read the same values.
+		if (byNameSum != handleSum) {
+			fprintf(stderr, "Values read by name (%" PRIi64 ") and through handles (%" PRIi64 ") differ.\n",
+				byNameSum, handleSum);
+			return (EXIT_FAILURE);
+		}
+
+		printf("%zu,%.2f,%.2f,%.1f\n", threadsNumber, byName, handle, (handle > 0) ? (byName / handle) : (0.0));
+	}
+
+	sshsNodeRemoveNode(node);
+
+	return (EXIT_SUCCESS);
+}
+
+static int benchThread(void *arg) {
+	struct bench_thread *thread = arg;
+
+	while (!atomic_load(thread->start)) {
+		thrd_yield();
+	}
+
+	int64_t sum = 0;
+
+	if (thread->useHandles) {
+		for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+			for (size_t i = 0; i < BENCH_ATTRIBUTES; i++) {
+				sum += sshsNodeAttributeHandleGetInt(thread->handles[i]);
+			}
+		}
+	}
+	else {
+		for (size_t n = 0; n < BENCH_ITERATIONS; n++) {
+			for (size_t i = 0; i < BENCH_ATTRIBUTES; i++) {
+				sum += sshsNodeGetInt(thread->node, thread->keys[i]);
+			}
+		}
+	}
+
+	thread->sum = sum;
+
+	return (thrd_success);
+}
+
+/**
+ * Run all threads at once, reading either by name or through handles.
+ *
+ * @param threads thread data, with nodes, keys and handles set up.
+ * @param threadsNumber how many threads to run.
+ * @param useHandles read through handles instead of by name.
+ *
+ * @return average time per attribute read, in nanoseconds.
+ */
+static double runBench(struct bench_thread *threads, size_t threadsNumber, bool useHandles) {
+	atomic_bool start = ATOMIC_VAR_INIT(false);
+	thrd_t ids[BENCH_MAX_THREADS];
+
+	for (size_t t = 0; t < threadsNumber; t++) {
+		threads[t].useHandles = useHandles;
+		threads[t].start = &start;
+
+		if (thrd_create(&ids[t], &benchThread, &threads[t]) != thrd_success) {
+			fprintf(stderr, "Failed to start benchmark thread.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	struct timespec startTime, endTime;
+	portable_clock_gettime_monotonic(&startTime);
+
+	atomic_store(&start, true);
+
+	for (size_t t = 0; t < threadsNumber; t++) {
+		thrd_join(ids[t], NULL);
+	}
+
+	portable_clock_gettime_monotonic(&endTime);
+
+	double elapsedNs = ((double) (endTime.tv_sec - startTime.tv_sec) * 1.0e9)
+		+ (double) (endTime.tv_nsec - startTime.tv_nsec);
+
+	// Threads run in parallel, so the time per read is the one seen by each.
+	return (elapsedNs / ((double) BENCH_ITERATIONS * BENCH_ATTRIBUTES));
+}